@@ -0,0 +1,281 @@
+#ifdef CHESS_TRACK_ALLOCATIONS
+
+#include "AllocTracker.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <malloc.h>
+#define CHESS_CALLER_ADDRESS() _ReturnAddress()
+#else
+#define CHESS_CALLER_ADDRESS() __builtin_return_address(0)
+#endif
+
+// STATE
+// Everything touched from operator new is trivially constructible: no allocation, no TLS destructors.
+
+namespace
+{
+    struct ThreadState
+    {
+        Chess::AllocTracker::Counters counters;
+        unsigned untilSample;
+
+        // NoAllocGuard
+        const char *guardName;
+        int guardMode;
+        std::uint64_t violations;
+        bool reporting;
+    };
+
+    thread_local ThreadState t_State;
+
+    std::atomic<std::uint64_t> s_TotalAllocations{0};
+    std::atomic<std::uint64_t> s_TotalDeallocations{0};
+    std::atomic<std::uint64_t> s_TotalBytes{0};
+
+    std::atomic<unsigned> s_SamplingInterval{0};
+    std::atomic<int> s_SampleCount{0};
+    std::array<Chess::AllocTracker::Sample, Chess::AllocTracker::MAX_SAMPLES> s_Samples;
+
+    void recordAllocation(std::size_t size, const void *callSite)
+    {
+        auto &state = t_State;
+
+        state.counters.allocations++;
+        state.counters.bytes += size;
+        s_TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+        s_TotalBytes.fetch_add(size, std::memory_order_relaxed);
+
+        // Call-site sampling
+        unsigned interval = s_SamplingInterval.load(std::memory_order_relaxed);
+        if (interval != 0)
+        {
+            if (state.untilSample == 0 || state.untilSample > interval)
+            {
+                state.untilSample = interval;
+                int slot = s_SampleCount.fetch_add(1, std::memory_order_relaxed);
+                if (slot < Chess::AllocTracker::MAX_SAMPLES)
+                    s_Samples[slot] = {callSite, size};
+            }
+            state.untilSample--;
+        }
+
+        // Zero-allocation regions
+        if (state.guardName != nullptr && !state.reporting)
+        {
+            state.violations++;
+            state.reporting = true;
+            std::fprintf(stderr, "NoAllocGuard: %zu byte allocation inside \"%s\" (call site %p)\n", size, state.guardName, callSite);
+            state.reporting = false;
+
+            if (state.guardMode == Chess::NoAllocGuard::Mode::Abort)
+                std::abort();
+        }
+    }
+
+    void recordDeallocation()
+    {
+        t_State.counters.deallocations++;
+        s_TotalDeallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void *allocate(std::size_t size, const void *callSite)
+    {
+        recordAllocation(size, callSite);
+        if (void *ptr = std::malloc(size == 0 ? 1 : size))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    // Over-aligned types (alignas above the default new alignment) come through here
+    void *allocateAligned(std::size_t size, std::align_val_t alignment, const void *callSite, bool nothrow)
+    {
+        recordAllocation(size, callSite);
+        auto align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+        void *ptr = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+        // aligned_alloc wants a multiple of the alignment
+        void *ptr = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align);
+#endif
+        if (ptr == nullptr && !nothrow)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    void freeAligned(void *ptr)
+    {
+        if (ptr == nullptr)
+            return;
+        recordDeallocation();
+#if defined(_MSC_VER)
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
+
+// REPLACED OPERATORS
+
+void *operator new(std::size_t size)
+{
+    return allocate(size, CHESS_CALLER_ADDRESS());
+}
+
+void *operator new[](std::size_t size)
+{
+    return allocate(size, CHESS_CALLER_ADDRESS());
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    recordAllocation(size, CHESS_CALLER_ADDRESS());
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    recordAllocation(size, CHESS_CALLER_ADDRESS());
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr == nullptr)
+        return;
+    recordDeallocation();
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment, CHESS_CALLER_ADDRESS(), false);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment, CHESS_CALLER_ADDRESS(), false);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocateAligned(size, alignment, CHESS_CALLER_ADDRESS(), true);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocateAligned(size, alignment, CHESS_CALLER_ADDRESS(), true);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+// ALLOC TRACKER
+
+Chess::AllocTracker::Counters Chess::AllocTracker::threadCounters()
+{
+    return t_State.counters;
+}
+
+Chess::AllocTracker::Counters Chess::AllocTracker::totalCounters()
+{
+    return Counters{
+        s_TotalAllocations.load(std::memory_order_relaxed),
+        s_TotalDeallocations.load(std::memory_order_relaxed),
+        s_TotalBytes.load(std::memory_order_relaxed),
+    };
+}
+
+void Chess::AllocTracker::setSamplingInterval(unsigned interval)
+{
+    s_SamplingInterval.store(interval, std::memory_order_relaxed);
+}
+
+void Chess::AllocTracker::dumpSamples(std::ostream &out)
+{
+    int count = std::min(s_SampleCount.load(std::memory_order_relaxed), MAX_SAMPLES);
+
+    // Copy first: sorting must not race with (or allocate into) the live buffer
+    std::array<Sample, MAX_SAMPLES> samples;
+    std::copy(s_Samples.begin(), s_Samples.begin() + count, samples.begin());
+    std::sort(samples.begin(), samples.begin() + count, [](const Sample &a, const Sample &b)
+              { return a.callSite < b.callSite; });
+
+    out << "Sampled allocation call sites (" << count << " samples):" << std::endl;
+    for (int i = 0; i < count;)
+    {
+        int j = i;
+        std::size_t bytes = 0;
+        while (j < count && samples[j].callSite == samples[i].callSite)
+        {
+            bytes += samples[j].size;
+            j++;
+        }
+
+        out << "  " << samples[i].callSite << ": " << (j - i) << " samples, " << bytes << " bytes" << std::endl;
+        i = j;
+    }
+}
+
+// NO ALLOC GUARD
+
+Chess::NoAllocGuard::NoAllocGuard(const char *name, Mode mode)
+    : m_PreviousName(t_State.guardName), m_PreviousMode(t_State.guardMode), m_StartViolations(t_State.violations)
+{
+    t_State.guardName = name;
+    t_State.guardMode = mode;
+}
+
+Chess::NoAllocGuard::~NoAllocGuard()
+{
+    t_State.guardName = m_PreviousName;
+    t_State.guardMode = m_PreviousMode;
+}
+
+std::uint64_t Chess::NoAllocGuard::violations() const
+{
+    return t_State.violations - m_StartViolations;
+}
+
+#endif
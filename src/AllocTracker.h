@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace Chess
+{
+    // Opt-in heap allocation tracking. When CHESS_TRACK_ALLOCATIONS is defined the global
+    // operator new/delete are replaced (AllocTracker.cpp) and every thread counts its own
+    // allocations; otherwise all of this compiles down to no-ops returning zero.
+    class AllocTracker
+    {
+    public:
+        struct Counters
+        {
+            std::uint64_t allocations = 0;
+            std::uint64_t deallocations = 0;
+            std::uint64_t bytes = 0;
+        };
+
+        struct Sample
+        {
+            const void *callSite;
+            std::size_t size;
+        };
+
+        static constexpr int MAX_SAMPLES = 1024;
+
+#ifdef CHESS_TRACK_ALLOCATIONS
+        static constexpr bool ENABLED = true;
+
+        // Counters of the calling thread
+        static Counters threadCounters();
+
+        // Counters of the whole process
+        static Counters totalCounters();
+
+        // Records the call site of every n-th allocation (0 disables sampling)
+        static void setSamplingInterval(unsigned interval);
+
+        // Prints sampled call sites grouped by address (resolve them with addr2line)
+        static void dumpSamples(std::ostream &out);
+#else
+        static constexpr bool ENABLED = false;
+
+        static Counters threadCounters() { return {}; }
+        static Counters totalCounters() { return {}; }
+        static void setSamplingInterval(unsigned) {}
+        static void dumpSamples(std::ostream &) {}
+#endif
+    };
+
+    // Marks a region that must not touch the heap: any allocation made by the owning
+    // thread while the guard is alive aborts the process or is logged to stderr.
+    class NoAllocGuard
+    {
+    public:
+        enum Mode
+        {
+            Abort,
+            Log,
+        };
+
+#ifdef CHESS_TRACK_ALLOCATIONS
+    private:
+        const char *m_PreviousName;
+        int m_PreviousMode;
+        std::uint64_t m_StartViolations;
+
+    public:
+        explicit NoAllocGuard(const char *name, Mode mode = Abort);
+        ~NoAllocGuard();
+
+        NoAllocGuard(const NoAllocGuard &) = delete;
+        NoAllocGuard &operator=(const NoAllocGuard &) = delete;
+
+        // Allocations made inside this guard so far (only grows in Log mode)
+        std::uint64_t violations() const;
+#else
+        explicit NoAllocGuard(const char *, Mode = Abort) {}
+
+        std::uint64_t violations() const { return 0; }
+#endif
+    };
+}
+
+#ifdef CHESS_TRACK_ALLOCATIONS
+#define CHESS_NO_ALLOC_CONCAT_IMPL(a, b) a##b
+#define CHESS_NO_ALLOC_CONCAT(a, b) CHESS_NO_ALLOC_CONCAT_IMPL(a, b)
+#define CHESS_NO_ALLOC_SCOPE(name, mode) Chess::NoAllocGuard CHESS_NO_ALLOC_CONCAT(noAllocGuard, __LINE__)(name, Chess::NoAllocGuard::Mode::mode)
+#else
+#define CHESS_NO_ALLOC_SCOPE(name, mode) ((void)0)
+#endif
@@ -0,0 +1,139 @@
+#include "Analyzer.h"
+#include "Tracer.h"
+
+#include <algorithm>
+
+Chess::Analyzer::Analyzer()
+{
+    m_Table.resize(DEFAULT_HASH_MB);
+}
+
+unsigned Chess::Analyzer::threadCount() const
+{
+    if (m_Threads != 0)
+        return m_Threads;
+
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+}
+
+void Chess::Analyzer::start(const Position &position, int multiPv, const Nnue::Network *network)
+{
+    stop();
+
+    unsigned threads = threadCount();
+    while (m_Workers.size() < threads)
+        m_Workers.push_back(std::make_unique<Worker>());
+    m_Workers.resize(threads);
+
+    std::uint64_t key = position.key();
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Snapshot = Snapshot();
+        m_Snapshot.key = key;
+        m_Version++;
+    }
+
+    // One table generation for all threads, so they don't age each other's entries
+    m_Table.newSearch();
+
+    for (unsigned i = 0; i < threads; i++)
+    {
+        auto &worker = *m_Workers[i];
+        worker.position = position;
+        worker.search.setNetwork(network);
+        worker.search.setTranspositionTable(m_Table.isAllocated() ? &m_Table : nullptr, false);
+
+        // Helpers only fill the table
+        SearchLimits limits;
+        limits.depth = Search::MAX_PLY;
+        limits.multiPv = i == 0 ? multiPv : 1;
+        if (i == 0)
+            worker.search.setIterationCallback([this, key](const SearchResult &result)
+                                               { report(result, key); });
+        else
+            worker.search.setIterationCallback({});
+
+        worker.thread = std::thread([this, &worker, limits, i]
+                                    {
+                                        Tracer::setThreadName("Analyzer " + std::to_string(i));
+                                        {
+                                            CHESS_TRACE_SCOPE("Analyzer search");
+                                            worker.search.run(worker.position, limits);
+                                        }
+
+                                        // Nothing is left to help once the reporting thread is done
+                                        if (i == 0)
+                                        {
+                                            for (std::size_t j = 1; j < m_Workers.size(); j++)
+                                                m_Workers[j]->search.stop();
+                                        } });
+    }
+
+    m_Running = true;
+}
+
+void Chess::Analyzer::stop()
+{
+    if (!m_Running)
+        return;
+
+    for (auto &worker : m_Workers)
+        worker->search.stop();
+    for (auto &worker : m_Workers)
+    {
+        worker->thread.join();
+        worker->search.resetSignals();
+    }
+
+    m_Running = false;
+}
+
+bool Chess::Analyzer::resizeTable(std::size_t megabytes)
+{
+    stop();
+    return m_Table.resize(megabytes);
+}
+
+void Chess::Analyzer::clearTable()
+{
+    stop();
+    m_Table.clear();
+}
+
+std::uint64_t Chess::Analyzer::nodes() const
+{
+    std::uint64_t total = 0;
+    if (m_Running)
+    {
+        for (const auto &worker : m_Workers)
+            total += worker->search.nodesSearched();
+    }
+    return total;
+}
+
+bool Chess::Analyzer::poll(Snapshot &snapshot, std::uint64_t &version) const
+{
+    std::lock_guard lock(m_Mutex);
+    if (version == m_Version)
+        return false;
+
+    snapshot = m_Snapshot;
+    version = m_Version;
+    return true;
+}
+
+void Chess::Analyzer::report(const SearchResult &result, std::uint64_t key)
+{
+    std::uint64_t nodes = 0;
+    for (const auto &worker : m_Workers)
+        nodes += worker->search.nodesSearched();
+
+    std::lock_guard lock(m_Mutex);
+    m_Snapshot.key = key;
+    m_Snapshot.depth = result.depth;
+    m_Snapshot.nodes = nodes;
+    m_Snapshot.timeMs = result.timeMs;
+    m_Snapshot.lines = result.lines;
+    m_Version++;
+}
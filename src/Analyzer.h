@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Nnue.h"
+#include "Position.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+namespace Chess
+{
+    // Infinite multi-PV analysis of one position on several threads (Lazy SMP): every thread
+    // searches the same position through one shared transposition table, and the first one
+    // reports its lines. The table is kept from one position to the next, so analysis after
+    // a move or an undo starts from what was already found. All methods are for the owning
+    // thread only.
+    class Analyzer
+    {
+    public:
+        static constexpr std::size_t DEFAULT_HASH_MB = 64;
+
+        struct Snapshot
+        {
+            std::uint64_t key = 0; // Position analyzed
+            int depth = 0;
+            std::uint64_t nodes = 0; // All threads
+            std::int64_t timeMs = 0;
+            std::vector<PvLine> lines; // Best first
+        };
+
+    private:
+        struct Worker
+        {
+            Search search;
+            Position position; // Searched in place
+            std::thread thread;
+        };
+
+        TranspositionTable m_Table;
+        std::vector<std::unique_ptr<Worker>> m_Workers;
+        unsigned m_Threads = 0;
+        bool m_Running = false;
+
+        // Written by the reporting thread after every iteration
+        mutable std::mutex m_Mutex;
+        Snapshot m_Snapshot;
+        std::uint64_t m_Version = 0;
+
+    public:
+        Analyzer();
+
+        ~Analyzer()
+        {
+            stop();
+        }
+
+        Analyzer(const Analyzer &) = delete;
+        Analyzer &operator=(const Analyzer &) = delete;
+
+        // Stops any running analysis first
+        void start(const Position &position, int multiPv, const Nnue::Network *network);
+        void stop();
+
+        // Until stop(), even once every line is a proven mate
+        bool isRunning() const
+        {
+            return m_Running;
+        }
+
+        // 0 = every hardware thread but one, which is left to the window. From the next start().
+        void setThreads(unsigned threads)
+        {
+            m_Threads = threads;
+        }
+
+        unsigned threadCount() const;
+
+        // Live total over all threads
+        std::uint64_t nodes() const;
+
+        // Both stop the analysis first; false if the new table can't be allocated
+        bool resizeTable(std::size_t megabytes);
+        void clearTable();
+
+        const TranspositionTable &table() const
+        {
+            return m_Table;
+        }
+
+        // Copies the latest report if it is newer than version (and updates version)
+        bool poll(Snapshot &snapshot, std::uint64_t &version) const;
+
+    private:
+        void report(const SearchResult &result, std::uint64_t key);
+    };
+}
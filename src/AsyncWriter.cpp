@@ -0,0 +1,210 @@
+#include "AsyncWriter.h"
+#include "Tracer.h"
+
+#include <chrono>
+#include <cstring>
+
+#ifdef CHESS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// CHANNEL
+
+void Chess::AsyncWriter::Channel::write(const void *data, std::size_t size)
+{
+    auto bytes = static_cast<const std::byte *>(data);
+    while (size > 0)
+    {
+        std::size_t chunk = std::min(size, BUFFER_SIZE - m_Buffer.size());
+        m_Buffer.insert(m_Buffer.end(), bytes, bytes + chunk);
+        bytes += chunk;
+        size -= chunk;
+
+        if (m_Buffer.size() == BUFFER_SIZE)
+        {
+            m_Writer->submit(std::move(m_Buffer));
+            m_Buffer = m_Writer->acquire();
+        }
+    }
+}
+
+void Chess::AsyncWriter::Channel::flush()
+{
+    if (m_Buffer.empty())
+        return;
+
+    m_Writer->submit(std::move(m_Buffer));
+    m_Buffer = m_Writer->acquire();
+}
+
+// WRITER
+
+bool Chess::AsyncWriter::compressionAvailable()
+{
+#ifdef CHESS_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Chess::AsyncWriter::open(const std::string &path, bool compress)
+{
+    close();
+
+    if (compress)
+    {
+#ifdef CHESS_HAVE_ZLIB
+        // Fast level: the writer thread has to keep up with every generator
+        m_Compressed = gzopen(path.c_str(), "wb1");
+        if (m_Compressed == nullptr)
+            return false;
+        gzbuffer(static_cast<gzFile>(m_Compressed), 1 << 20);
+#else
+        return false;
+#endif
+    }
+    else
+    {
+        m_File = std::fopen(path.c_str(), "wb");
+        if (m_File == nullptr)
+            return false;
+        std::setvbuf(m_File, nullptr, _IONBF, 0); // Buffers are already large
+    }
+
+    m_Statistics = {};
+    m_Closing = false;
+    m_Failed = false;
+    m_Thread = std::thread([this]
+                           { writerLoop(); });
+    return true;
+}
+
+bool Chess::AsyncWriter::close()
+{
+    if (!m_Thread.joinable())
+        return !m_Failed;
+
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Closing = true;
+    }
+    m_Ready.notify_one();
+    m_Thread.join();
+
+    if (m_File != nullptr)
+    {
+        m_Failed |= std::fclose(m_File) != 0;
+        m_File = nullptr;
+    }
+#ifdef CHESS_HAVE_ZLIB
+    if (m_Compressed != nullptr)
+    {
+        m_Failed |= gzclose(static_cast<gzFile>(m_Compressed)) != Z_OK;
+        m_Compressed = nullptr;
+    }
+#endif
+
+    m_FreeBuffers.clear();
+    return !m_Failed;
+}
+
+Chess::AsyncWriter::Buffer Chess::AsyncWriter::acquire()
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        if (!m_FreeBuffers.empty())
+        {
+            Buffer buffer = std::move(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+            return buffer;
+        }
+        m_Statistics.buffersAllocated++;
+    }
+
+    // Never wait for the writer: a new buffer costs memory, not time
+    Buffer buffer;
+    buffer.reserve(BUFFER_SIZE);
+    return buffer;
+}
+
+void Chess::AsyncWriter::submit(Buffer &&buffer)
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        if (buffer.empty())
+        {
+            m_FreeBuffers.push_back(std::move(buffer));
+            return;
+        }
+        m_Statistics.bytesSubmitted += buffer.size();
+        m_Statistics.queuedBytes += buffer.size();
+        m_Queue.push_back(std::move(buffer));
+    }
+    m_Ready.notify_one();
+}
+
+Chess::AsyncWriter::Statistics Chess::AsyncWriter::statistics() const
+{
+    std::lock_guard lock(m_Mutex);
+    return m_Statistics;
+}
+
+bool Chess::AsyncWriter::writeBuffer(const Buffer &buffer)
+{
+#ifdef CHESS_HAVE_ZLIB
+    if (m_Compressed != nullptr)
+        return gzwrite(static_cast<gzFile>(m_Compressed), buffer.data(), static_cast<unsigned>(buffer.size())) == static_cast<int>(buffer.size());
+#endif
+    return std::fwrite(buffer.data(), 1, buffer.size(), m_File) == buffer.size();
+}
+
+void Chess::AsyncWriter::writerLoop()
+{
+    Tracer::setThreadName("Writer");
+
+    while (true)
+    {
+        Buffer buffer;
+        {
+            std::unique_lock lock(m_Mutex);
+            m_Ready.wait(lock, [this]
+                         { return m_Closing || !m_Queue.empty(); });
+
+            if (m_Queue.empty())
+                break; // Closing with nothing left
+
+            buffer = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+
+        // The lock is not held while writing
+        auto start = std::chrono::steady_clock::now();
+        bool written;
+        {
+            CHESS_TRACE_SCOPE("AsyncWriter write");
+            written = writeBuffer(buffer);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::lock_guard lock(m_Mutex);
+        m_Failed |= !written;
+        m_Statistics.buffersWritten++;
+        m_Statistics.queuedBytes -= buffer.size();
+        if (m_Compressed == nullptr)
+            m_Statistics.bytesWritten += buffer.size();
+        m_Statistics.writeSeconds += elapsed.count();
+        buffer.clear();
+        m_FreeBuffers.push_back(std::move(buffer));
+    }
+
+    // The compressed size is only known once the stream is finished
+#ifdef CHESS_HAVE_ZLIB
+    if (m_Compressed != nullptr)
+    {
+        gzflush(static_cast<gzFile>(m_Compressed), Z_FINISH);
+        std::lock_guard lock(m_Mutex);
+        m_Statistics.bytesWritten = static_cast<std::uint64_t>(gzoffset(static_cast<gzFile>(m_Compressed)));
+    }
+#endif
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Chess
+{
+    // Appends to a file from a background thread. Producers fill their own buffers and hand
+    // them over whole: submitting only queues the buffer and takes a recycled (or new) one,
+    // so producer threads never wait for the disk. Output is optionally gzip compressed.
+    class AsyncWriter
+    {
+    public:
+        using Buffer = std::vector<std::byte>;
+
+        static constexpr std::size_t BUFFER_SIZE = std::size_t(4) << 20;
+
+        struct Statistics
+        {
+            std::uint64_t bytesSubmitted = 0;
+            std::uint64_t bytesWritten = 0; // After compression
+            std::uint64_t buffersWritten = 0;
+            std::uint64_t buffersAllocated = 0;
+            std::uint64_t queuedBytes = 0;
+            double writeSeconds = 0.0;
+        };
+
+        // Per-thread front end: collects writes and submits full buffers
+        class Channel
+        {
+        private:
+            AsyncWriter *m_Writer;
+            Buffer m_Buffer;
+
+        public:
+            explicit Channel(AsyncWriter &writer)
+                : m_Writer(&writer), m_Buffer(writer.acquire())
+            {
+            }
+
+            ~Channel()
+            {
+                flush();
+            }
+
+            Channel(const Channel &) = delete;
+            Channel &operator=(const Channel &) = delete;
+
+            void write(const void *data, std::size_t size);
+
+            // Submits the partial buffer
+            void flush();
+        };
+
+    private:
+        std::FILE *m_File = nullptr;
+        void *m_Compressed = nullptr; // gzFile
+
+        std::thread m_Thread;
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_Ready;
+
+        std::deque<Buffer> m_Queue;
+        std::vector<Buffer> m_FreeBuffers;
+        Statistics m_Statistics;
+        bool m_Closing = false;
+        bool m_Failed = false;
+
+    public:
+        AsyncWriter() = default;
+
+        ~AsyncWriter()
+        {
+            close();
+        }
+
+        AsyncWriter(const AsyncWriter &) = delete;
+        AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+        // Returns false if the file can't be created or compression isn't built in (CHESS_HAVE_ZLIB)
+        bool open(const std::string &path, bool compress = false);
+
+        // Writes everything still queued and closes the file; returns false if any write failed
+        bool close();
+
+        bool isOpen() const
+        {
+            return m_Thread.joinable();
+        }
+
+        static bool compressionAvailable();
+
+        // Empty buffer with BUFFER_SIZE capacity
+        Buffer acquire();
+
+        // Queues a buffer for writing (empty buffers are just recycled)
+        void submit(Buffer &&buffer);
+
+        Statistics statistics() const;
+
+    private:
+        void writerLoop();
+        bool writeBuffer(const Buffer &buffer);
+    };
+}
@@ -0,0 +1,160 @@
+#include "BatchEval.h"
+#include "Evaluation.h"
+#include "Nnue.h"
+#include "Position.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CHESS_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CHESS_PREFETCH(address) ((void)0)
+#endif
+
+namespace
+{
+    using namespace Chess;
+    using namespace Chess::Nnue;
+
+    constexpr int MAX_FEATURES = 30; // 32 pieces minus the kings
+    constexpr int PREFETCH_DISTANCE = 4;
+
+    // Structure of arrays for one block of positions
+    struct FeatureBlock
+    {
+        std::array<std::uint8_t, BATCH_BLOCK> sideToMove;
+        std::array<std::uint8_t, BATCH_BLOCK> featureCount;
+        std::array<std::array<std::array<std::int32_t, MAX_FEATURES>, BATCH_BLOCK>, 2> features;
+    };
+
+    void extractFeatures(const PackedPosition *positions, std::size_t count, FeatureBlock &block)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (i + PREFETCH_DISTANCE < count)
+                CHESS_PREFETCH(positions + i + PREFETCH_DISTANCE);
+
+            const auto &position = positions[i];
+
+            // Decode squares and codes, locating the kings on the way
+            std::array<std::uint8_t, 32> squares, codes;
+            std::array<int, 2> kings = {0, 0};
+            int pieceCount = 0;
+
+            int nibble = 0;
+            for (auto occupied = position.occupancy; occupied && nibble < 32; occupied &= occupied - 1, nibble++)
+            {
+                int square = std::countr_zero(occupied);
+                int code = (position.pieces[nibble / 2] >> ((nibble % 2) * 4)) & 0xf;
+
+                if ((code & 7) == 6)
+                {
+                    kings[code >> 3] = square;
+                    continue;
+                }
+
+                squares[pieceCount] = static_cast<std::uint8_t>(square);
+                codes[pieceCount] = static_cast<std::uint8_t>(code);
+                pieceCount++;
+            }
+
+            int featureCount = std::min(pieceCount, MAX_FEATURES);
+            for (int perspective = 0; perspective < 2; perspective++)
+            {
+                auto &features = block.features[perspective][i];
+                for (int f = 0; f < featureCount; f++)
+                    features[f] = featureIndex(perspective, kings[perspective], codes[f], squares[f]);
+            }
+
+            block.sideToMove[i] = position.sideToMove;
+            block.featureCount[i] = static_cast<std::uint8_t>(featureCount);
+        }
+    }
+
+    void prefetchRows(const Network &network, const FeatureBlock &block, std::size_t i)
+    {
+        for (int perspective = 0; perspective < 2; perspective++)
+        {
+            for (int f = 0; f < block.featureCount[i]; f++)
+                CHESS_PREFETCH(network.featureWeights(block.features[perspective][i][f]));
+        }
+    }
+
+    std::int16_t saturate(int value)
+    {
+        return static_cast<std::int16_t>(std::clamp(value, -32767, 32767));
+    }
+
+    void evaluateBlock(const PackedPosition *positions, std::size_t count, std::int16_t *out)
+    {
+        // Without a network, the same hand-crafted evaluation as the search
+        const auto &network = defaultNetwork();
+        if (!network.isLoaded())
+        {
+            // One pawn table per worker, kept across blocks and batches like a search thread's
+            thread_local PawnTable pawnTable;
+
+            Position position;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                position.setPacked(positions[i]);
+                out[i] = saturate(Evaluation::evaluate(position, &pawnTable));
+            }
+            return;
+        }
+
+        FeatureBlock block;
+        extractFeatures(positions, count, block);
+
+        Accumulator accumulator;
+        std::array<const std::int16_t *, MAX_FEATURES> rows;
+
+        if (count != 0)
+            prefetchRows(network, block, 0);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (i + 1 < count)
+                prefetchRows(network, block, i + 1);
+
+            for (int perspective = 0; perspective < 2; perspective++)
+            {
+                int featureCount = block.featureCount[i];
+                for (int f = 0; f < featureCount; f++)
+                    rows[f] = network.featureWeights(block.features[perspective][i][f]);
+
+                auto &values = accumulator.values[perspective];
+                std::memcpy(values.data(), network.featureBiases(), sizeof(values));
+                updateRows(values.data(), rows.data(), featureCount, nullptr, 0);
+            }
+
+            out[i] = saturate(network.evaluate(accumulator, block.sideToMove[i]));
+        }
+    }
+}
+
+void Chess::Nnue::evaluateBatch(std::span<const PackedPosition> positions, std::span<std::int16_t> out, ThreadPool *pool)
+{
+    std::size_t count = std::min(positions.size(), out.size());
+
+    auto evaluateRange = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t block = begin; block < end; block += BATCH_BLOCK)
+            evaluateBlock(positions.data() + block, std::min(BATCH_BLOCK, end - block), out.data() + block);
+    };
+
+    if (pool == nullptr || pool->size() <= 1 || count <= BATCH_BLOCK)
+    {
+        evaluateRange(0, count);
+        return;
+    }
+
+    // A few chunks per worker keeps them busy without contending on the queue
+    std::size_t chunks = pool->size() * 4;
+    std::size_t grain = std::max<std::size_t>(BATCH_BLOCK, (count / chunks + BATCH_BLOCK - 1) / BATCH_BLOCK * BATCH_BLOCK);
+    pool->parallelFor(count, grain, evaluateRange);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "PackedPosition.h"
+
+namespace Chess
+{
+    class ThreadPool;
+}
+
+namespace Chess::Nnue
+{
+    // Positions are processed in blocks: features of a whole block are extracted first
+    // (structure of arrays), then accumulated while the next rows are prefetched
+    constexpr std::size_t BATCH_BLOCK = 64;
+
+    // Scores positions[i] into out[i] (centipawns for the side to move, saturated to int16)
+    // with the default network, or with the search's hand-crafted evaluation if no network is
+    // loaded. out must be at least as long as positions. With a pool, blocks are evaluated
+    // in parallel.
+    void evaluateBatch(std::span<const PackedPosition> positions, std::span<std::int16_t> out, ThreadPool *pool = nullptr);
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace Chess
+{
+    // One bit per square, bit 0 = a1, bit 63 = h8 (same indexing as Game::m_Pieces)
+    using Bitboard = std::uint64_t;
+
+    namespace Bitboards
+    {
+        enum Direction
+        {
+            North,
+            South,
+            East,
+            West,
+            NorthEast,
+            SouthWest,
+            NorthWest,
+            SouthEast,
+            DirectionCount,
+        };
+
+        // Opposite directions differ only in the lowest bit
+        constexpr std::array<int, DirectionCount> FILE_STEP = {0, 0, 1, -1, 1, -1, -1, 1};
+        constexpr std::array<int, DirectionCount> RANK_STEP = {1, -1, 0, 0, 1, -1, 1, -1};
+
+        constexpr Bitboard squareBit(int square)
+        {
+            return Bitboard(1) << square;
+        }
+
+        // Index of the lowest set bit, which is cleared
+        constexpr int popLsb(Bitboard &bitboard)
+        {
+            int square = std::countr_zero(bitboard);
+            bitboard &= bitboard - 1;
+            return square;
+        }
+
+        constexpr int count(Bitboard bitboard)
+        {
+            return std::popcount(bitboard);
+        }
+
+        // GENERATORS (compile time only)
+
+        namespace Detail
+        {
+            constexpr bool onBoard(int file, int rank)
+            {
+                return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+            }
+
+            template <std::size_t N>
+            consteval std::array<Bitboard, 64> leaperAttacks(const std::array<std::array<int, 2>, N> &offsets)
+            {
+                std::array<Bitboard, 64> table{};
+                for (int square = 0; square < 64; square++)
+                {
+                    for (const auto &offset : offsets)
+                    {
+                        int file = square % 8 + offset[0];
+                        int rank = square / 8 + offset[1];
+                        if (onBoard(file, rank))
+                            table[square] |= squareBit(rank * 8 + file);
+                    }
+                }
+                return table;
+            }
+
+            consteval std::array<std::array<Bitboard, 64>, 2> pawnAttacks()
+            {
+                return {
+                    leaperAttacks<2>({{{-1, 1}, {1, 1}}}),   // White
+                    leaperAttacks<2>({{{-1, -1}, {1, -1}}}), // Black
+                };
+            }
+
+            consteval std::array<std::array<Bitboard, 64>, DirectionCount> rays()
+            {
+                std::array<std::array<Bitboard, 64>, DirectionCount> table{};
+                for (int direction = 0; direction < DirectionCount; direction++)
+                {
+                    for (int square = 0; square < 64; square++)
+                    {
+                        int file = square % 8 + FILE_STEP[direction];
+                        int rank = square / 8 + RANK_STEP[direction];
+                        while (onBoard(file, rank))
+                        {
+                            table[direction][square] |= squareBit(rank * 8 + file);
+                            file += FILE_STEP[direction];
+                            rank += RANK_STEP[direction];
+                        }
+                    }
+                }
+                return table;
+            }
+
+            // Squares strictly between two aligned squares (or the full line through them)
+            consteval std::array<std::array<Bitboard, 64>, 64> alignedMasks(bool fullLine)
+            {
+                auto rayTable = rays();
+                std::array<std::array<Bitboard, 64>, 64> table{};
+                for (int from = 0; from < 64; from++)
+                {
+                    for (int direction = 0; direction < DirectionCount; direction++)
+                    {
+                        auto ray = rayTable[direction][from];
+                        auto opposite = rayTable[direction ^ 1][from];
+                        for (auto targets = ray; targets;)
+                        {
+                            int to = popLsb(targets);
+                            table[from][to] = fullLine ? (ray | opposite | squareBit(from))
+                                                       : (ray & rayTable[direction ^ 1][to]);
+                        }
+                    }
+                }
+                return table;
+            }
+
+            consteval std::array<std::array<std::uint8_t, 64>, 64> distances()
+            {
+                std::array<std::array<std::uint8_t, 64>, 64> table{};
+                for (int a = 0; a < 64; a++)
+                {
+                    for (int b = 0; b < 64; b++)
+                    {
+                        int fileDistance = a % 8 > b % 8 ? a % 8 - b % 8 : b % 8 - a % 8;
+                        int rankDistance = a / 8 > b / 8 ? a / 8 - b / 8 : b / 8 - a / 8;
+                        table[a][b] = static_cast<std::uint8_t>(fileDistance > rankDistance ? fileDistance : rankDistance);
+                    }
+                }
+                return table;
+            }
+        }
+
+        // TABLES (read-only data, nothing is computed at run time)
+
+        inline constexpr std::array<Bitboard, 64> KNIGHT_ATTACKS = Detail::leaperAttacks<8>({{{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}}});
+        inline constexpr std::array<Bitboard, 64> KING_ATTACKS = Detail::leaperAttacks<8>({{{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}}});
+
+        // PAWN_ATTACKS[color][square], color 0 = White, 1 = Black
+        inline constexpr std::array<std::array<Bitboard, 64>, 2> PAWN_ATTACKS = Detail::pawnAttacks();
+
+        // RAYS[direction][square]: every square in that direction up to the edge
+        inline constexpr std::array<std::array<Bitboard, 64>, DirectionCount> RAYS = Detail::rays();
+
+        // BETWEEN[a][b]: squares strictly between a and b, empty if not on a rank, file or diagonal
+        inline constexpr std::array<std::array<Bitboard, 64>, 64> BETWEEN = Detail::alignedMasks(false);
+
+        // LINE[a][b]: the whole rank, file or diagonal through a and b, empty if not aligned
+        inline constexpr std::array<std::array<Bitboard, 64>, 64> LINE = Detail::alignedMasks(true);
+
+        // DISTANCE[a][b]: king steps from a to b
+        inline constexpr std::array<std::array<std::uint8_t, 64>, 64> DISTANCE = Detail::distances();
+
+        // SLIDING ATTACKS
+
+        // Squares along one ray up to and including the first occupied one
+        constexpr Bitboard rayAttacks(int direction, int square, Bitboard occupied)
+        {
+            Bitboard ray = RAYS[direction][square];
+            Bitboard blockers = ray & occupied;
+            if (blockers == 0)
+                return ray;
+
+            // North, East, NorthEast and NorthWest run towards higher squares
+            bool increasing = direction == North || direction == East || direction == NorthEast || direction == NorthWest;
+            int blocker = increasing ? std::countr_zero(blockers) : 63 - std::countl_zero(blockers);
+            return ray ^ RAYS[direction][blocker];
+        }
+
+        constexpr Bitboard rookAttacks(int square, Bitboard occupied)
+        {
+            return rayAttacks(North, square, occupied) | rayAttacks(South, square, occupied) |
+                   rayAttacks(East, square, occupied) | rayAttacks(West, square, occupied);
+        }
+
+        constexpr Bitboard bishopAttacks(int square, Bitboard occupied)
+        {
+            return rayAttacks(NorthEast, square, occupied) | rayAttacks(SouthWest, square, occupied) |
+                   rayAttacks(NorthWest, square, occupied) | rayAttacks(SouthEast, square, occupied);
+        }
+
+        constexpr Bitboard queenAttacks(int square, Bitboard occupied)
+        {
+            return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+        }
+
+        // Sanity checks (a1 = 0, e4 = 28, h8 = 63)
+        static_assert(count(KNIGHT_ATTACKS[0]) == 2 && count(KNIGHT_ATTACKS[28]) == 8);
+        static_assert(count(KING_ATTACKS[0]) == 3 && count(KING_ATTACKS[28]) == 8);
+        static_assert(PAWN_ATTACKS[0][28] == (squareBit(35) | squareBit(37)));
+        static_assert(PAWN_ATTACKS[1][24] == squareBit(17));
+        static_assert(count(RAYS[NorthEast][0]) == 7 && RAYS[West][0] == 0);
+        static_assert(count(BETWEEN[0][63]) == 6 && BETWEEN[0][63] == BETWEEN[63][0]);
+        static_assert(BETWEEN[0][1] == 0 && BETWEEN[0][10] == 0 && LINE[0][10] == 0);
+        static_assert(count(LINE[0][9]) == 8 && (LINE[0][9] & squareBit(63)));
+        static_assert(DISTANCE[0][63] == 7 && DISTANCE[28][29] == 1 && DISTANCE[12][12] == 0);
+        static_assert(count(rookAttacks(0, 0)) == 14 && rookAttacks(0, squareBit(8) | squareBit(1)) == (squareBit(8) | squareBit(1)));
+        static_assert(count(bishopAttacks(28, squareBit(37) | squareBit(19))) == 9);
+    }
+}
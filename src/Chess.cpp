@@ -1,13 +1,68 @@
 #include "Chess.h"
 
-Chess::Game::Game(sf::RenderWindow &window, sf::Color whiteColor, sf::Color blackColor)
-    : m_Pieces(), m_FenBuffer(STANDARD_FEN),
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+// Lowercase symbol by piece type code
+constexpr std::string_view PROMOTION_SYMBOLS = " prnbqk";
+
+// Engine move matching a move of the board, none if the engine finds it illegal
+static Chess::PackedMove findLegalMove(const Chess::Position &position, const Chess::Move &move)
+{
+    Chess::MoveList moves;
+    position.generateLegal(moves);
+
+    auto match = std::find_if(moves.begin(), moves.end(), [&](Chess::PackedMove legal)
+                              { return legal.from() == move.from && legal.to() == move.to &&
+                                       (move.kind != Chess::Move::Kind::Promotion || PROMOTION_SYMBOLS[legal.promotionType()] == std::tolower(move.movedPieceSymbol)); });
+    return match != moves.end() ? *match : Chess::PackedMove();
+}
+
+// Move list color of a graded move: the engine's choice in green, errors from yellow to red
+static ImColor verdictColor(Chess::GameReview::Verdict verdict)
+{
+    switch (verdict)
+    {
+    case Chess::GameReview::Verdict::Best:
+        return ImColor(128, 255, 128);
+    case Chess::GameReview::Verdict::Inaccuracy:
+        return ImColor(255, 230, 100);
+    case Chess::GameReview::Verdict::Mistake:
+        return ImColor(255, 160, 60);
+    case Chess::GameReview::Verdict::Blunder:
+        return ImColor(255, 80, 80);
+    default:
+        return ImColor(255, 255, 255);
+    }
+}
+
+// Written by "Save trace" and on SIGUSR1
+constexpr auto TRACE_FILE = "chess_trace.json";
+
+// Cost of setting a checkpoint up (all squares and a full accumulator refresh), in moves
+constexpr int CHECKPOINT_RESTORE_COST = 4;
+
+Chess::Game::Game(sf::Vector2u size, sf::Color whiteColor, sf::Color blackColor)
+    : m_Pieces(), m_FenBuffer(STANDARD_FEN), m_MoveListNode(GameTree::NONE),
       m_WhiteColor(whiteColor), m_BlackColor(blackColor),
-      m_WhiteScore(0), m_BlackScore(0)
+      m_WhiteScore(0), m_BlackScore(0),
+      m_NetworkBuffer("network.nnue"),
+      m_BaseMinutes(5), m_IncrementSeconds(3),
+      m_ComputerPlays{false, false}, m_Ponder(true),
+      m_SearchKey(0), m_PonderKey(0), m_HashMegabytes(static_cast<int>(Engine::DEFAULT_HASH_MB)),
+      m_Analyze(false), m_AnalysisLines(3), m_AnalysisKey(0), m_AnalysisVersion(0),
+      m_ReviewVersion(0), m_MateKey(0), m_MateMoves(3),
+      m_IndexBuffer("games.idx"), m_IndexKey(0), m_IndexOccurrences(0), m_IndexLookupMicros(0.0),
+      m_ShowHanging(false), m_HangingPieces(0), m_HangingKey(0)
 {
 
-    m_BoardSize = window.getSize().y;
-    m_GUIOffset = window.getSize().x - m_BoardSize;
+    m_BoardSize = size.y;
+    m_GUIOffset = size.x - m_BoardSize;
     float tileSize = m_BoardSize / 8.0f;
 
     m_Tile = sf::RectangleShape(sf::Vector2f(tileSize, tileSize));
@@ -20,6 +75,22 @@ Chess::Game::Game(sf::RenderWindow &window, sf::Color whiteColor, sf::Color blac
     m_PossibleMoveBox = sf::RectangleShape(sf::Vector2f(tileSize, tileSize));
     m_PossibleMoveBox.setFillColor(sf::Color(0x00ff0055));
 
+    m_HangingBox = sf::RectangleShape(sf::Vector2f(tileSize, tileSize));
+    m_HangingBox.setFillColor(sf::Color(0xff800055));
+
+    m_ArrowHead.setPointCount(3);
+
+    // A queen in the middle of an empty board has 27 moves: never reallocate while generating
+    m_PossibleMoves.reserve(32);
+
+    // Optional evaluation network next to the executable
+    m_NetworkBuffer.resize(256);
+    m_IndexBuffer.resize(256);
+    if (!Nnue::defaultNetwork().isLoaded())
+    {
+        Nnue::defaultNetwork().load(m_NetworkBuffer.c_str());
+    }
+
     restart();
 }
 
@@ -32,6 +103,7 @@ void Chess::Game::resize(const sf::Vector2u newSize)
     m_Tile.setSize(sf::Vector2f(tileSize, tileSize));
     m_SelectedBox.setSize(sf::Vector2f(tileSize, tileSize));
     m_PossibleMoveBox.setSize(sf::Vector2f(tileSize, tileSize));
+    m_HangingBox.setSize(sf::Vector2f(tileSize, tileSize));
 
     for (auto piece : m_Pieces)
     {
@@ -42,53 +114,92 @@ void Chess::Game::resize(const sf::Vector2u newSize)
 
 void Chess::Game::restart()
 {
+    CHESS_TRACE_SCOPE("Game::restart");
+    m_Engine.stop();
+    stopReview();
+    if (m_MateFuture.valid())
+        m_MateSolver.stop(); // Reset when update() collects the result
+    m_Clock.reset(m_BaseMinutes * 60'000ll, m_IncrementSeconds * 1000ll);
+
     // Clearing
     for (int i = 0; i < 64; i++)
     {
         if (m_Pieces[i] != nullptr)
-        {
-            delete m_Pieces[i];
-            m_Pieces[i] = nullptr;
-        }
+            freePiece(i);
     }
 
+    // The ImGui buffer has a fixed size: the FEN ends at the first null character
+    std::string_view fen(m_FenBuffer.c_str());
+    m_StartFen = fen;
+
     // Updating board by parsing FEN string
     auto index = 0;
-    for (auto symbol : m_FenBuffer)
+    std::size_t cursor = 0;
+    for (; cursor < fen.size() && fen[cursor] != ' '; cursor++)
     {
-        if (symbol == '/')
-            continue;
+        auto symbol = fen[cursor];
 
-        if (symbol == ' ')
-            index = 64;
+        if (symbol == '/' || index >= 64)
+            continue;
 
-        if (index < 64)
+        // Placing pieces
+        if (std::isdigit(symbol))
         {
-            // Placing pieces
-            if (std::isdigit(symbol))
-            {
-                index += symbol - '0';
-            }
-            else
-            {
-                auto posIndex = (7 - index / 8) * 8 + index % 8;
-                m_Pieces[posIndex] = new Piece(symbol, m_Tile);
-                index++;
-            }
+            index += symbol - '0';
         }
         else
         {
-            // Parsing game info
-            if (symbol == 'w')
-            {
-                m_CurrentTurn = Piece::Color::White;
-            }
-            else if (symbol == 'b')
-            {
-                m_CurrentTurn = Piece::Color::Black;
-            }
+            auto posIndex = (7 - index / 8) * 8 + index % 8;
+            m_Pieces[posIndex] = newPiece(symbol);
+            index++;
+        }
+    }
+
+    // Parsing game info
+    std::istringstream info{std::string(fen.substr(cursor))};
+    std::string turn = "w", castling = "-", enPassant = "-";
+    int halfmoveClock = 0, fullmoveNumber = 1;
+    info >> turn >> castling >> enPassant >> halfmoveClock >> fullmoveNumber;
+
+    m_CurrentTurn = turn == "b" ? Piece::Color::Black : Piece::Color::White;
+
+    // Castling rights and double pushes are tracked through the "moved" flag
+    for (int i = 0; i < 64; i++)
+    {
+        auto piece = m_Pieces[i];
+        if (piece == nullptr)
+            continue;
+
+        if (piece->getType() == Piece::Type::Pawn)
+            piece->setMoved(indexToRank(i) != (piece->getColor() == Piece::Color::White ? 1 : 6));
+        else if (piece->getType() == Piece::Type::King || piece->getType() == Piece::Type::Rook)
+            piece->setMoved(true);
+    }
+
+    for (auto right : castling)
+    {
+        int kingIndex = std::isupper(right) ? 4 : 60;
+        int rookIndex = kingIndex + (std::tolower(right) == 'k' ? 3 : -4);
+
+        if (std::tolower(right) != 'k' && std::tolower(right) != 'q')
+            continue;
+
+        if (m_Pieces[kingIndex] != nullptr && m_Pieces[rookIndex] != nullptr)
+        {
+            m_Pieces[kingIndex]->setMoved(false);
+            m_Pieces[rookIndex]->setMoved(false);
+        }
+    }
 
-            // TODO:
+    m_InitialEnPassantSquare = -1;
+    if (enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h' && (enPassant[1] == '3' || enPassant[1] == '6'))
+    {
+        int target = fileRankToIndex(enPassant[0] - 'a', enPassant[1] - '1');
+        int pawnIndex = target + (enPassant[1] == '3' ? 8 : -8);
+        if (m_Pieces[pawnIndex] != nullptr && m_Pieces[pawnIndex]->getType() == Piece::Type::Pawn)
+        {
+            m_Pieces[pawnIndex]->setEnPassantVulnerable(true);
+            m_InitialEnPassantSquare = pawnIndex;
         }
     }
 
@@ -96,10 +207,20 @@ void Chess::Game::restart()
     m_CurrentSelectedIndex = -1;
     m_WhiteScore = 0;
     m_BlackScore = 0;
+
+    m_InitialTurn = m_CurrentTurn;
+    m_InitialFullmoveNumber = std::max(fullmoveNumber, 1);
+    m_CurrentNode = GameTree::ROOT;
+    m_MovesHistory.clear(0, std::max(halfmoveClock, 0));
+    m_MovesHistory[GameTree::ROOT].move.key = computeKey();
+    storeCheckpoint();
+
+    refreshAccumulator();
 }
 
 void Chess::Game::handleClick(sf::Vector2i mousePos)
 {
+    CHESS_TRACE_SCOPE("Game::handleClick");
     if (mousePos.x <= m_GUIOffset)
         return;
 
@@ -109,6 +230,10 @@ void Chess::Game::handleClick(sf::Vector2i mousePos)
 
     Piece *targetPiece = m_Pieces[targetIndex];
 
+    // The board is locked while the computer is to move
+    if (m_ComputerPlays[m_CurrentTurn == Piece::Color::White ? 0 : 1])
+        return;
+
     if (currentSelectedPiece() == nullptr)
     {
         // No piece is currently selected
@@ -150,18 +275,6 @@ void Chess::Game::handleClick(sf::Vector2i mousePos)
                 // Check for en passant
                 if (currentSelectedPiece()->getType() == Piece::Type::Pawn)
                 {
-                    int startRank = indexToRank(m_CurrentSelectedIndex);
-                    int targetRank = indexToRank(targetIndex);
-
-                    if (std::abs(startRank - targetRank) == 2)
-                    {
-                        currentSelectedPiece()->setEnPassantVulnerable(true);
-                    }
-                    else
-                    {
-                        currentSelectedPiece()->setEnPassantVulnerable(false);
-                    }
-
                     // Capture en passant
                     int enPassantTarget = targetIndex + (m_CurrentTurn == Piece::Color::White ? -8 : 8);
                     if (targetPiece == nullptr && std::find(m_PossibleMoves.begin(), m_PossibleMoves.end(), targetIndex) != m_PossibleMoves.end() && m_Pieces[enPassantTarget] != nullptr && m_Pieces[enPassantTarget]->getType() == Piece::Type::Pawn && m_Pieces[enPassantTarget]->isEnPassantVulnerable())
@@ -173,7 +286,10 @@ void Chess::Game::handleClick(sf::Vector2i mousePos)
                 }
             }
 
-            registerMove(m_CurrentSelectedIndex, targetIndex);
+            if (isPromotion(m_CurrentSelectedIndex, targetIndex))
+                registerPromotionMove(m_CurrentSelectedIndex, targetIndex, 'q'); // Always a queen from the board
+            else
+                registerMove(m_CurrentSelectedIndex, targetIndex);
             m_CurrentSelectedIndex = -1;
         }
         else
@@ -187,7 +303,10 @@ void Chess::Game::handleClick(sf::Vector2i mousePos)
                     return; // Target index is not a valid move
                 }
 
-                registerMove(m_CurrentSelectedIndex, targetIndex);
+                if (isPromotion(m_CurrentSelectedIndex, targetIndex))
+                    registerPromotionMove(m_CurrentSelectedIndex, targetIndex, 'q');
+                else
+                    registerMove(m_CurrentSelectedIndex, targetIndex);
                 m_CurrentSelectedIndex = -1;
             }
             else
@@ -200,8 +319,35 @@ void Chess::Game::handleClick(sf::Vector2i mousePos)
     }
 }
 
+void Chess::Game::handleKey(sf::Keyboard::Key key)
+{
+    auto last = m_CurrentNode;
+    switch (key)
+    {
+    case sf::Keyboard::Key::Left:
+        jumpTo(m_MovesHistory[m_CurrentNode].parent);
+        break;
+    case sf::Keyboard::Key::Right:
+        jumpTo(m_MovesHistory[m_CurrentNode].firstChild);
+        break;
+    case sf::Keyboard::Key::Home:
+        jumpTo(GameTree::ROOT);
+        break;
+    case sf::Keyboard::Key::End:
+        while (m_MovesHistory[last].firstChild != GameTree::NONE)
+            last = m_MovesHistory[last].firstChild;
+        jumpTo(last);
+        break;
+    default:
+        break;
+    }
+}
+
 void Chess::Game::registerMove(int from, int to)
 {
+    CHESS_PROFILE_PROBE(RegisterMove);
+    CHESS_TRACE_SCOPE("Game::registerMove");
+
     if (from < 0 || from >= 64 || to < 0 || to >= 64)
         return;
 
@@ -210,6 +356,10 @@ void Chess::Game::registerMove(int from, int to)
 
     char pieceSymbol = m_Pieces[from]->getSymbol();
     char capturedSymbol = 'x';
+    bool firstMove = !m_Pieces[from]->hasMoved();
+
+    Nnue::DirtyPieces dirty;
+    dirty.add(m_Pieces[from]->getCode(), from, to);
 
     // Check for capture
     if (m_Pieces[to] != nullptr)
@@ -226,25 +376,41 @@ void Chess::Game::registerMove(int from, int to)
 
         // Update symbol
         capturedSymbol = m_Pieces[to]->getSymbol();
+        dirty.add(m_Pieces[to]->getCode(), to, -1);
 
         // Remove
-        delete m_Pieces[to];
-        m_Pieces[to] = nullptr;
+        freePiece(to);
     }
 
     // Move
     m_Pieces[from]->setMoved(true);
+    if (m_Pieces[from]->getType() == Piece::Type::Pawn)
+    {
+        m_Pieces[from]->setEnPassantVulnerable(std::abs(indexToRank(to) - indexToRank(from)) == 2);
+    }
     std::swap(m_Pieces[from], m_Pieces[to]);
 
     // Switch turn
     m_CurrentTurn = m_CurrentTurn == Piece::Color::White ? Piece::Color::Black : Piece::Color::White;
 
+    updateAccumulator(dirty);
+
     // Register movement
-    m_MovesHistory.push(Move{from, to, pieceSymbol, capturedSymbol});
+    recordMove(Move{
+        .from = static_cast<std::uint8_t>(from),
+        .to = static_cast<std::uint8_t>(to),
+        .movedPieceSymbol = pieceSymbol,
+        .otherPieceSymbol = capturedSymbol,
+        .kind = Move::Kind::Normal,
+        .firstMove = firstMove,
+    });
 }
 
 void Chess::Game::registerCastlingMove(int kingFrom, int kingTo, int rookFrom, int rookTo)
 {
+    CHESS_PROFILE_PROBE(RegisterCastlingMove);
+    CHESS_TRACE_SCOPE("Game::registerCastlingMove");
+
     if (kingFrom < 0 || kingFrom >= 64 || kingTo < 0 || kingTo >= 64 || rookFrom < 0 || rookFrom >= 64 || rookTo < 0 || rookTo >= 64)
         return;
 
@@ -254,6 +420,10 @@ void Chess::Game::registerCastlingMove(int kingFrom, int kingTo, int rookFrom, i
     char kingSymbol = m_Pieces[kingFrom]->getSymbol();
     char rookSymbol = m_Pieces[rookFrom]->getSymbol();
 
+    Nnue::DirtyPieces dirty;
+    dirty.add(m_Pieces[kingFrom]->getCode(), kingFrom, kingTo);
+    dirty.add(m_Pieces[rookFrom]->getCode(), rookFrom, rookTo);
+
     // Move the king
     m_Pieces[kingFrom]->setMoved(true);
     std::swap(m_Pieces[kingFrom], m_Pieces[kingTo]);
@@ -265,12 +435,24 @@ void Chess::Game::registerCastlingMove(int kingFrom, int kingTo, int rookFrom, i
     // Switch turn
     m_CurrentTurn = m_CurrentTurn == Piece::Color::White ? Piece::Color::Black : Piece::Color::White;
 
-    // Register movement
-    m_MovesHistory.push(CastlingMove{kingFrom, kingTo, kingSymbol, rookSymbol, rookFrom, rookTo});
+    updateAccumulator(dirty);
+
+    // Register movement (rook squares are implied by the king move)
+    recordMove(Move{
+        .from = static_cast<std::uint8_t>(kingFrom),
+        .to = static_cast<std::uint8_t>(kingTo),
+        .movedPieceSymbol = kingSymbol,
+        .otherPieceSymbol = rookSymbol,
+        .kind = Move::Kind::Castling,
+        .firstMove = true,
+    });
 }
 
 void Chess::Game::registerEnPassantMove(int pawnFrom, int pawnTo, int capturedIndex)
 {
+    CHESS_PROFILE_PROBE(RegisterEnPassantMove);
+    CHESS_TRACE_SCOPE("Game::registerEnPassantMove");
+
     if (pawnFrom < 0 || pawnFrom >= 64 || pawnTo < 0 || pawnTo >= 64 || capturedIndex < 0 || capturedIndex >= 64)
         return;
 
@@ -279,36 +461,168 @@ void Chess::Game::registerEnPassantMove(int pawnFrom, int pawnTo, int capturedIn
 
     char pieceSymbol = m_Pieces[pawnFrom]->getSymbol();
     char capturedSymbol = m_Pieces[capturedIndex]->getSymbol();
+    bool firstMove = !m_Pieces[pawnFrom]->hasMoved();
+
+    Nnue::DirtyPieces dirty;
+    dirty.add(m_Pieces[pawnFrom]->getCode(), pawnFrom, pawnTo);
+    dirty.add(m_Pieces[capturedIndex]->getCode(), capturedIndex, -1);
 
     // Move the pawn
     m_Pieces[pawnFrom]->setMoved(true);
     std::swap(m_Pieces[pawnFrom], m_Pieces[pawnTo]);
 
     // Capture the pawn
-    delete m_Pieces[capturedIndex];
-    m_Pieces[capturedIndex] = nullptr;
+    freePiece(capturedIndex);
 
     // Switch turn
     m_CurrentTurn = m_CurrentTurn == Piece::Color::White ? Piece::Color::Black : Piece::Color::White;
 
-    // Register movement
-    m_MovesHistory.push(EnPassantMove{pawnFrom, pawnTo, pieceSymbol, capturedSymbol, capturedIndex});
+    updateAccumulator(dirty);
+
+    // Register movement (the captured pawn square is implied by the pawn move)
+    recordMove(Move{
+        .from = static_cast<std::uint8_t>(pawnFrom),
+        .to = static_cast<std::uint8_t>(pawnTo),
+        .movedPieceSymbol = pieceSymbol,
+        .otherPieceSymbol = capturedSymbol,
+        .kind = Move::Kind::EnPassant,
+        .firstMove = firstMove,
+    });
+}
+
+void Chess::Game::registerPromotionMove(int from, int to, char promotedSymbol)
+{
+    CHESS_PROFILE_PROBE(RegisterMove);
+    CHESS_TRACE_SCOPE("Game::registerPromotionMove");
+
+    if (from < 0 || from >= 64 || to < 0 || to >= 64)
+        return;
+
+    if (m_Pieces[from] == nullptr)
+        return;
+
+    // The promoted piece takes the pawn's color
+    bool white = m_Pieces[from]->getColor() == Piece::Color::White;
+    promotedSymbol = static_cast<char>(white ? std::toupper(promotedSymbol) : std::tolower(promotedSymbol));
+    char capturedSymbol = 'x';
+
+    Nnue::DirtyPieces dirty;
+    dirty.add(m_Pieces[from]->getCode(), from, -1);
+
+    // Check for capture
+    if (m_Pieces[to] != nullptr)
+    {
+        if (white)
+        {
+            m_WhiteScore += m_Pieces[to]->getValue();
+        }
+        else
+        {
+            m_BlackScore += m_Pieces[to]->getValue();
+        }
+
+        capturedSymbol = m_Pieces[to]->getSymbol();
+        dirty.add(m_Pieces[to]->getCode(), to, -1);
+        freePiece(to);
+    }
+
+    // Replace the pawn
+    freePiece(from);
+    m_Pieces[to] = newPiece(promotedSymbol);
+    m_Pieces[to]->setMoved(true);
+    dirty.add(m_Pieces[to]->getCode(), -1, to);
+
+    // Switch turn
+    m_CurrentTurn = m_CurrentTurn == Piece::Color::White ? Piece::Color::Black : Piece::Color::White;
+
+    updateAccumulator(dirty);
+
+    // Register movement (the pawn is implied by the kind)
+    recordMove(Move{
+        .from = static_cast<std::uint8_t>(from),
+        .to = static_cast<std::uint8_t>(to),
+        .movedPieceSymbol = promotedSymbol,
+        .otherPieceSymbol = capturedSymbol,
+        .kind = Move::Kind::Promotion,
+        .firstMove = false,
+    });
+}
+
+void Chess::Game::recordMove(Move move)
+{
+    bool capture = move.kind != Move::Kind::Castling && move.otherPieceSymbol != 'x';
+    bool pawnMove = std::tolower(move.movedPieceSymbol) == 'p' || move.kind == Move::Kind::Promotion;
+
+    move.halfmoveClock = (capture || pawnMove) ? 0 : halfmoveClock() + 1;
+
+    // Replaying a known move just walks into the existing variation
+    auto child = m_MovesHistory.findChild(m_CurrentNode, move);
+    if (child == GameTree::NONE)
+    {
+        child = m_MovesHistory.addChild(m_CurrentNode, move);
+        m_CurrentNode = child;
+
+        // The en passant part of the key depends on the node just entered
+        m_MovesHistory[child].move.key = computeKey();
+        if (m_MovesHistory[child].ply % GameTree::CHECKPOINT_INTERVAL == 0)
+            storeCheckpoint();
+    }
+
+    m_CurrentNode = child;
+}
+
+void Chess::Game::playMove(const Move &move)
+{
+    switch (move.kind)
+    {
+    case Move::Kind::Normal:
+        registerMove(move.from, move.to);
+        break;
+    case Move::Kind::Castling:
+        registerCastlingMove(move.from, move.to, move.rookFrom(), move.rookTo());
+        break;
+    case Move::Kind::EnPassant:
+        registerEnPassantMove(move.from, move.to, move.enPassantTarget());
+        break;
+    case Move::Kind::Promotion:
+        registerPromotionMove(move.from, move.to, move.movedPieceSymbol);
+        break;
+    }
+}
+
+void Chess::Game::redoMove(GameTree::NodeIndex child)
+{
+    if (child == GameTree::NONE || m_MovesHistory[child].parent != m_CurrentNode)
+        return;
+
+    m_CurrentSelectedIndex = -1;
+    playMove(m_MovesHistory[child].move);
 }
 
 void Chess::Game::undoLastMove()
 {
-    if (m_MovesHistory.size() == 0)
+    CHESS_PROFILE_PROBE(UndoLastMove);
+    CHESS_TRACE_SCOPE("Game::undoLastMove");
+
+    if (m_CurrentNode == GameTree::ROOT)
         return;
 
-    std::variant<Move, CastlingMove, EnPassantMove> lastMove = m_MovesHistory.top();
+    // The node stays in the tree: only the board steps back
+    const Move move = m_MovesHistory[m_CurrentNode].move;
+    m_CurrentSelectedIndex = -1;
+
+    Nnue::DirtyPieces dirty;
+    if (move.kind != Move::Kind::Promotion)
+        dirty.add(m_Pieces[move.to]->getCode(), move.to, move.from);
 
-    if (std::holds_alternative<Move>(lastMove))
+    switch (move.kind)
     {
-        auto move = std::get<Move>(lastMove);
+    case Move::Kind::Normal:
         std::swap(m_Pieces[move.to], m_Pieces[move.from]);
         if (move.otherPieceSymbol != 'x')
         {
-            m_Pieces[move.to] = new Piece(move.otherPieceSymbol, m_Tile);
+            m_Pieces[move.to] = newPiece(move.otherPieceSymbol);
+            dirty.add(m_Pieces[move.to]->getCode(), -1, move.to);
             if (m_CurrentTurn == Piece::Color::White)
             {
                 m_BlackScore -= m_Pieces[move.to]->getValue();
@@ -318,145 +632,1268 @@ void Chess::Game::undoLastMove()
                 m_WhiteScore -= m_Pieces[move.to]->getValue();
             }
         }
-        m_Pieces[move.from]->setMoved(false);
-    }
-    else if (std::holds_alternative<CastlingMove>(lastMove))
-    {
-        auto move = std::get<CastlingMove>(lastMove);
+        break;
+    case Move::Kind::Castling:
         std::swap(m_Pieces[move.to], m_Pieces[move.from]);
-        std::swap(m_Pieces[move.rookTo], m_Pieces[move.rookFrom]);
-        m_Pieces[move.from]->setMoved(false);
-        m_Pieces[move.rookFrom]->setMoved(false);
-    }
-    else if (std::holds_alternative<EnPassantMove>(lastMove))
-    {
-        auto move = std::get<EnPassantMove>(lastMove);
+        std::swap(m_Pieces[move.rookTo()], m_Pieces[move.rookFrom()]);
+        m_Pieces[move.rookFrom()]->setMoved(false);
+        dirty.add(m_Pieces[move.rookFrom()]->getCode(), move.rookTo(), move.rookFrom());
+        break;
+    case Move::Kind::EnPassant:
         std::swap(m_Pieces[move.to], m_Pieces[move.from]);
-        m_Pieces[move.enPassantTarget] = new Piece(move.otherPieceSymbol, m_Tile);
+        m_Pieces[move.enPassantTarget()] = newPiece(move.otherPieceSymbol);
+        dirty.add(m_Pieces[move.enPassantTarget()]->getCode(), -1, move.enPassantTarget());
         if (m_CurrentTurn == Piece::Color::White)
         {
-            m_BlackScore -= m_Pieces[move.enPassantTarget]->getValue();
+            m_BlackScore -= m_Pieces[move.enPassantTarget()]->getValue();
         }
         else
         {
-            m_WhiteScore -= m_Pieces[move.enPassantTarget]->getValue();
+            m_WhiteScore -= m_Pieces[move.enPassantTarget()]->getValue();
         }
-        m_Pieces[move.from]->setMoved(false);
+        break;
+    case Move::Kind::Promotion:
+        // Back to a pawn (which had necessarily moved before)
+        dirty.add(m_Pieces[move.to]->getCode(), move.to, -1);
+        freePiece(move.to);
+        m_Pieces[move.from] = newPiece(std::isupper(move.movedPieceSymbol) ? 'P' : 'p');
+        m_Pieces[move.from]->setMoved(true);
+        dirty.add(m_Pieces[move.from]->getCode(), -1, move.from);
+        if (move.otherPieceSymbol != 'x')
+        {
+            m_Pieces[move.to] = newPiece(move.otherPieceSymbol);
+            dirty.add(m_Pieces[move.to]->getCode(), -1, move.to);
+            if (m_CurrentTurn == Piece::Color::White)
+            {
+                m_BlackScore -= m_Pieces[move.to]->getValue();
+            }
+            else
+            {
+                m_WhiteScore -= m_Pieces[move.to]->getValue();
+            }
+        }
+        break;
     }
 
-    m_MovesHistory.pop();
+    if (move.firstMove)
+        m_Pieces[move.from]->setMoved(false);
+
+    m_CurrentNode = m_MovesHistory[m_CurrentNode].parent;
     m_CurrentTurn = m_CurrentTurn == Piece::Color::White ? Piece::Color::Black : Piece::Color::White;
+
+    updateAccumulator(dirty);
 }
 
-void Chess::Game::prepareGUI()
+void Chess::Game::jumpTo(GameTree::NodeIndex node)
 {
-    // Preparing UI
-    ImGui::SetNextWindowPos(ImVec2(0, 0));
-    ImGui::SetNextWindowSize(ImVec2(m_GUIOffset, m_BoardSize));
+    CHESS_TRACE_SCOPE("Game::jumpTo");
+    if (node == GameTree::NONE || node == m_CurrentNode)
+        return;
 
-    ImGui::Begin("Control Panel", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar);
+    // Back to the common ancestor and down again, or down from the closest checkpoint
+    auto common = m_MovesHistory.commonAncestor(m_CurrentNode, node);
+    auto anchor = m_MovesHistory.checkpointAbove(node);
+    int walk = m_MovesHistory[m_CurrentNode].ply + m_MovesHistory[node].ply - 2 * m_MovesHistory[common].ply;
+    int restore = anchor != GameTree::NONE ? m_MovesHistory[node].ply - m_MovesHistory[anchor].ply + CHECKPOINT_RESTORE_COST : std::numeric_limits<int>::max();
 
-    // RESET
-    ImGui::TextColored(ImColor(255, 255, 128), "Reset");
-    if (ImGui::Button("Reset"))
+    GameTree::NodeIndex start;
+    if (walk <= restore)
     {
-        m_FenBuffer = STANDARD_FEN;
-        restart();
-    };
-    if (ImGui::Button("Undo"))
+        while (m_CurrentNode != common)
+            undoLastMove();
+        start = common;
+    }
+    else
     {
-        undoLastMove();
+        restoreCheckpoint(anchor);
+        start = anchor;
     }
 
-    ImGui::Spacing();
-    ImGui::Separator();
-    ImGui::Spacing();
+    // Replayed from the top, so collected bottom up first
+    std::vector<GameTree::NodeIndex> path;
+    for (auto at = node; at != start; at = m_MovesHistory[at].parent)
+        path.push_back(at);
 
-    // RESET WITH FEN
-    ImGui::TextColored(ImColor(255, 255, 128), "Restart with FEN");
-    ImGui::InputText("FEN", m_FenBuffer.data(), m_FenBuffer.size());
-    if (ImGui::Button("Restart"))
-    {
-        // TODO: Validate
-        restart();
-    };
-    ImGui::Spacing();
-    ImGui::Separator();
-    ImGui::Spacing();
+    m_CurrentSelectedIndex = -1;
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+        playMove(m_MovesHistory[*it].move);
+}
 
-    // INFORMATIONS
-    ImGui::TextColored(ImColor(255, 255, 128), "Informations:");
-    ImGui::Text("Turn: %s", m_CurrentTurn == Chess::Piece::Color::White ? "White" : "Black");
-    ImGui::TextColored(ImColor(255, 255, 128), "Scores:");
-    ImGui::Text("White: %u", m_WhiteScore);
-    ImGui::Text("Black: %u", m_BlackScore);
-    ImGui::Spacing();
-    ImGui::Separator();
-    ImGui::Spacing();
+void Chess::Game::storeCheckpoint()
+{
+    GameTree::Checkpoint checkpoint;
+    for (int i = 0; i < 64; i++)
+        checkpoint.pieces[i] = m_Pieces[i] != nullptr ? m_Pieces[i]->getDescriptor() : 0;
+    checkpoint.whiteScore = m_WhiteScore;
+    checkpoint.blackScore = m_BlackScore;
+    m_MovesHistory.setCheckpoint(m_CurrentNode, checkpoint);
+}
 
-    // DEBUG
-    ImGui::TextColored(ImColor(255, 255, 128), "Debug:");
-    if (ImGui::Button("Print moves history"))
-    {
-        auto tempStack = m_MovesHistory;
+void Chess::Game::restoreCheckpoint(GameTree::NodeIndex node)
+{
+    const auto &checkpoint = *m_MovesHistory.checkpoint(node);
 
-        std::cout << "Moves history:" << std::endl;
-        while (!tempStack.empty())
+    // Pieces already on the board are turned into whatever stands on their square
+    for (int i = 0; i < 64; i++)
+    {
+        if (checkpoint.pieces[i] == 0)
         {
-            auto move = tempStack.top();
-            tempStack.pop();
-
-            if (std::holds_alternative<Move>(move))
-            {
-                auto m = std::get<Move>(move);
-                std::cout << "Move from " << m.from << " to " << m.to << " with piece " << m.movedPieceSymbol << " capturing " << m.otherPieceSymbol << std::endl;
-            }
-            else if (std::holds_alternative<CastlingMove>(move))
-            {
-                auto m = std::get<CastlingMove>(move);
-                std::cout << "Castling move: King from " << m.from << " to " << m.to << " and Rook from " << m.rookFrom << " to " << m.rookTo << std::endl;
-            }
-            else if (std::holds_alternative<EnPassantMove>(move))
-            {
-                auto m = std::get<EnPassantMove>(move);
-                std::cout << "En Passant move: Pawn from " << m.from << " to " << m.to << " capturing at " << m.enPassantTarget << std::endl;
-            }
+            if (m_Pieces[i] != nullptr)
+                freePiece(i);
+            continue;
         }
-        std::cout << std::endl;
+
+        if (m_Pieces[i] == nullptr)
+            m_Pieces[i] = newPiece('P');
+        m_Pieces[i]->setDescriptor(checkpoint.pieces[i]);
     }
 
-    ImGui::End();
+    m_WhiteScore = checkpoint.whiteScore;
+    m_BlackScore = checkpoint.blackScore;
+
+    bool initialSide = m_MovesHistory[node].ply % 2 == 0;
+    m_CurrentTurn = initialSide == (m_InitialTurn == Piece::Color::White) ? Piece::Color::White : Piece::Color::Black;
+    m_CurrentNode = node;
+    m_CurrentSelectedIndex = -1;
+
+    refreshAccumulator();
 }
 
-void Chess::Game::draw(sf::RenderTarget &target, sf::RenderStates states) const
+Chess::Piece *Chess::Game::newPiece(char symbol)
 {
-    states.transform.translate(sf::Vector2f(m_GUIOffset, 0));
+    if (m_SparePieces.empty())
+        return new Piece(symbol, m_Tile);
+
+    // Spares may come from before a resize
+    Piece *piece = m_SparePieces.back();
+    m_SparePieces.pop_back();
+    piece->setDescriptor(Piece::descriptorOf(symbol));
+    piece->resizeSprite(m_Tile.getSize());
+    return piece;
+}
 
-    // Rendering Board
+void Chess::Game::freePiece(int index)
+{
+    m_SparePieces.push_back(m_Pieces[index]);
+    m_Pieces[index] = nullptr;
+}
+
+std::array<std::uint8_t, 64> Chess::Game::boardCodes() const
+{
+    std::array<std::uint8_t, 64> codes{};
     for (int i = 0; i < 64; i++)
     {
-        int file = indexToFile(i);
-        int rank = indexToRank(i);
-
-        // Drawing tile
-        m_Tile.setPosition(sf::Vector2f(file * m_Tile.getSize().x, (7 - rank) * m_Tile.getSize().y));
-        m_Tile.setFillColor((file + rank) % 2 == 0 ? m_BlackColor : m_WhiteColor);
-        target.draw(m_Tile, states);
-
-        // Drawing piece
-        auto piece = m_Pieces[i];
-        if (piece != nullptr)
-        {
-            piece->setPosition(sf::Vector2f(file * m_Tile.getSize().x, (7 - rank) * m_Tile.getSize().y));
-            target.draw(*piece, states);
-        }
+        if (m_Pieces[i] != nullptr)
+            codes[i] = static_cast<std::uint8_t>(m_Pieces[i]->getCode());
     }
+    return codes;
+}
 
-    // Drawing overlays
-    if (m_CurrentSelectedIndex != -1)
+int Chess::Game::kingSquare(Piece::Color color) const
+{
+    for (int i = 0; i < 64; i++)
     {
-        int file = indexToFile(m_CurrentSelectedIndex);
-        int rank = indexToRank(m_CurrentSelectedIndex);
+        if (m_Pieces[i] != nullptr && m_Pieces[i]->getType() == Piece::Type::King && m_Pieces[i]->getColor() == color)
+            return i;
+    }
+    return -1;
+}
+
+void Chess::Game::refreshAccumulator()
+{
+    const auto &network = Nnue::defaultNetwork();
+    if (!network.isLoaded())
+        return;
+
+    auto board = boardCodes();
+    network.refresh(m_Accumulator, 0, board);
+    network.refresh(m_Accumulator, 1, board);
+}
+
+void Chess::Game::updateAccumulator(const Nnue::DirtyPieces &dirty)
+{
+    const auto &network = Nnue::defaultNetwork();
+    if (!network.isLoaded())
+        return;
+
+    std::array<int, 2> kings = {kingSquare(Piece::Color::White), kingSquare(Piece::Color::Black)};
+    if (kings[0] == -1 || kings[1] == -1)
+    {
+        refreshAccumulator();
+        return;
+    }
+
+    // Only the side whose king moved needs every feature recomputed
+    int stale = network.update(m_Accumulator, kings, dirty);
+    if (stale != 0)
+    {
+        auto board = boardCodes();
+        for (int perspective = 0; perspective < 2; perspective++)
+        {
+            if (stale & (1 << perspective))
+                network.refresh(m_Accumulator, perspective, board);
+        }
+    }
+}
+
+std::uint64_t Chess::Game::computeKey() const
+{
+    std::uint64_t key = 0;
+
+    for (int i = 0; i < 64; i++)
+    {
+        if (m_Pieces[i] != nullptr)
+            key ^= Zobrist::KEYS.piece[m_Pieces[i]->getCode()][i];
+    }
+
+    if (m_CurrentTurn == Piece::Color::Black)
+        key ^= Zobrist::KEYS.side;
+
+    key ^= Zobrist::KEYS.castling[castlingRights()];
+
+    int epFile = enPassantFile();
+    if (epFile != -1)
+        key ^= Zobrist::KEYS.enPassant[epFile];
+
+    return key;
+}
+
+int Chess::Game::castlingRights() const
+{
+    auto unmoved = [this](int index, char symbol)
+    {
+        return m_Pieces[index] != nullptr && m_Pieces[index]->getSymbol() == symbol && !m_Pieces[index]->hasMoved();
+    };
+
+    int rights = 0;
+    if (unmoved(4, 'K'))
+    {
+        rights |= unmoved(7, 'R') ? Zobrist::WhiteKingside : 0;
+        rights |= unmoved(0, 'R') ? Zobrist::WhiteQueenside : 0;
+    }
+    if (unmoved(60, 'k'))
+    {
+        rights |= unmoved(63, 'r') ? Zobrist::BlackKingside : 0;
+        rights |= unmoved(56, 'r') ? Zobrist::BlackQueenside : 0;
+    }
+    return rights;
+}
+
+int Chess::Game::enPassantFile() const
+{
+    // Square of the pawn that just made a double push
+    int pawnIndex = m_InitialEnPassantSquare;
+    if (m_CurrentNode != GameTree::ROOT)
+    {
+        const auto &last = m_MovesHistory[m_CurrentNode].move;
+        bool doublePush = last.kind == Move::Kind::Normal && std::tolower(last.movedPieceSymbol) == 'p' && std::abs(last.to - last.from) == 16;
+        pawnIndex = doublePush ? last.to : -1;
+    }
+
+    if (pawnIndex == -1)
+        return -1;
+
+    // Only counts when a pawn of the side to move can actually take it
+    int file = indexToFile(pawnIndex);
+    int rank = indexToRank(pawnIndex);
+    for (int captureFile : {file - 1, file + 1})
+    {
+        if (captureFile < 0 || captureFile > 7)
+            continue;
+
+        auto piece = m_Pieces[fileRankToIndex(captureFile, rank)];
+        if (piece != nullptr && piece->getType() == Piece::Type::Pawn && piece->getColor() == m_CurrentTurn)
+            return file;
+    }
+    return -1;
+}
+
+int Chess::Game::repetitionCount() const
+{
+    // Only positions after the last irreversible move can repeat, with the same side to move
+    const auto &current = m_MovesHistory[m_CurrentNode].move;
+    int limit = current.halfmoveClock;
+
+    int count = 1;
+    auto node = m_CurrentNode;
+    for (int ply = 1; ply <= limit && node != GameTree::ROOT; ply++)
+    {
+        node = m_MovesHistory[node].parent;
+        if (ply % 2 == 0 && m_MovesHistory[node].move.key == current.key)
+            count++;
+    }
+    return count;
+}
+
+std::string Chess::Game::currentFen() const
+{
+    int side = m_CurrentTurn == Piece::Color::White ? 0 : 1;
+    int epFile = enPassantFile();
+    int epSquare = epFile == -1 ? -1 : fileRankToIndex(epFile, side == 0 ? 5 : 2);
+    return PackedPosition::fromBoard(boardCodes(), side, castlingRights(), epSquare, halfmoveClock(), fullmoveNumber()).toFen();
+}
+
+Chess::Position Chess::Game::toPosition() const
+{
+    std::vector<Move> line;
+    for (auto node = m_CurrentNode; node != GameTree::ROOT; node = m_MovesHistory[node].parent)
+    {
+        line.push_back(m_MovesHistory[node].move);
+    }
+
+    // Replaying the line keeps the history for repetition detection
+    Position position;
+    bool replayed = position.setFen(m_StartFen);
+    for (auto it = line.rbegin(); replayed && it != line.rend(); ++it)
+    {
+        auto move = findLegalMove(position, *it);
+        replayed = !move.isNone();
+        if (replayed)
+            position.makeMove(move);
+    }
+
+    // The board accepts moves the engine doesn't (leaving the king in check): start from here
+    if (!replayed)
+        position.setFen(currentFen());
+    return position;
+}
+
+void Chess::Game::applyEngineMove(PackedMove move)
+{
+    int from = move.from(), to = move.to();
+    m_CurrentSelectedIndex = -1;
+
+    switch (move.kind())
+    {
+    case PackedMove::Castling:
+        registerCastlingMove(from, to, to > from ? from + 3 : from - 4, to > from ? from + 1 : from - 1);
+        break;
+    case PackedMove::EnPassant:
+        registerEnPassantMove(from, to, to + (m_CurrentTurn == Piece::Color::White ? -8 : 8));
+        break;
+    case PackedMove::Promotion:
+        registerPromotionMove(from, to, PROMOTION_SYMBOLS[move.promotionType()]);
+        break;
+    default:
+        registerMove(from, to);
+        break;
+    }
+}
+
+Chess::SearchLimits Chess::Game::clockLimits(int side) const
+{
+    // Without a running clock the computer takes a fixed time per move
+    constexpr std::int64_t UNTIMED_MOVE_MS = 1000;
+
+    SearchLimits limits;
+    if (m_Clock.running() != -1)
+    {
+        limits.timeLeftMs = std::max<std::int64_t>(m_Clock.remaining(side), 1);
+        limits.incrementMs = m_Clock.increment();
+    }
+    else
+    {
+        limits.moveTimeMs = UNTIMED_MOVE_MS;
+    }
+    return limits;
+}
+
+void Chess::Game::startThinking()
+{
+    auto position = toPosition();
+
+    MoveList moves;
+    position.generateLegal(moves);
+    if (moves.size() == 0 || isThreefoldRepetition() || isFiftyMoveDraw())
+        return;
+
+    const auto &network = Nnue::defaultNetwork();
+    m_SearchKey = computeKey();
+    m_PonderKey = 0;
+    m_Engine.start(position, clockLimits(position.sideToMove()), network.isLoaded() ? &network : nullptr);
+}
+
+void Chess::Game::startPondering()
+{
+    // Only on the time of a human opponent, with a predicted reply
+    int side = m_CurrentTurn == Piece::Color::White ? 0 : 1;
+    if (!m_Ponder || m_ComputerPlays[side] || m_LastResult.pv.size() < 2)
+        return;
+
+    auto position = toPosition();
+    PackedMove predicted = m_LastResult.pv[1];
+
+    MoveList moves;
+    position.generateLegal(moves);
+    if (std::find(moves.begin(), moves.end(), predicted) == moves.end())
+        return;
+
+    m_SearchKey = computeKey();
+    position.makeMove(predicted);
+    m_PonderKey = position.key();
+
+    auto limits = clockLimits(side ^ 1);
+    limits.ponder = true;
+
+    const auto &network = Nnue::defaultNetwork();
+    m_Engine.start(position, limits, network.isLoaded() ? &network : nullptr);
+}
+
+void Chess::Game::update()
+{
+    // The running clock follows the side to move
+    auto syncClock = [this]
+    {
+        int side = m_CurrentTurn == Piece::Color::White ? 0 : 1;
+        if (m_Clock.running() != -1 && m_Clock.running() != side)
+            m_Clock.press();
+        if (m_Clock.running() != -1 && m_Clock.flagged() != -1)
+        {
+            m_Clock.stop();
+            m_Engine.stop();
+        }
+    };
+    syncClock();
+
+    std::uint64_t key = computeKey();
+    int side = m_CurrentTurn == Piece::Color::White ? 0 : 1;
+    if (m_Engine.isPondering())
+    {
+        // Ponderhit: the search already running becomes the real one, unless the computer
+        // no longer plays that side. Pondering also ends if it now plays the side to move.
+        if (key == m_PonderKey && m_ComputerPlays[side])
+        {
+            m_Engine.ponderHit();
+            m_SearchKey = key;
+        }
+        else if (key != m_SearchKey || m_ComputerPlays[side])
+        {
+            m_Engine.stop();
+        }
+    }
+    else if (m_Engine.isSearching())
+    {
+        // Undo, redo or restart under the engine's feet, or the side handed back to a human
+        if (key != m_SearchKey || !m_ComputerPlays[side])
+        {
+            m_Engine.stop();
+        }
+        else if (m_Engine.poll(m_LastResult))
+        {
+            applyEngineMove(m_LastResult.bestMove);
+            syncClock();
+            if (m_Clock.flagged() == -1)
+                startPondering();
+        }
+    }
+
+    side = m_CurrentTurn == Piece::Color::White ? 0 : 1;
+    if (!m_Engine.isSearching() && m_ComputerPlays[side] && m_Clock.flagged() == -1)
+        startThinking();
+
+    // Analysis follows the board
+    key = computeKey();
+    if (m_Analyze)
+    {
+        if (!m_Analyzer.isRunning() || key != m_AnalysisKey)
+            startAnalysis();
+        if (m_Analyzer.poll(m_Analysis, m_AnalysisVersion))
+            formatAnalysis();
+    }
+
+    // Recomputed once per position
+    if (m_ShowHanging && key != m_HangingKey)
+    {
+        Position position;
+        position.setFen(currentFen());
+        m_HangingPieces = position.hangingPieces(0) | position.hangingPieces(1);
+        m_HangingKey = key;
+    }
+
+    m_Review.poll(m_ReviewResults, m_ReviewVersion);
+
+    // A finished mate check only counts for the position it was started on
+    if (m_MateFuture.valid() && m_MateFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        auto result = m_MateFuture.get();
+        m_MateSolver.resetSignals();
+        if (key == m_MateKey)
+            formatMateResult(result);
+    }
+    if (!m_MateText.empty() && key != m_MateKey)
+        m_MateText.clear();
+
+    if (Tracer::takeDumpRequest())
+        saveTrace();
+
+#ifdef CHESS_PROFILING
+    Profiler::EngineStats stats;
+    stats.running = m_Engine.isSearching();
+    stats.nodesPerSecond = m_LastResult.timeMs > 0 ? m_LastResult.nodes * 1000.0 / m_LastResult.timeMs : 0.0;
+    stats.hashFull = m_Engine.table().hashfull();
+    auto pawns = m_Engine.pawnTable().statistics();
+    stats.pawnHitRate = pawns.hits + pawns.misses > 0 ? 100.0 * pawns.hits / (pawns.hits + pawns.misses) : 0.0;
+    Profiler::get().setEngineStats(stats);
+#endif
+}
+
+void Chess::Game::prepareClockGUI()
+{
+    ImGui::TextColored(ImColor(255, 255, 128), "Clock:");
+    if (ImGui::InputInt("Base (min)", &m_BaseMinutes))
+        m_BaseMinutes = std::clamp(m_BaseMinutes, 1, 180);
+    if (ImGui::InputInt("Increment (s)", &m_IncrementSeconds))
+        m_IncrementSeconds = std::clamp(m_IncrementSeconds, 0, 60);
+
+    int side = m_CurrentTurn == Piece::Color::White ? 0 : 1;
+    if (ImGui::Button("Start clock"))
+    {
+        m_Clock.reset(m_BaseMinutes * 60'000ll, m_IncrementSeconds * 1000ll);
+        m_Clock.start(side);
+    }
+    ImGui::SameLine();
+    if (m_Clock.running() != -1)
+    {
+        if (ImGui::Button("Pause"))
+            m_Clock.stop();
+    }
+    else if (m_Clock.flagged() == -1 && ImGui::Button("Resume"))
+    {
+        m_Clock.start(side);
+    }
+
+    for (int clockSide = 0; clockSide < 2; clockSide++)
+    {
+        auto text = GameClock::format(m_Clock.remaining(clockSide));
+        const char *name = clockSide == 0 ? "White" : "Black";
+        if (m_Clock.flagged() == clockSide)
+            ImGui::TextColored(ImColor(255, 128, 128), "%s: %s (lost on time)", name, text.c_str());
+        else
+            ImGui::Text("%s: %s%s", name, text.c_str(), m_Clock.running() == clockSide ? " <" : "");
+    }
+
+    ImGui::Checkbox("Computer plays White", &m_ComputerPlays[0]);
+    ImGui::Checkbox("Computer plays Black", &m_ComputerPlays[1]);
+    ImGui::Checkbox("Ponder", &m_Ponder);
+    if (!m_Ponder && m_Engine.isPondering())
+        m_Engine.stop();
+
+    if (m_Engine.isSearching())
+        ImGui::Text("Engine: %s", m_Engine.isPondering() ? "pondering" : "thinking");
+    else
+        ImGui::TextDisabled("Engine: idle");
+
+    // Transposition table, kept across moves until resized or cleared
+    if (ImGui::InputInt("Hash (MB)", &m_HashMegabytes, 16, 256))
+        m_HashMegabytes = std::clamp(m_HashMegabytes, 1, 4096);
+    if (ImGui::Button("Resize hash"))
+    {
+        // Analysis uses a table of the same size
+        auto megabytes = static_cast<std::size_t>(m_HashMegabytes);
+        if (!m_Engine.resizeTable(megabytes) || !m_Analyzer.resizeTable(megabytes))
+            std::cerr << "Could not allocate a " << m_HashMegabytes << " MB hash table" << std::endl;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear hash"))
+    {
+        m_Engine.clearTable();
+        m_Analyzer.clearTable();
+    }
+
+    auto &table = m_Engine.table();
+    auto probes = table.statistics();
+    std::uint64_t total = probes.hits + probes.misses;
+    ImGui::Text("Hash: %zu MB, %.1f%% full, %.1f%% hits", table.sizeMegabytes(), table.hashfull() / 10.0, total > 0 ? probes.hits * 100.0 / total : 0.0);
+
+    if (!m_LastResult.bestMove.isNone())
+    {
+        ImGui::Text("Last: %s depth %d score %+.2f", m_LastResult.bestMove.toUci().c_str(), m_LastResult.depth, m_LastResult.score / 100.0);
+        ImGui::Text("%llu nodes in %lld ms", static_cast<unsigned long long>(m_LastResult.nodes), static_cast<long long>(m_LastResult.timeMs));
+    }
+}
+
+void Chess::Game::startAnalysis()
+{
+    m_AnalysisPosition = toPosition();
+    m_AnalysisKey = computeKey();
+    m_AnalysisText.clear();
+
+    const auto &network = Nnue::defaultNetwork();
+    m_Analyzer.start(m_AnalysisPosition, m_AnalysisLines, network.isLoaded() ? &network : nullptr);
+}
+
+void Chess::Game::formatAnalysis()
+{
+    // Only the start of long lines fits the panel
+    constexpr std::size_t SHOWN_MOVES = 8;
+
+    m_AnalysisText.clear();
+    if (m_Analysis.key != m_AnalysisKey)
+        return;
+
+    for (const auto &line : m_Analysis.lines)
+    {
+        // From White's point of view, like the evaluation
+        int score = m_AnalysisPosition.sideToMove() == 0 ? line.score : -line.score;
+        std::string text(16, '\0');
+        if (Search::isMateScore(score))
+        {
+            int moves = (Search::MATE_SCORE - std::abs(score) + 1) / 2;
+            text.resize(std::snprintf(text.data(), text.size(), "#%s%d", score < 0 ? "-" : "", moves));
+        }
+        else
+        {
+            text.resize(std::snprintf(text.data(), text.size(), "%+.2f", score / 100.0));
+        }
+
+        auto position = m_AnalysisPosition;
+        for (std::size_t i = 0; i < std::min(line.pv.size(), SHOWN_MOVES); i++)
+        {
+            text += ' ';
+            text += position.toSan(line.pv[i]);
+            position.makeMove(line.pv[i]);
+        }
+        if (line.pv.size() > SHOWN_MOVES)
+            text += " ...";
+
+        m_AnalysisText.push_back(std::move(text));
+    }
+}
+
+void Chess::Game::prepareAnalysisGUI()
+{
+    constexpr int MAX_LINES = 5;
+
+    ImGui::TextColored(ImColor(255, 255, 128), "Analysis:");
+    if (ImGui::Checkbox("Analyze", &m_Analyze) && !m_Analyze)
+    {
+        m_Analyzer.stop();
+        m_AnalysisText.clear();
+        m_Analysis = {};
+    }
+    if (ImGui::InputInt("Lines", &m_AnalysisLines))
+    {
+        m_AnalysisLines = std::clamp(m_AnalysisLines, 1, MAX_LINES);
+        m_AnalysisKey = 0; // Restarts with the new count
+    }
+
+    if (!m_Analyze)
+        return;
+
+    std::int64_t elapsedMs = std::max<std::int64_t>(m_Analysis.timeMs, 1);
+    ImGui::Text("Depth %d, %.0f knps on %u threads", m_Analysis.depth, m_Analysis.nodes / static_cast<double>(elapsedMs), m_Analyzer.threadCount());
+    for (std::size_t i = 0; i < m_AnalysisText.size(); i++)
+    {
+        auto color = i == 0 ? ImColor(128, 255, 128) : ImColor(160, 200, 255);
+        ImGui::TextColored(color, "%zu. %s", i + 1, m_AnalysisText[i].c_str());
+    }
+}
+
+void Chess::Game::startReview()
+{
+    // The displayed line, up to the first move the engine doesn't accept
+    Position start;
+    if (!start.setFen(m_StartFen))
+        return;
+
+    auto position = start;
+    std::vector<PackedMove> moves;
+    m_ReviewNodes.clear();
+    for (auto node : m_DisplayedLine)
+    {
+        auto move = findLegalMove(position, m_MovesHistory[node].move);
+        if (move.isNone())
+            break;
+        position.makeMove(move);
+        moves.push_back(move);
+        m_ReviewNodes.push_back(node);
+    }
+
+    SearchLimits limits;
+    limits.nodes = GameReview::DEFAULT_NODES;
+    const auto &network = Nnue::defaultNetwork();
+    if (!m_Review.start(start, moves, limits, network.isLoaded() ? &network : nullptr))
+    {
+        std::cerr << "Failed to allocate the review hash table" << std::endl;
+        m_ReviewNodes.clear();
+    }
+}
+
+void Chess::Game::stopReview()
+{
+    m_Review.stop();
+    m_ReviewResults = {};
+    m_ReviewNodes.clear();
+}
+
+void Chess::Game::prepareReviewGUI()
+{
+    ImGui::TextColored(ImColor(255, 255, 128), "Review:");
+    if (m_Review.isRunning())
+    {
+        if (ImGui::Button("Stop review"))
+            m_Review.stop();
+    }
+    else if (ImGui::Button("Review game"))
+    {
+        startReview();
+    }
+
+    const auto &positions = m_ReviewResults.positions;
+    if (positions.empty())
+        return;
+
+    ImGui::SameLine();
+    ImGui::Text("%zu/%zu positions, %.1f s on %u threads", m_ReviewResults.completed, positions.size(), m_ReviewResults.timeMs / 1000.0, GameReview::threadCount());
+
+    // White's winning chances after each move; positions still searching keep the last value
+    std::vector<float> chances(positions.size());
+    float last = 50.0f;
+    for (std::size_t i = 0; i < positions.size(); i++)
+    {
+        if (positions[i].done)
+            last = static_cast<float>(GameReview::winPercent(positions[i].score));
+        chances[i] = last;
+    }
+    ImGui::PlotLines("##ReviewGraph", chances.data(), static_cast<int>(chances.size()), 0, "White %", 0.0f, 100.0f, ImVec2(0, 60));
+
+    // Errors by side (the move list marks each one)
+    std::array<std::array<int, 3>, 2> errors{};
+    int blackFirst = m_InitialTurn == Piece::Color::Black ? 1 : 0;
+    for (std::size_t i = 0; i < m_ReviewResults.verdicts.size(); i++)
+    {
+        auto verdict = m_ReviewResults.verdicts[i];
+        if (verdict >= GameReview::Verdict::Inaccuracy)
+            errors[(i + blackFirst) % 2][static_cast<int>(verdict) - static_cast<int>(GameReview::Verdict::Inaccuracy)]++;
+    }
+    for (int side = 0; side < 2; side++)
+        ImGui::Text("%s: %d inaccuracies, %d mistakes, %d blunders", side == 0 ? "White" : "Black", errors[side][0], errors[side][1], errors[side][2]);
+}
+
+void Chess::Game::startMateCheck()
+{
+    m_MatePosition = toPosition();
+    m_MateKey = computeKey();
+    m_MateText.clear();
+    m_MateFuture = std::async(std::launch::async, [this, position = m_MatePosition, moves = m_MateMoves]
+                              { return m_MateSolver.solve(position, moves); });
+}
+
+void Chess::Game::formatMateResult(const MateSolver::Result &result)
+{
+    if (result.status == MateSolver::Status::NoMate)
+    {
+        m_MateText = "No mate in " + std::to_string(m_MateMoves);
+        return;
+    }
+    if (result.status == MateSolver::Status::Unknown)
+    {
+        m_MateText = "Unknown after " + std::to_string(result.nodes) + " nodes";
+        return;
+    }
+
+    auto position = m_MatePosition;
+    m_MateText = "Mate in " + std::to_string(result.mateIn) + ":";
+    for (auto move : result.line)
+    {
+        m_MateText += " " + position.toSan(move);
+        position.makeMove(move);
+    }
+
+    // A composition or puzzle is sound only with a single key move
+    if (result.isUnique())
+        m_MateText += " (unique)";
+    else
+        m_MateText += " (" + std::to_string(result.keyMoves.size()) + " key moves)";
+}
+
+void Chess::Game::prepareMateGUI()
+{
+    ImGui::TextColored(ImColor(255, 255, 128), "Mate check:");
+    if (m_MateFuture.valid())
+    {
+        if (ImGui::Button("Stop check"))
+            m_MateSolver.stop();
+        ImGui::SameLine();
+        ImGui::Text("Solving mate in %d...", m_MateMoves);
+        return;
+    }
+
+    if (ImGui::Button("Verify mate"))
+        startMateCheck();
+    ImGui::SameLine();
+    if (ImGui::InputInt("Moves", &m_MateMoves))
+        m_MateMoves = std::clamp(m_MateMoves, 1, 8);
+
+    if (!m_MateText.empty())
+        ImGui::TextWrapped("%s", m_MateText.c_str());
+}
+
+void Chess::Game::saveDiagram(const std::string &path, bool svg)
+{
+    if (!m_Diagrams.isLoaded() && !m_Diagrams.load("assets"))
+        return;
+    m_Diagrams.setColors(m_WhiteColor.toInteger(), m_BlackColor.toInteger());
+
+    // The selected piece and its moves are highlighted as on the board
+    DiagramRenderer::Options options;
+    options.size = static_cast<int>(m_BoardSize);
+    if (m_CurrentSelectedIndex != -1)
+    {
+        options.highlights |= Bitboards::squareBit(m_CurrentSelectedIndex);
+        for (auto square : m_PossibleMoves)
+            options.highlights |= Bitboards::squareBit(square);
+    }
+
+    auto board = boardCodes();
+    std::vector<std::uint8_t> png;
+    std::string text = svg ? m_Diagrams.renderSvg(board, options) : std::string();
+    if (!svg && !m_Diagrams.renderPng(board, options, png))
+    {
+        std::cerr << "PNG diagrams need zlib" << std::endl;
+        return;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (svg)
+        file << text;
+    else
+        file.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+
+    if (file)
+        std::cout << "Saved " << path << std::endl;
+    else
+        std::cerr << "Could not write " << path << std::endl;
+}
+
+void Chess::Game::saveTrace()
+{
+    std::size_t events = 0;
+    if (Tracer::writeChromeTrace(TRACE_FILE, &events))
+        m_TraceStatus = std::to_string(events) + " events in " + TRACE_FILE;
+    else
+        m_TraceStatus = std::string("Could not write ") + TRACE_FILE;
+}
+
+void Chess::Game::prepareGUI()
+{
+    CHESS_TRACE_SCOPE("Game::prepareGUI");
+    // Preparing UI
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(ImVec2(m_GUIOffset, m_BoardSize));
+
+    ImGui::Begin("Control Panel", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar);
+
+    // RESET
+    ImGui::TextColored(ImColor(255, 255, 128), "Reset");
+    if (ImGui::Button("Reset"))
+    {
+        m_FenBuffer = STANDARD_FEN;
+        restart();
+    };
+    if (ImGui::Button("Undo"))
+    {
+        undoLastMove();
+    }
+
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // RESET WITH FEN
+    ImGui::TextColored(ImColor(255, 255, 128), "Restart with FEN");
+    ImGui::InputText("FEN", m_FenBuffer.data(), m_FenBuffer.size());
+    if (ImGui::Button("Restart"))
+    {
+        // TODO: Validate
+        restart();
+    };
+    if (ImGui::Button("Save PNG"))
+    {
+        saveDiagram("diagram.png", false);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save SVG"))
+    {
+        saveDiagram("diagram.svg", true);
+    }
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // CLOCK
+    prepareClockGUI();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // ANALYSIS
+    prepareAnalysisGUI();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // REVIEW
+    prepareReviewGUI();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // MATE CHECK
+    prepareMateGUI();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // INFORMATIONS
+    ImGui::TextColored(ImColor(255, 255, 128), "Informations:");
+    ImGui::Text("Turn: %s", m_CurrentTurn == Chess::Piece::Color::White ? "White" : "Black");
+    ImGui::Text("Move: %d (halfmove clock %d)", fullmoveNumber(), halfmoveClock());
+    if (isThreefoldRepetition())
+    {
+        ImGui::TextColored(ImColor(255, 128, 128), "Draw: threefold repetition");
+    }
+    else if (isFiftyMoveDraw())
+    {
+        ImGui::TextColored(ImColor(255, 128, 128), "Draw: fifty-move rule");
+    }
+    if (ImGui::Checkbox("Show hanging pieces", &m_ShowHanging))
+        m_HangingKey = 0;
+    ImGui::TextColored(ImColor(255, 255, 128), "Scores:");
+    ImGui::Text("White: %u", m_WhiteScore);
+    ImGui::Text("Black: %u", m_BlackScore);
+
+    const auto &network = Nnue::defaultNetwork();
+    if (network.isLoaded())
+    {
+        int eval = network.evaluate(m_Accumulator, m_CurrentTurn == Piece::Color::White ? 0 : 1);
+        ImGui::Text("Evaluation: %+.2f (%s)", (m_CurrentTurn == Piece::Color::White ? eval : -eval) / 100.0, Nnue::kernelName(Nnue::activeKernel()));
+    }
+    else
+    {
+        ImGui::TextDisabled("Evaluation: no network loaded");
+    }
+    ImGui::InputText("Network", m_NetworkBuffer.data(), m_NetworkBuffer.size());
+    if (ImGui::Button("Load network"))
+    {
+        // The engine and the analysis read the network while they search
+        m_Engine.stop();
+        m_Analyzer.stop();
+        m_Review.stop();
+        if (Nnue::defaultNetwork().load(m_NetworkBuffer.c_str()))
+            refreshAccumulator();
+        else
+            std::cerr << "Failed to load network " << m_NetworkBuffer.c_str() << std::endl;
+    }
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // MOVES
+    prepareMoveListGUI();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // VARIATIONS
+    prepareVariationsGUI();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // POSITION INDEX
+    prepareIndexGUI();
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    // DEBUG
+    ImGui::TextColored(ImColor(255, 255, 128), "Debug:");
+    if (ImGui::Button("Print moves history"))
+    {
+        std::vector<Move> line;
+        for (auto node = m_CurrentNode; node != GameTree::ROOT; node = m_MovesHistory[node].parent)
+        {
+            line.push_back(m_MovesHistory[node].move);
+        }
+
+        std::cout << "Moves history:" << std::endl;
+        for (auto it = line.rbegin(); it != line.rend(); ++it)
+        {
+            const auto &m = *it;
+            switch (m.kind)
+            {
+            case Move::Kind::Normal:
+                std::cout << "Move from " << int(m.from) << " to " << int(m.to) << " with piece " << m.movedPieceSymbol << " capturing " << m.otherPieceSymbol << std::endl;
+                break;
+            case Move::Kind::Castling:
+                std::cout << "Castling move: King from " << int(m.from) << " to " << int(m.to) << " and Rook from " << m.rookFrom() << " to " << m.rookTo() << std::endl;
+                break;
+            case Move::Kind::EnPassant:
+                std::cout << "En Passant move: Pawn from " << int(m.from) << " to " << int(m.to) << " capturing at " << m.enPassantTarget() << std::endl;
+                break;
+            case Move::Kind::Promotion:
+                std::cout << "Promotion: Pawn from " << int(m.from) << " to " << int(m.to) << " becoming " << m.movedPieceSymbol << " capturing " << m.otherPieceSymbol << std::endl;
+                break;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    // Hot paths and worker threads, for Perfetto or chrome://tracing
+    bool tracing = Tracer::isEnabled();
+    if (ImGui::Checkbox("Trace", &tracing))
+    {
+        if (tracing)
+            Tracer::clear();
+        Tracer::setEnabled(tracing);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace"))
+    {
+        saveTrace();
+    }
+    if (!m_TraceStatus.empty())
+        ImGui::TextDisabled("%s", m_TraceStatus.c_str());
+
+#ifdef CHESS_PROFILING
+    Profiler::get().prepareGUI();
+#else
+    ImGui::TextDisabled("Performance overlay disabled (CHESS_PROFILING=OFF)");
+#endif
+
+    ImGui::End();
+}
+
+void Chess::Game::prepareIndexGUI()
+{
+    ImGui::TextColored(ImColor(255, 255, 128), "Position index:");
+    ImGui::InputText("Index", m_IndexBuffer.data(), m_IndexBuffer.size());
+    if (ImGui::Button("Open index"))
+    {
+        m_PositionIndex.open(m_IndexBuffer.c_str());
+        m_IndexKey = 0;
+    }
+
+    if (!m_PositionIndex.isOpen())
+    {
+        ImGui::TextDisabled("No index (build one with chess_index)");
+        return;
+    }
+
+    // Looked up once per position
+    std::uint64_t key = computeKey();
+    if (key != m_IndexKey)
+    {
+        auto start = std::chrono::steady_clock::now();
+        m_IndexOccurrences = m_PositionIndex.find(key).size();
+        m_IndexMoves = m_PositionIndex.moveStatistics(key);
+        m_IndexLookupMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        m_IndexKey = key;
+
+        auto position = toPosition();
+        m_IndexMoveNames.clear();
+        for (const auto &move : m_IndexMoves)
+            m_IndexMoveNames.push_back(position.toSan(move.move));
+    }
+
+    ImGui::Text("%zu occurrences in %llu games (%.0f us)", m_IndexOccurrences, static_cast<unsigned long long>(m_PositionIndex.gameCount()), m_IndexLookupMicros);
+
+    PackedMove toPlay;
+    for (std::size_t i = 0; i < m_IndexMoves.size(); i++)
+    {
+        const auto &move = m_IndexMoves[i];
+
+        ImGui::PushID(static_cast<int>(i));
+        if (ImGui::SmallButton("Play"))
+            toPlay = move.move;
+        ImGui::SameLine();
+        ImGui::Text("%-7s %8llu  %5.1f%% (+%llu =%llu -%llu)", m_IndexMoveNames[i].c_str(), static_cast<unsigned long long>(move.games), move.whiteScore() * 100.0,
+                    static_cast<unsigned long long>(move.whiteWins), static_cast<unsigned long long>(move.draws), static_cast<unsigned long long>(move.blackWins));
+        ImGui::PopID();
+    }
+
+    // After the loop that reads the statistics of this position; the board is locked while the computer is to move
+    if (!toPlay.isNone() && !m_ComputerPlays[m_CurrentTurn == Piece::Color::White ? 0 : 1])
+        applyEngineMove(toPlay);
+}
+
+void Chess::Game::prepareMoveListGUI()
+{
+    ImGui::TextColored(ImColor(255, 255, 128), "Moves:");
+
+    // Root to the current node, then on along the main line
+    m_DisplayedLine.clear();
+    for (auto node = m_CurrentNode; node != GameTree::ROOT; node = m_MovesHistory[node].parent)
+        m_DisplayedLine.push_back(node);
+    std::reverse(m_DisplayedLine.begin(), m_DisplayedLine.end());
+    for (auto node = m_MovesHistory[m_CurrentNode].firstChild; node != GameTree::NONE; node = m_MovesHistory[node].firstChild)
+        m_DisplayedLine.push_back(node);
+
+    GameTree::NodeIndex target = GameTree::NONE;
+    if (ImGui::Button("|<"))
+        target = GameTree::ROOT;
+    ImGui::SameLine();
+    if (ImGui::Button(">|") && !m_DisplayedLine.empty())
+        target = m_DisplayedLine.back();
+    ImGui::SameLine();
+    ImGui::TextDisabled("(arrows, Home, End)");
+
+    ImGui::BeginChild("MoveList", ImVec2(0, 120), true);
+    int blackFirst = m_InitialTurn == Piece::Color::Black ? 1 : 0;
+    for (std::size_t i = 0; i < m_DisplayedLine.size(); i++)
+    {
+        auto node = m_DisplayedLine[i];
+        const auto &move = m_MovesHistory[node].move;
+        bool white = (i + blackFirst) % 2 == 0;
+
+        if (white || i == 0)
+        {
+            ImGui::Text("%d.%s", m_InitialFullmoveNumber + static_cast<int>(i + blackFirst) / 2, white ? "" : "..");
+        }
+        ImGui::SameLine();
+
+        // Graded by the last review of this line
+        auto verdict = GameReview::Verdict::Pending;
+        if (i < m_ReviewNodes.size() && m_ReviewNodes[i] == node && i < m_ReviewResults.verdicts.size())
+            verdict = m_ReviewResults.verdicts[i];
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "%c %s-%s%s##%u", move.movedPieceSymbol, indexToFRString(move.from).c_str(), indexToFRString(move.to).c_str(),
+                      GameReview::annotation(verdict), node);
+
+        bool colored = verdict == GameReview::Verdict::Best || verdict >= GameReview::Verdict::Inaccuracy;
+        if (colored)
+            ImGui::PushStyleColor(ImGuiCol_Text, verdictColor(verdict));
+        if (ImGui::Selectable(label, node == m_CurrentNode, 0, ImVec2(70, 0)))
+            target = node;
+        if (colored)
+            ImGui::PopStyleColor();
+
+        // Follows the current move when it changes
+        if (node == m_CurrentNode && m_MoveListNode != m_CurrentNode)
+            ImGui::SetScrollHereY();
+    }
+    m_MoveListNode = m_CurrentNode;
+    ImGui::EndChild();
+
+    jumpTo(target);
+}
+
+void Chess::Game::prepareVariationsGUI()
+{
+    ImGui::TextColored(ImColor(255, 255, 128), "Variations:");
+
+    if (ImGui::Button("<"))
+    {
+        undoLastMove();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(">"))
+    {
+        redoMove(m_MovesHistory[m_CurrentNode].firstChild);
+    }
+    ImGui::SameLine();
+    ImGui::Text("Ply %d", m_MovesHistory[m_CurrentNode].ply);
+
+    // Continuations from the current position, main line first
+    GameTree::NodeIndex toPlay = GameTree::NONE, toPromote = GameTree::NONE, toRemove = GameTree::NONE;
+    bool mainLine = true;
+    for (auto child = m_MovesHistory[m_CurrentNode].firstChild; child != GameTree::NONE; child = m_MovesHistory[child].nextSibling)
+    {
+        const auto &move = m_MovesHistory[child].move;
+
+        ImGui::PushID(static_cast<int>(child));
+        if (ImGui::SmallButton("Play"))
+            toPlay = child;
+        ImGui::SameLine();
+        if (!mainLine && ImGui::SmallButton("Promote"))
+            toPromote = child;
+        if (!mainLine)
+            ImGui::SameLine();
+        if (ImGui::SmallButton("Delete"))
+            toRemove = child;
+        ImGui::SameLine();
+        ImGui::Text("%c %s-%s%s", move.movedPieceSymbol, indexToFRString(move.from).c_str(), indexToFRString(move.to).c_str(), mainLine ? " (main)" : "");
+        ImGui::PopID();
+
+        mainLine = false;
+    }
+
+    // Tree edits are applied after the loop that walks the sibling links
+    if (toPlay != GameTree::NONE)
+        redoMove(toPlay);
+    if (toPromote != GameTree::NONE)
+        m_MovesHistory.promote(toPromote);
+    if (toRemove != GameTree::NONE)
+    {
+        // Recycled nodes would pick up the verdicts of the reviewed moves they replace
+        if (std::any_of(m_ReviewNodes.begin(), m_ReviewNodes.end(), [&](GameTree::NodeIndex node)
+                        { return m_MovesHistory.commonAncestor(toRemove, node) == toRemove; }))
+            stopReview();
+        m_MovesHistory.remove(toRemove);
+    }
+
+    ImGui::Text("Nodes: %zu (%zu KiB)", m_MovesHistory.nodeCount(), m_MovesHistory.memoryUsage() / 1024);
+}
+
+void Chess::Game::draw(sf::RenderTarget &target, sf::RenderStates states) const
+{
+    CHESS_TRACE_SCOPE("Game::draw");
+    states.transform.translate(sf::Vector2f(m_GUIOffset, 0));
+
+    // Rendering Board
+    for (int i = 0; i < 64; i++)
+    {
+        int file = indexToFile(i);
+        int rank = indexToRank(i);
+
+        // Drawing tile
+        m_Tile.setPosition(sf::Vector2f(file * m_Tile.getSize().x, (7 - rank) * m_Tile.getSize().y));
+        m_Tile.setFillColor((file + rank) % 2 == 0 ? m_BlackColor : m_WhiteColor);
+        target.draw(m_Tile, states);
+
+        // Drawing piece
+        auto piece = m_Pieces[i];
+        if (piece != nullptr)
+        {
+            piece->setPosition(sf::Vector2f(file * m_Tile.getSize().x, (7 - rank) * m_Tile.getSize().y));
+            target.draw(*piece, states);
+        }
+    }
+
+    // Drawing overlays
+    if (m_ShowHanging)
+    {
+        for (auto hanging = m_HangingPieces; hanging;)
+        {
+            int square = Bitboards::popLsb(hanging);
+            m_HangingBox.setPosition(sf::Vector2f(indexToFile(square) * m_HangingBox.getSize().x, (7 - indexToRank(square)) * m_HangingBox.getSize().y));
+            target.draw(m_HangingBox, states);
+        }
+    }
+
+    // Best moves of the analysis, the best one last so it stays on top
+    if (m_Analyze && m_Analysis.key == m_AnalysisKey)
+    {
+        float tileSize = m_Tile.getSize().x;
+        for (std::size_t i = m_Analysis.lines.size(); i-- > 0;)
+        {
+            const auto &pv = m_Analysis.lines[i].pv;
+            if (pv.empty())
+                continue;
+
+            if (i == 0)
+                drawArrow(target, states, pv.front().from(), pv.front().to(), tileSize * 0.18f, sf::Color(0x30c030c0));
+            else
+                drawArrow(target, states, pv.front().from(), pv.front().to(), tileSize * 0.12f, sf::Color(0x4080ff90));
+        }
+    }
+
+    if (m_CurrentSelectedIndex != -1)
+    {
+        int file = indexToFile(m_CurrentSelectedIndex);
+        int rank = indexToRank(m_CurrentSelectedIndex);
 
         // Selected overlay
         m_SelectedBox.setPosition(sf::Vector2f(file * m_SelectedBox.getSize().x, (7 - rank) * m_SelectedBox.getSize().y));
@@ -473,3 +1910,31 @@ void Chess::Game::draw(sf::RenderTarget &target, sf::RenderStates states) const
         }
     }
 }
+
+void Chess::Game::drawArrow(sf::RenderTarget &target, sf::RenderStates states, int from, int to, float width, sf::Color color) const
+{
+    // Between the centers of the two squares
+    float tileSize = m_Tile.getSize().x;
+    float fromX = (indexToFile(from) + 0.5f) * tileSize, fromY = (7 - indexToRank(from) + 0.5f) * tileSize;
+    float toX = (indexToFile(to) + 0.5f) * tileSize, toY = (7 - indexToRank(to) + 0.5f) * tileSize;
+
+    float dx = toX - fromX, dy = toY - fromY;
+    float length = std::sqrt(dx * dx + dy * dy);
+    float headLength = std::min(width * 2.0f, length);
+    auto angle = sf::radians(std::atan2(dy, dx));
+
+    m_ArrowShaft.setSize(sf::Vector2f(length - headLength, width));
+    m_ArrowShaft.setOrigin(sf::Vector2f(0, width / 2));
+    m_ArrowShaft.setPosition(sf::Vector2f(fromX, fromY));
+    m_ArrowShaft.setRotation(angle);
+    m_ArrowShaft.setFillColor(color);
+    target.draw(m_ArrowShaft, states);
+
+    m_ArrowHead.setPoint(0, sf::Vector2f(0, -width));
+    m_ArrowHead.setPoint(1, sf::Vector2f(headLength, 0));
+    m_ArrowHead.setPoint(2, sf::Vector2f(0, width));
+    m_ArrowHead.setPosition(sf::Vector2f(fromX + dx / length * (length - headLength), fromY + dy / length * (length - headLength)));
+    m_ArrowHead.setRotation(angle);
+    m_ArrowHead.setFillColor(color);
+    target.draw(m_ArrowHead, states);
+}
@@ -6,11 +6,24 @@
 
 #include <vector>
 #include <array>
-#include <stack>
-#include <variant>
+#include <cstdint>
+#include <future>
 
 #include "Piece.h"
 #include "Move.h"
+#include "GameTree.h"
+#include "Zobrist.h"
+#include "Nnue.h"
+#include "Engine.h"
+#include "Analyzer.h"
+#include "GameReview.h"
+#include "MateSolver.h"
+#include "GameClock.h"
+#include "PositionIndex.h"
+#include "DiagramRenderer.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "AllocTracker.h"
 
 constexpr auto STANDARD_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
@@ -18,6 +31,9 @@ namespace Chess
 {
     class Game : public sf::Drawable
     {
+        // tools/Bench.cpp times the private hot paths directly
+        friend struct BenchmarkAccess;
+
     private:
         // Info
         std::array<Piece *, 64> m_Pieces;
@@ -27,11 +43,84 @@ namespace Chess
         int m_CurrentSelectedIndex;
 
         std::vector<int> m_PossibleMoves;
-        std::stack<std::variant<Move, CastlingMove, EnPassantMove>> m_MovesHistory;
+        GameTree m_MovesHistory;
+        GameTree::NodeIndex m_CurrentNode;
+        std::vector<GameTree::NodeIndex> m_DisplayedLine; // Root to the end of the main line through the current node
+        GameTree::NodeIndex m_MoveListNode;               // Current node the move list last scrolled to
+
+        // Captured and replaced pieces, reused rather than reallocated (with their sprites)
+        std::vector<Piece *> m_SparePieces;
+
+        // State of the position the history starts from (FEN)
+        std::string m_StartFen;
+        int m_InitialFullmoveNumber;
+        int m_InitialEnPassantSquare; // Square of the pawn that can be taken en passant, -1 if none
+        Piece::Color m_InitialTurn;
 
         unsigned int m_WhiteScore;
         unsigned int m_BlackScore;
 
+        // Evaluation (kept in sync by every register*/undo call)
+        Nnue::Accumulator m_Accumulator;
+        mutable std::string m_NetworkBuffer;
+
+        // Timed and computer play
+        GameClock m_Clock;
+        int m_BaseMinutes;
+        int m_IncrementSeconds;
+
+        Engine m_Engine;
+        std::array<bool, 2> m_ComputerPlays; // By side
+        bool m_Ponder;
+        std::uint64_t m_SearchKey; // Position the engine was started on (before the predicted move when pondering)
+        std::uint64_t m_PonderKey; // Position after the predicted move
+        SearchResult m_LastResult;
+        int m_HashMegabytes;
+
+        // Background analysis of the board position, restarted whenever it changes
+        Analyzer m_Analyzer;
+        bool m_Analyze;
+        int m_AnalysisLines;
+        std::uint64_t m_AnalysisKey;
+        Position m_AnalysisPosition;
+        Analyzer::Snapshot m_Analysis;
+        std::uint64_t m_AnalysisVersion;
+        std::vector<std::string> m_AnalysisText; // Score and moves (SAN) of each line
+
+        // Every move of the displayed line graded on the background threads
+        GameReview m_Review;
+        GameReview::Snapshot m_ReviewResults;
+        std::uint64_t m_ReviewVersion;
+        std::vector<GameTree::NodeIndex> m_ReviewNodes; // Node of each reviewed move
+
+        // Forced mate check of the board position, solved on a background thread
+        MateSolver m_MateSolver;
+        std::future<MateSolver::Result> m_MateFuture;
+        Position m_MatePosition;
+        std::uint64_t m_MateKey;
+        int m_MateMoves;
+        std::string m_MateText; // Verdict on m_MateKey, cleared when the board changes
+
+        // Archive lookups of the board position
+        PositionIndex m_PositionIndex;
+        mutable std::string m_IndexBuffer;
+        std::uint64_t m_IndexKey;
+        std::size_t m_IndexOccurrences;
+        double m_IndexLookupMicros;
+        std::vector<PositionIndex::MoveStatistics> m_IndexMoves;
+        std::vector<std::string> m_IndexMoveNames; // SAN of m_IndexMoves
+
+        // Diagram export of the board position (piece images read on first use)
+        DiagramRenderer m_Diagrams;
+
+        // Result of the last trace dump, shown under the trace controls
+        std::string m_TraceStatus;
+
+        // Pieces either side could win by capturing (SEE), for the board overlay
+        bool m_ShowHanging;
+        Bitboard m_HangingPieces;
+        std::uint64_t m_HangingKey;
+
         // Rendering
         sf::Color m_WhiteColor, m_BlackColor;
 
@@ -41,22 +130,44 @@ namespace Chess
         mutable sf::RectangleShape m_Tile;
         mutable sf::RectangleShape m_SelectedBox;
         mutable sf::RectangleShape m_PossibleMoveBox;
+        mutable sf::RectangleShape m_HangingBox;
+        mutable sf::RectangleShape m_ArrowShaft;
+        mutable sf::ConvexShape m_ArrowHead;
 
     public:
-        Game(sf::RenderWindow &window, sf::Color whiteColor = sf::Color(0xf1d7c0ff), sf::Color blackColor = sf::Color(0xa97a65ff));
+        Game(sf::RenderWindow &window, sf::Color whiteColor = sf::Color(0xf1d7c0ff), sf::Color blackColor = sf::Color(0xa97a65ff))
+            : Game(window.getSize(), whiteColor, blackColor)
+        {
+        }
+
+        // Laid out for a target of this size (control panel left of a square board)
+        Game(sf::Vector2u size, sf::Color whiteColor = sf::Color(0xf1d7c0ff), sf::Color blackColor = sf::Color(0xa97a65ff));
 
         ~Game()
         {
+            m_MateSolver.stop();
+            if (m_MateFuture.valid())
+                m_MateFuture.wait();
             for (auto piece : m_Pieces)
             {
                 delete piece;
             }
+            for (auto piece : m_SparePieces)
+            {
+                delete piece;
+            }
         }
 
         // Methods
 
         void handleClick(sf::Vector2i mousePos);
 
+        // History navigation: arrows step through the line, Home and End jump to its ends
+        void handleKey(sf::Keyboard::Key key);
+
+        // Once per frame: runs the clock and the computer player
+        void update();
+
         void prepareGUI();
 
         void resize(const sf::Vector2u newSize);
@@ -76,10 +187,91 @@ namespace Chess
         void registerMove(int from, int to);
         void registerCastlingMove(int kingFrom, int kingTo, int rookFrom, int rookTo);
         void registerEnPassantMove(int pawnFrom, int pawnTo, int capturedIndex);
+        void registerPromotionMove(int from, int to, char promotedSymbol);
         void undoLastMove();
+        void redoMove(GameTree::NodeIndex child);
+
+        // Any node of the tree, through undo/redo or the nearest checkpoint, whichever is shorter
+        void jumpTo(GameTree::NodeIndex node);
+        void storeCheckpoint();
+        void restoreCheckpoint(GameTree::NodeIndex node);
+
+        Piece *newPiece(char symbol);
+        void freePiece(int index);
+        void playMove(const Move &move);
+        void recordMove(Move move);
+
+        bool isPromotion(int from, int to) const
+        {
+            return m_Pieces[from] != nullptr && m_Pieces[from]->getType() == Piece::Type::Pawn && (indexToRank(to) == 0 || indexToRank(to) == 7);
+        }
+
+        // Computer play
+        std::string currentFen() const;
+        Position toPosition() const;
+        void applyEngineMove(PackedMove move);
+        void startThinking();
+        void startPondering();
+        SearchLimits clockLimits(int side) const;
+        void prepareClockGUI();
+
+        // Analysis
+        void startAnalysis();
+        void formatAnalysis();
+        void prepareAnalysisGUI();
+        void startReview();
+        void stopReview();
+        void prepareReviewGUI();
+        void startMateCheck();
+        void formatMateResult(const MateSolver::Result &result);
+        void prepareMateGUI();
+        void drawArrow(sf::RenderTarget &target, sf::RenderStates states, int from, int to, float width, sf::Color color) const;
+
+        // Evaluation
+        std::array<std::uint8_t, 64> boardCodes() const;
+        int kingSquare(Piece::Color color) const;
+        void refreshAccumulator();
+        void updateAccumulator(const Nnue::DirtyPieces &dirty);
+
+        // Position state
+        std::uint64_t computeKey() const;
+        int castlingRights() const;
+        int enPassantFile() const;
+
+        int halfmoveClock() const
+        {
+            return m_MovesHistory[m_CurrentNode].move.halfmoveClock;
+        }
+
+        int fullmoveNumber() const
+        {
+            int plies = m_MovesHistory[m_CurrentNode].ply + (m_InitialTurn == Piece::Color::Black ? 1 : 0);
+            return m_InitialFullmoveNumber + plies / 2;
+        }
+
+        // Draw detection
+        int repetitionCount() const;
+
+        bool isFiftyMoveDraw() const
+        {
+            return halfmoveClock() >= 100;
+        }
+
+        bool isThreefoldRepetition() const
+        {
+            return repetitionCount() >= 3;
+        }
+
+        void prepareMoveListGUI();
+        void prepareVariationsGUI();
+        void prepareIndexGUI();
+        void saveDiagram(const std::string &path, bool svg);
+        void saveTrace();
 
         void calculatePossibleMoves(int index);
 
+        bool isPathClear(int from, int to) const;
+
         void addMovesInDirection(int startFile, int startRank, int fileIncrement, int rankIncrement, Piece::Color pieceColor);
 
         void calculatePawnMoves(int index);
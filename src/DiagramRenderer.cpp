@@ -0,0 +1,514 @@
+#include "DiagramRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string_view>
+
+#ifdef CHESS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+    // Asset names by piece type
+    constexpr std::array<std::string_view, 7> TYPE_NAMES = {"", "pawn", "rook", "knight", "bishop", "queen", "king"};
+
+    constexpr std::string_view PNG_SIGNATURE = "\x89PNG\r\n\x1a\n";
+
+    bool readFile(const std::string &path, std::string &contents)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    std::string toBase64(std::string_view data)
+    {
+        constexpr std::string_view ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string encoded;
+        encoded.reserve((data.size() + 2) / 3 * 4);
+        for (std::size_t i = 0; i < data.size(); i += 3)
+        {
+            std::uint32_t group = static_cast<std::uint8_t>(data[i]) << 16;
+            if (i + 1 < data.size())
+                group |= static_cast<std::uint8_t>(data[i + 1]) << 8;
+            if (i + 2 < data.size())
+                group |= static_cast<std::uint8_t>(data[i + 2]);
+
+            encoded += ALPHABET[(group >> 18) & 63];
+            encoded += ALPHABET[(group >> 12) & 63];
+            encoded += i + 1 < data.size() ? ALPHABET[(group >> 6) & 63] : '=';
+            encoded += i + 2 < data.size() ? ALPHABET[group & 63] : '=';
+        }
+        return encoded;
+    }
+
+    // "#rrggbb" of an RGBA color
+    std::string hexColor(std::uint32_t color)
+    {
+        constexpr std::string_view DIGITS = "0123456789abcdef";
+
+        std::string hex = "#";
+        for (int shift = 28; shift >= 8; shift -= 4)
+            hex += DIGITS[(color >> shift) & 15];
+        return hex;
+    }
+
+    // Source pixels and weights of each destination pixel, for an area-averaging resize
+    struct Tap
+    {
+        int source;
+        float weight;
+    };
+
+    std::vector<std::vector<Tap>> resizeTaps(int from, int to)
+    {
+        std::vector<std::vector<Tap>> taps(to);
+        double scale = static_cast<double>(from) / to;
+        for (int d = 0; d < to; d++)
+        {
+            double begin = d * scale, end = (d + 1) * scale;
+            for (int s = static_cast<int>(begin); s < end && s < from; s++)
+            {
+                double covered = std::min(end, s + 1.0) - std::max(begin, static_cast<double>(s));
+                if (covered > 0.0)
+                    taps[d].push_back({s, static_cast<float>(covered / scale)});
+            }
+        }
+        return taps;
+    }
+
+#ifdef CHESS_HAVE_ZLIB
+    std::uint32_t readBigEndian(const std::string &data, std::size_t offset)
+    {
+        auto byte = [&](std::size_t i)
+        { return static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[offset + i])); };
+        return byte(0) << 24 | byte(1) << 16 | byte(2) << 8 | byte(3);
+    }
+
+    void appendBigEndian(std::vector<std::uint8_t> &out, std::uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+
+    // 8-bit, non-interlaced grayscale, RGB, and either with alpha (what image editors write)
+    bool decodePng(const std::string &file, int &width, int &height, std::vector<std::uint8_t> &rgba)
+    {
+        if (file.size() < 33 || std::string_view(file).substr(0, 8) != PNG_SIGNATURE)
+            return false;
+
+        int colorType = -1;
+        std::string compressed;
+        for (std::size_t offset = 8; offset + 12 <= file.size();)
+        {
+            std::uint32_t length = readBigEndian(file, offset);
+            std::string_view type(file.data() + offset + 4, 4);
+            if (offset + 12 + length > file.size())
+                return false;
+
+            if (type == "IHDR")
+            {
+                width = static_cast<int>(readBigEndian(file, offset + 8));
+                height = static_cast<int>(readBigEndian(file, offset + 12));
+                int bitDepth = static_cast<std::uint8_t>(file[offset + 16]);
+                colorType = static_cast<std::uint8_t>(file[offset + 17]);
+                int interlace = static_cast<std::uint8_t>(file[offset + 20]);
+                if (bitDepth != 8 || interlace != 0 || (colorType != 0 && colorType != 2 && colorType != 4 && colorType != 6) ||
+                    width <= 0 || height <= 0 || width > 8192 || height > 8192)
+                    return false;
+            }
+            else if (type == "IDAT")
+                compressed.append(file, offset + 8, length);
+            else if (type == "IEND")
+                break;
+            offset += 12 + length;
+        }
+        if (colorType == -1)
+            return false;
+
+        int channels = colorType == 0 ? 1 : colorType == 2 ? 3 : colorType == 4 ? 2 : 4;
+        std::size_t stride = static_cast<std::size_t>(width) * channels;
+        std::vector<std::uint8_t> raw(height * (stride + 1));
+        uLongf rawSize = raw.size();
+        if (uncompress(raw.data(), &rawSize, reinterpret_cast<const Bytef *>(compressed.data()), compressed.size()) != Z_OK || rawSize != raw.size())
+            return false;
+
+        // Unfiltering in place, each row against the one above it
+        for (int y = 0; y < height; y++)
+        {
+            std::uint8_t *row = raw.data() + y * (stride + 1) + 1;
+            const std::uint8_t *above = y > 0 ? row - (stride + 1) : nullptr;
+            int filter = row[-1];
+            for (std::size_t x = 0; x < stride; x++)
+            {
+                int left = x >= static_cast<std::size_t>(channels) ? row[x - channels] : 0;
+                int up = above != nullptr ? above[x] : 0;
+                int upLeft = above != nullptr && x >= static_cast<std::size_t>(channels) ? above[x - channels] : 0;
+                switch (filter)
+                {
+                case 0:
+                    break;
+                case 1:
+                    row[x] += left;
+                    break;
+                case 2:
+                    row[x] += up;
+                    break;
+                case 3:
+                    row[x] += (left + up) / 2;
+                    break;
+                case 4:
+                {
+                    int estimate = left + up - upLeft;
+                    int distanceLeft = std::abs(estimate - left), distanceUp = std::abs(estimate - up), distanceUpLeft = std::abs(estimate - upLeft);
+                    row[x] += distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft ? left : distanceUp <= distanceUpLeft ? up : upLeft;
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+        }
+
+        rgba.resize(static_cast<std::size_t>(width) * height * 4);
+        for (int y = 0; y < height; y++)
+        {
+            const std::uint8_t *row = raw.data() + y * (stride + 1) + 1;
+            for (int x = 0; x < width; x++)
+            {
+                const std::uint8_t *in = row + x * channels;
+                std::uint8_t *out = rgba.data() + (static_cast<std::size_t>(y) * width + x) * 4;
+                bool gray = channels <= 2;
+                out[0] = in[0];
+                out[1] = gray ? in[0] : in[1];
+                out[2] = gray ? in[0] : in[2];
+                out[3] = channels == 2 ? in[1] : channels == 4 ? in[3] : 255;
+            }
+        }
+        return true;
+    }
+#endif
+}
+
+bool Chess::DiagramRenderer::load(const std::string &directory)
+{
+    m_Loaded = false;
+    m_Decoded = false;
+    {
+        std::unique_lock lock(m_CacheMutex);
+        m_Scaled.clear();
+    }
+
+    bool decoded = true;
+    for (int color = 0; color < 2; color++)
+    {
+        for (int type = 1; type <= 6; type++)
+        {
+            int code = color << 3 | type;
+            auto path = directory + "/" + (color == 0 ? "white_" : "black_") + std::string(TYPE_NAMES[type]) + ".png";
+
+            std::string file;
+            if (!readFile(path, file))
+            {
+                std::cerr << "Could not read " << path << std::endl;
+                return false;
+            }
+            m_Base64[code] = toBase64(file);
+
+#ifdef CHESS_HAVE_ZLIB
+            auto &image = m_Images[code];
+            if (!decodePng(file, image.width, image.height, image.pixels))
+            {
+                std::cerr << "Unsupported PNG " << path << " (8-bit, non-interlaced, no palette)" << std::endl;
+                decoded = false;
+            }
+#else
+            decoded = false;
+#endif
+        }
+    }
+
+    m_Loaded = true;
+    m_Decoded = decoded;
+    return true;
+}
+
+std::string Chess::DiagramRenderer::renderSvg(const std::array<std::uint8_t, 64> &board, const Options &options) const
+{
+    // One unit per square; only the images of pieces on the board are embedded
+    std::string size = std::to_string(tileSize(options) * 8);
+    std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"" + size +
+                      "\" height=\"" + size + "\" viewBox=\"0 0 8 8\">\n";
+
+    std::string dark, highlights, pieces;
+    std::uint32_t present = 0;
+    for (int row = 0; row < 8; row++)
+    {
+        for (int column = 0; column < 8; column++)
+        {
+            int file = options.flipped ? 7 - column : column;
+            int rank = options.flipped ? row : 7 - row;
+            int square = rank * 8 + file;
+            std::string at = std::to_string(column) + "," + std::to_string(row);
+
+            if ((file + rank) % 2 == 0)
+                dark += "M" + at + "h1v1h-1z";
+            if (options.highlights & Bitboards::squareBit(square))
+                highlights += "M" + at + "h1v1h-1z";
+
+            int code = board[square];
+            if (code != 0 && !m_Base64[code & 15].empty())
+            {
+                present |= 1u << (code & 15);
+                pieces += "<use xlink:href=\"#p" + std::to_string(code & 15) + "\" x=\"" + std::to_string(column) + "\" y=\"" + std::to_string(row) + "\"/>\n";
+            }
+        }
+    }
+
+    svg += "<defs>\n";
+    for (int code = 0; code < 16; code++)
+    {
+        if (present & (1u << code))
+            svg += "<image id=\"p" + std::to_string(code) + "\" width=\"1\" height=\"1\" xlink:href=\"data:image/png;base64," + m_Base64[code] + "\"/>\n";
+    }
+    svg += "</defs>\n";
+
+    svg += "<rect width=\"8\" height=\"8\" fill=\"" + hexColor(m_Light) + "\"/>\n";
+    svg += "<path fill=\"" + hexColor(m_Dark) + "\" d=\"" + dark + "\"/>\n";
+    if (!highlights.empty())
+    {
+        char opacity[16];
+        std::snprintf(opacity, sizeof(opacity), "%.3f", (m_Highlight & 0xff) / 255.0);
+        svg += "<path fill=\"" + hexColor(m_Highlight) + "\" fill-opacity=\"" + opacity + "\" d=\"" + highlights + "\"/>\n";
+    }
+    svg += pieces;
+    svg += "</svg>\n";
+    return svg;
+}
+
+bool Chess::DiagramRenderer::renderPixels(const std::array<std::uint8_t, 64> &board, const Options &options, std::vector<std::uint8_t> &rgb) const
+{
+    if (!m_Decoded)
+        return false;
+
+    int tile = tileSize(options), size = tile * 8;
+    auto pieces = scaledPieces(tile);
+    rgb.resize(static_cast<std::size_t>(size) * size * 3);
+
+    // Light, dark, then both highlighted
+    std::array<std::array<std::uint8_t, 3>, 4> colors;
+    for (int i = 0; i < 4; i++)
+    {
+        std::uint32_t base = i % 2 == 0 ? m_Light : m_Dark;
+        int alpha = i >= 2 ? m_Highlight & 0xff : 0;
+        for (int channel = 0; channel < 3; channel++)
+        {
+            int shift = 24 - 8 * channel;
+            int under = (base >> shift) & 0xff, over = (m_Highlight >> shift) & 0xff;
+            colors[i][channel] = static_cast<std::uint8_t>((over * alpha + under * (255 - alpha) + 127) / 255);
+        }
+    }
+
+    std::size_t stride = static_cast<std::size_t>(size) * 3;
+    for (int row = 0; row < 8; row++)
+    {
+        int rank = options.flipped ? row : 7 - row;
+        std::uint8_t *top = rgb.data() + static_cast<std::size_t>(row) * tile * stride;
+
+        // One pixel row of squares, copied down the rank
+        for (int column = 0; column < 8; column++)
+        {
+            int file = options.flipped ? 7 - column : column;
+            int square = rank * 8 + file;
+            const auto &color = colors[((file + rank) % 2 == 0 ? 1 : 0) + (options.highlights & Bitboards::squareBit(square) ? 2 : 0)];
+            for (int x = 0; x < tile; x++)
+                std::memcpy(top + (column * tile + x) * 3, color.data(), 3);
+        }
+        for (int y = 1; y < tile; y++)
+            std::memcpy(top + y * stride, top, stride);
+
+        for (int column = 0; column < 8; column++)
+        {
+            int file = options.flipped ? 7 - column : column;
+            const auto &piece = pieces->pieces[board[rank * 8 + file] & 15];
+            if (piece.empty())
+                continue;
+
+            // Source over, the piece premultiplied and the board opaque
+            for (int y = 0; y < tile; y++)
+            {
+                const std::uint8_t *in = piece.data() + static_cast<std::size_t>(y) * tile * 4;
+                std::uint8_t *out = top + y * stride + static_cast<std::size_t>(column) * tile * 3;
+                for (int x = 0; x < tile; x++, in += 4, out += 3)
+                {
+                    int transparency = 255 - in[3];
+                    if (transparency == 255)
+                        continue;
+                    for (int channel = 0; channel < 3; channel++)
+                        out[channel] = static_cast<std::uint8_t>(in[channel] + (out[channel] * transparency + 127) / 255);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool Chess::DiagramRenderer::renderPng(const std::array<std::uint8_t, 64> &board, const Options &options, std::vector<std::uint8_t> &png) const
+{
+    thread_local std::vector<std::uint8_t> rgb;
+    if (!renderPixels(board, options, rgb))
+        return false;
+
+    int size = tileSize(options) * 8;
+    return encodePng(rgb.data(), size, size, png);
+}
+
+bool Chess::DiagramRenderer::encodePng(const std::uint8_t *rgb, int width, int height, std::vector<std::uint8_t> &png)
+{
+#ifdef CHESS_HAVE_ZLIB
+    // Every row filtered against the one above: flat squares become runs of zeros
+    std::size_t stride = static_cast<std::size_t>(width) * 3;
+    thread_local std::vector<std::uint8_t> filtered;
+    filtered.resize(height * (stride + 1));
+    for (int y = 0; y < height; y++)
+    {
+        std::uint8_t *out = filtered.data() + y * (stride + 1);
+        const std::uint8_t *row = rgb + y * stride;
+        out[0] = 2;
+        if (y == 0)
+            std::memcpy(out + 1, row, stride);
+        else
+        {
+            for (std::size_t x = 0; x < stride; x++)
+                out[x + 1] = static_cast<std::uint8_t>(row[x] - row[x - stride]);
+        }
+    }
+
+    png.assign(PNG_SIGNATURE.begin(), PNG_SIGNATURE.end());
+    auto chunk = [&png](const char *type, const std::uint8_t *data, std::size_t length)
+    {
+        appendBigEndian(png, static_cast<std::uint32_t>(length));
+        std::size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data, data + length);
+        appendBigEndian(png, static_cast<std::uint32_t>(crc32(0, png.data() + start, static_cast<uInt>(length + 4))));
+    };
+
+    std::uint8_t header[13] = {};
+    for (int i = 0; i < 4; i++)
+    {
+        header[i] = static_cast<std::uint8_t>(width >> (24 - 8 * i));
+        header[4 + i] = static_cast<std::uint8_t>(height >> (24 - 8 * i));
+    }
+    header[8] = 8; // Bit depth
+    header[9] = 2; // RGB
+    chunk("IHDR", header, sizeof(header));
+
+    // Fastest level: higher ones take over twice as long for files a few percent smaller
+    z_stream stream{};
+    if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK)
+        return false;
+
+    thread_local std::vector<std::uint8_t> compressed;
+    compressed.resize(deflateBound(&stream, filtered.size()));
+    stream.next_in = filtered.data();
+    stream.avail_in = static_cast<uInt>(filtered.size());
+    stream.next_out = compressed.data();
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    bool finished = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+    std::size_t compressedSize = stream.total_out;
+    deflateEnd(&stream);
+    if (!finished)
+        return false;
+
+    chunk("IDAT", compressed.data(), compressedSize);
+    chunk("IEND", nullptr, 0);
+    return true;
+#else
+    (void)rgb;
+    (void)width;
+    (void)height;
+    (void)png;
+    return false;
+#endif
+}
+
+std::shared_ptr<const Chess::DiagramRenderer::PieceSet> Chess::DiagramRenderer::scaledPieces(int tileSize) const
+{
+    {
+        std::shared_lock lock(m_CacheMutex);
+        auto it = m_Scaled.find(tileSize);
+        if (it != m_Scaled.end())
+            return it->second;
+    }
+
+    // Scaled outside the lock: two threads may both scale a new size, and one copy is kept
+    auto set = std::make_shared<PieceSet>();
+    set->tileSize = tileSize;
+    for (int code = 0; code < 16; code++)
+    {
+        const auto &image = m_Images[code];
+        if (image.pixels.empty())
+            continue;
+
+        // Premultiplied, then averaged along rows and along columns
+        auto columns = resizeTaps(image.width, tileSize), rows = resizeTaps(image.height, tileSize);
+        std::vector<float> source(image.pixels.size()), horizontal(static_cast<std::size_t>(tileSize) * image.height * 4);
+        for (std::size_t i = 0; i < image.pixels.size(); i += 4)
+        {
+            float alpha = image.pixels[i + 3] / 255.0f;
+            source[i] = image.pixels[i] * alpha;
+            source[i + 1] = image.pixels[i + 1] * alpha;
+            source[i + 2] = image.pixels[i + 2] * alpha;
+            source[i + 3] = image.pixels[i + 3];
+        }
+
+        for (int y = 0; y < image.height; y++)
+        {
+            for (int x = 0; x < tileSize; x++)
+            {
+                float *out = horizontal.data() + (static_cast<std::size_t>(y) * tileSize + x) * 4;
+                for (const auto &tap : columns[x])
+                {
+                    const float *in = source.data() + (static_cast<std::size_t>(y) * image.width + tap.source) * 4;
+                    for (int channel = 0; channel < 4; channel++)
+                        out[channel] += in[channel] * tap.weight;
+                }
+            }
+        }
+
+        auto &piece = set->pieces[code];
+        piece.resize(static_cast<std::size_t>(tileSize) * tileSize * 4);
+        for (int y = 0; y < tileSize; y++)
+        {
+            for (int x = 0; x < tileSize; x++)
+            {
+                float sum[4] = {};
+                for (const auto &tap : rows[y])
+                {
+                    const float *in = horizontal.data() + (static_cast<std::size_t>(tap.source) * tileSize + x) * 4;
+                    for (int channel = 0; channel < 4; channel++)
+                        sum[channel] += in[channel] * tap.weight;
+                }
+
+                std::uint8_t *out = piece.data() + (static_cast<std::size_t>(y) * tileSize + x) * 4;
+                out[3] = static_cast<std::uint8_t>(std::clamp(std::lround(sum[3]), 0l, 255l));
+                for (int channel = 0; channel < 3; channel++)
+                    out[channel] = static_cast<std::uint8_t>(std::clamp(std::lround(sum[channel]), 0l, static_cast<long>(out[3])));
+            }
+        }
+    }
+
+    std::unique_lock lock(m_CacheMutex);
+    return m_Scaled.try_emplace(tileSize, std::move(set)).first->second;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Bitboard.h"
+
+namespace Chess
+{
+    // Board diagrams composed on the CPU from the piece images in assets/, for exporting
+    // positions without a window or a GPU. SVG output embeds the images as they are; PNG
+    // output decodes them once (which needs zlib, CHESS_HAVE_ZLIB) and keeps a copy scaled
+    // to every tile size asked for. Render methods may be called from several threads.
+    class DiagramRenderer
+    {
+    public:
+        struct Options
+        {
+            int size = 400;          // Pixels per side, rounded down to a multiple of 8
+            bool flipped = false;    // Black at the bottom
+            Bitboard highlights = 0; // Squares tinted like the possible moves on the board
+        };
+
+        // RGBA, as sf::Color(0xrrggbbaa) in Game
+        static constexpr std::uint32_t DEFAULT_LIGHT = 0xf1d7c0ff;
+        static constexpr std::uint32_t DEFAULT_DARK = 0xa97a65ff;
+        static constexpr std::uint32_t DEFAULT_HIGHLIGHT = 0x00ff0055;
+
+    private:
+        // Straight RGBA
+        struct Image
+        {
+            int width = 0;
+            int height = 0;
+            std::vector<std::uint8_t> pixels;
+        };
+
+        // Premultiplied RGBA tiles by piece code
+        struct PieceSet
+        {
+            int tileSize = 0;
+            std::array<std::vector<std::uint8_t>, 16> pieces;
+        };
+
+        std::array<std::string, 16> m_Base64; // Image files, by piece code
+        std::array<Image, 16> m_Images;
+        bool m_Loaded = false;
+        bool m_Decoded = false;
+
+        std::uint32_t m_Light = DEFAULT_LIGHT;
+        std::uint32_t m_Dark = DEFAULT_DARK;
+        std::uint32_t m_Highlight = DEFAULT_HIGHLIGHT;
+
+        mutable std::shared_mutex m_CacheMutex;
+        mutable std::unordered_map<int, std::shared_ptr<const PieceSet>> m_Scaled;
+
+    public:
+        // Reads <white|black>_<type>.png from directory; false (with a message on std::cerr)
+        // if one is missing. Not while rendering.
+        bool load(const std::string &directory = "assets");
+
+        bool isLoaded() const
+        {
+            return m_Loaded;
+        }
+
+        bool canRenderPng() const
+        {
+            return m_Decoded;
+        }
+
+        // Not while rendering
+        void setColors(std::uint32_t light, std::uint32_t dark, std::uint32_t highlight = DEFAULT_HIGHLIGHT)
+        {
+            m_Light = light;
+            m_Dark = dark;
+            m_Highlight = highlight;
+        }
+
+        // board holds piece codes by square, as Position::board()
+        std::string renderSvg(const std::array<std::uint8_t, 64> &board, const Options &options) const;
+
+        // RGB rows, top to bottom; false if the images aren't decoded
+        bool renderPixels(const std::array<std::uint8_t, 64> &board, const Options &options, std::vector<std::uint8_t> &rgb) const;
+        bool renderPng(const std::array<std::uint8_t, 64> &board, const Options &options, std::vector<std::uint8_t> &png) const;
+
+        // 8-bit RGB PNG; false if zlib isn't built in
+        static bool encodePng(const std::uint8_t *rgb, int width, int height, std::vector<std::uint8_t> &png);
+
+        static int tileSize(const Options &options)
+        {
+            return options.size < 8 ? 1 : options.size / 8;
+        }
+
+    private:
+        std::shared_ptr<const PieceSet> scaledPieces(int tileSize) const;
+    };
+}
@@ -0,0 +1,77 @@
+#include "Elo.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Expected score for an Elo difference
+    double expectedScore(double elo)
+    {
+        return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+    }
+
+    double scoreToElo(double score)
+    {
+        score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+        return -400.0 * std::log10(1.0 / score - 1.0);
+    }
+
+    // Mean score per game and its per-game variance
+    void scoreStatistics(const Chess::MatchScore &score, double &mean, double &variance)
+    {
+        double games = score.games();
+        double wins = score.wins / games;
+        double draws = score.draws / games;
+        double losses = score.losses / games;
+
+        mean = wins + draws / 2.0;
+        variance = wins * (1.0 - mean) * (1.0 - mean) + draws * (0.5 - mean) * (0.5 - mean) + losses * mean * mean;
+    }
+}
+
+double Chess::eloDifference(const MatchScore &score)
+{
+    if (score.games() == 0)
+        return 0.0;
+
+    double mean, variance;
+    scoreStatistics(score, mean, variance);
+    return scoreToElo(mean);
+}
+
+double Chess::eloMargin(const MatchScore &score)
+{
+    if (score.games() == 0)
+        return 0.0;
+
+    double mean, variance;
+    scoreStatistics(score, mean, variance);
+
+    double deviation = 1.959964 * std::sqrt(variance / score.games());
+    return (scoreToElo(mean + deviation) - scoreToElo(mean - deviation)) / 2.0;
+}
+
+double Chess::Sprt::llr(const MatchScore &score) const
+{
+    if (score.wins == 0 || score.losses == 0)
+        return 0.0; // Variance estimate is meaningless this early
+
+    double mean, variance;
+    scoreStatistics(score, mean, variance);
+    if (variance <= 0.0)
+        return 0.0;
+
+    double s0 = expectedScore(elo0);
+    double s1 = expectedScore(elo1);
+    return score.games() * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+}
+
+Chess::Sprt::Decision Chess::Sprt::decide(const MatchScore &score) const
+{
+    double ratio = llr(score);
+    if (ratio >= upperBound())
+        return Decision::AcceptH1;
+    if (ratio <= lowerBound())
+        return Decision::AcceptH0;
+    return Decision::Continue;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+
+namespace Chess
+{
+    // Game outcomes from the first player's point of view
+    struct MatchScore
+    {
+        int wins = 0;
+        int draws = 0;
+        int losses = 0;
+
+        int games() const
+        {
+            return wins + draws + losses;
+        }
+    };
+
+    // Logistic Elo difference and its 95% confidence margin (both 0 without games)
+    double eloDifference(const MatchScore &score);
+    double eloMargin(const MatchScore &score);
+
+    // Sequential probability ratio test of H0: elo = elo0 against H1: elo = elo1,
+    // using the normal approximation of the trinomial (win/draw/loss) log-likelihood ratio
+    struct Sprt
+    {
+        double elo0 = 0.0;
+        double elo1 = 5.0;
+        double alpha = 0.05;
+        double beta = 0.05;
+
+        enum class Decision
+        {
+            Continue,
+            AcceptH0,
+            AcceptH1,
+        };
+
+        double lowerBound() const
+        {
+            return std::log(beta / (1.0 - alpha));
+        }
+
+        double upperBound() const
+        {
+            return std::log((1.0 - beta) / alpha);
+        }
+
+        double llr(const MatchScore &score) const;
+        Decision decide(const MatchScore &score) const;
+    };
+}
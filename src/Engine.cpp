@@ -0,0 +1,70 @@
+#include "Engine.h"
+#include "Tracer.h"
+
+Chess::Engine::Engine()
+{
+    resizeTable(DEFAULT_HASH_MB);
+}
+
+void Chess::Engine::start(const Position &position, const SearchLimits &limits, const Nnue::Network *network)
+{
+    stop();
+
+    m_Position = position;
+    m_Pondering = limits.ponder;
+    m_Finished = false;
+    m_Search.setNetwork(network);
+
+    m_Thread = std::thread([this, limits]
+                           {
+                               Tracer::setThreadName("Engine");
+                               CHESS_TRACE_SCOPE(limits.ponder ? "Engine ponder" : "Engine search");
+                               m_Result = m_Search.run(m_Position, limits);
+                               m_Finished.store(true, std::memory_order_release); });
+}
+
+void Chess::Engine::stop()
+{
+    if (!m_Thread.joinable())
+        return;
+
+    m_Search.stop();
+    m_Thread.join();
+    m_Search.resetSignals();
+    m_Finished = false;
+}
+
+bool Chess::Engine::resizeTable(std::size_t megabytes)
+{
+    stop();
+
+    bool resized = m_Table.resize(megabytes);
+    m_Search.setTranspositionTable(resized ? &m_Table : nullptr);
+    return resized;
+}
+
+void Chess::Engine::clearTable()
+{
+    stop();
+    m_Table.clear();
+}
+
+void Chess::Engine::ponderHit()
+{
+    if (!isPondering())
+        return;
+
+    m_Search.ponderHit();
+    m_Pondering = false;
+}
+
+bool Chess::Engine::poll(SearchResult &result)
+{
+    if (!m_Thread.joinable() || !m_Finished.load(std::memory_order_acquire))
+        return false;
+
+    m_Thread.join();
+    m_Finished = false;
+    result = std::move(m_Result);
+    return true;
+}
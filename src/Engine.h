@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "Nnue.h"
+#include "Position.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+namespace Chess
+{
+    // Runs one Search at a time on a background thread, for callers (the GUI) that must keep
+    // going while the engine thinks. All methods are for the owning thread only.
+    class Engine
+    {
+    public:
+        static constexpr std::size_t DEFAULT_HASH_MB = 64;
+
+    private:
+        TranspositionTable m_Table; // Kept from one search to the next
+        Search m_Search;
+        Position m_Position; // Searched in place by the background thread
+
+        std::thread m_Thread;
+        std::atomic<bool> m_Finished = false;
+        bool m_Pondering = false;
+
+        SearchResult m_Result;
+
+    public:
+        Engine();
+
+        ~Engine()
+        {
+            stop();
+        }
+
+        Engine(const Engine &) = delete;
+        Engine &operator=(const Engine &) = delete;
+
+        // Stops any running search first
+        void start(const Position &position, const SearchLimits &limits, const Nnue::Network *network);
+
+        // Interrupts and joins the running search, dropping its result
+        void stop();
+
+        // The predicted move was played: the ponder search continues as a normal one
+        void ponderHit();
+
+        // Both stop any running search first; false if the new table can't be allocated
+        bool resizeTable(std::size_t megabytes);
+        void clearTable();
+
+        const TranspositionTable &table() const
+        {
+            return m_Table;
+        }
+
+        // Hit counters are live while searching
+        const PawnTable &pawnTable() const
+        {
+            return m_Search.pawnTable();
+        }
+
+        bool isSearching() const
+        {
+            return m_Thread.joinable();
+        }
+
+        bool isPondering() const
+        {
+            return isSearching() && m_Pondering;
+        }
+
+        // Root of the running (or last) search
+        const Position &position() const
+        {
+            return m_Position;
+        }
+
+        // True once, when a search has finished; result receives its outcome
+        bool poll(SearchResult &result);
+    };
+}
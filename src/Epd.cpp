@@ -0,0 +1,107 @@
+#include "Epd.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    bool isSpace(char symbol)
+    {
+        return std::isspace(static_cast<unsigned char>(symbol)) != 0;
+    }
+
+    void skipSpaces(std::string_view &text)
+    {
+        while (!text.empty() && isSpace(text.front()))
+            text.remove_prefix(1);
+    }
+
+    std::string_view nextWord(std::string_view &text)
+    {
+        skipSpaces(text);
+        auto end = std::find_if(text.begin(), text.end(), [](char symbol)
+                                { return isSpace(symbol) || symbol == ';'; });
+        auto word = text.substr(0, static_cast<std::size_t>(end - text.begin()));
+        text.remove_prefix(word.size());
+        return word;
+    }
+}
+
+const Chess::EpdOperation *Chess::EpdRecord::operation(std::string_view opcode) const
+{
+    auto match = std::find_if(operations.begin(), operations.end(), [opcode](const EpdOperation &operation)
+                              { return operation.opcode == opcode; });
+    return match != operations.end() ? &*match : nullptr;
+}
+
+std::string Chess::EpdRecord::id() const
+{
+    auto id = operation("id");
+    return id != nullptr && !id->operands.empty() ? id->operands.front() : std::string();
+}
+
+bool Chess::readEpd(std::string_view line, EpdRecord &record)
+{
+    record = {};
+
+    std::string fields;
+    for (int i = 0; i < 4; i++)
+    {
+        auto field = nextWord(line);
+        if (field.empty())
+            return false;
+        fields += std::string(field) + (i < 3 ? " " : "");
+    }
+
+    while (true)
+    {
+        auto opcode = nextWord(line);
+        if (opcode.empty())
+        {
+            // Stray ';' between operations
+            skipSpaces(line);
+            if (line.empty())
+                break;
+            if (line.front() != ';')
+                return false;
+            line.remove_prefix(1);
+            continue;
+        }
+
+        EpdOperation operation;
+        operation.opcode = opcode;
+        while (true)
+        {
+            skipSpaces(line);
+            if (line.empty() || line.front() == ';')
+                break;
+
+            if (line.front() == '"')
+            {
+                // A quoted operand may hold spaces and semicolons
+                auto close = line.find('"', 1);
+                if (close == std::string_view::npos)
+                    return false;
+                operation.operands.emplace_back(line.substr(1, close - 1));
+                line.remove_prefix(close + 1);
+            }
+            else
+            {
+                operation.operands.emplace_back(nextWord(line));
+            }
+        }
+        if (!line.empty())
+            line.remove_prefix(1);
+
+        record.operations.push_back(std::move(operation));
+    }
+
+    // Clocks as a FEN would have them
+    auto clock = [&record](std::string_view opcode, const char *fallback)
+    {
+        auto operation = record.operation(opcode);
+        return operation != nullptr && !operation->operands.empty() ? operation->operands.front() : std::string(fallback);
+    };
+    record.fen = fields + " " + clock("hmvc", "0") + " " + clock("fmvn", "1");
+    return true;
+}
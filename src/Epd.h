@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Chess
+{
+    // One EPD operation: "bm Nf3 e4;" is opcode bm with operands Nf3 and e4
+    struct EpdOperation
+    {
+        std::string opcode;
+        std::vector<std::string> operands; // Quoted strings without their quotes
+    };
+
+    struct EpdRecord
+    {
+        std::string fen; // The four position fields, with the clocks of hmvc and fmvn (or 0 1)
+        std::vector<EpdOperation> operations;
+
+        // First operation with this opcode, nullptr if there is none
+        const EpdOperation *operation(std::string_view opcode) const;
+
+        // First operand of id, empty if there is none
+        std::string id() const;
+    };
+
+    // Reads one EPD line: the board, side to move, castling and en passant fields, then
+    // operations ending in ';' (the last one may leave it out). Only the syntax is checked:
+    // the position and the moves in operands are for the caller to validate.
+    bool readEpd(std::string_view line, EpdRecord &record);
+}
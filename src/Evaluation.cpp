@@ -0,0 +1,225 @@
+#include "Evaluation.h"
+
+namespace
+{
+    using Table = std::array<int, 64>;
+
+    // Piece-square tables from White's point of view, a1 first
+    constexpr Table PAWN_TABLE = {
+        0, 0, 0, 0, 0, 0, 0, 0,
+        5, 10, 10, -20, -20, 10, 10, 5,
+        5, -5, -10, 0, 0, -10, -5, 5,
+        0, 0, 0, 20, 20, 0, 0, 0,
+        5, 5, 10, 25, 25, 10, 5, 5,
+        10, 10, 20, 30, 30, 20, 10, 10,
+        50, 50, 50, 50, 50, 50, 50, 50,
+        0, 0, 0, 0, 0, 0, 0, 0};
+
+    constexpr Table KNIGHT_TABLE = {
+        -50, -40, -30, -30, -30, -30, -40, -50,
+        -40, -20, 0, 5, 5, 0, -20, -40,
+        -30, 5, 10, 15, 15, 10, 5, -30,
+        -30, 0, 15, 20, 20, 15, 0, -30,
+        -30, 5, 15, 20, 20, 15, 5, -30,
+        -30, 0, 10, 15, 15, 10, 0, -30,
+        -40, -20, 0, 0, 0, 0, -20, -40,
+        -50, -40, -30, -30, -30, -30, -40, -50};
+
+    constexpr Table BISHOP_TABLE = {
+        -20, -10, -10, -10, -10, -10, -10, -20,
+        -10, 5, 0, 0, 0, 0, 5, -10,
+        -10, 10, 10, 10, 10, 10, 10, -10,
+        -10, 0, 10, 10, 10, 10, 0, -10,
+        -10, 5, 5, 10, 10, 5, 5, -10,
+        -10, 0, 5, 10, 10, 5, 0, -10,
+        -10, 0, 0, 0, 0, 0, 0, -10,
+        -20, -10, -10, -10, -10, -10, -10, -20};
+
+    constexpr Table ROOK_TABLE = {
+        0, 0, 0, 5, 5, 0, 0, 0,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        -5, 0, 0, 0, 0, 0, 0, -5,
+        5, 10, 10, 10, 10, 10, 10, 5,
+        0, 0, 0, 0, 0, 0, 0, 0};
+
+    constexpr Table QUEEN_TABLE = {
+        -20, -10, -10, -5, -5, -10, -10, -20,
+        -10, 0, 5, 0, 0, 0, 0, -10,
+        -10, 5, 5, 5, 5, 5, 0, -10,
+        0, 0, 5, 5, 5, 5, 0, -5,
+        -5, 0, 5, 5, 5, 5, 0, -5,
+        -10, 0, 5, 5, 5, 5, 0, -10,
+        -10, 0, 0, 0, 0, 0, 0, -10,
+        -20, -10, -10, -5, -5, -10, -10, -20};
+
+    // Middlegame king: stay behind the pawns
+    constexpr Table KING_TABLE = {
+        20, 30, 10, 0, 0, 10, 30, 20,
+        20, 20, 0, 0, 0, 0, 20, 20,
+        -10, -20, -20, -20, -20, -20, -20, -10,
+        -20, -30, -30, -40, -40, -30, -30, -20,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30};
+
+    // Endgame king: head for the centre
+    constexpr Table KING_ENDGAME_TABLE = {
+        -50, -30, -30, -30, -30, -30, -30, -50,
+        -30, -30, 0, 0, 0, 0, -30, -30,
+        -30, -10, 20, 30, 30, 20, -10, -30,
+        -30, -10, 30, 40, 40, 30, -10, -30,
+        -30, -10, 30, 40, 40, 30, -10, -30,
+        -30, -10, 20, 30, 30, 20, -10, -30,
+        -30, -20, -10, 0, 0, -10, -20, -30,
+        -50, -40, -30, -20, -20, -30, -40, -50};
+
+    constexpr std::array<const Table *, 7> TABLES = {nullptr, &PAWN_TABLE, &ROOK_TABLE, &KNIGHT_TABLE, &BISHOP_TABLE, &QUEEN_TABLE, &KING_TABLE};
+
+    // Non-pawn material (both sides) below which kings use the endgame table
+    constexpr int ENDGAME_MATERIAL = 2 * (Chess::Evaluation::PIECE_VALUES[2] + Chess::Evaluation::PIECE_VALUES[3]);
+
+    constexpr int TEMPO = 10;
+
+    // Pawn structure, by relative rank where it matters
+    constexpr std::array<int, 8> PASSED_BONUS = {0, 5, 10, 20, 35, 60, 100, 0};
+    constexpr int ISOLATED_PENALTY = 15;
+    constexpr int DOUBLED_PENALTY = 12; // Per pawn beyond the first on a file
+    constexpr int BACKWARD_PENALTY = 8;
+
+    // Own pawns one and two ranks in front of a king on its first two ranks (middlegame only)
+    constexpr std::array<int, 2> SHIELD_BONUS = {12, 6};
+
+    constexpr Chess::Bitboard FILE_A = 0x0101010101010101ull;
+    constexpr Chess::Bitboard RANK_1 = 0xffull;
+
+    constexpr Chess::Bitboard fileMask(int file)
+    {
+        return FILE_A << file;
+    }
+
+    constexpr Chess::Bitboard adjacentFiles(int file)
+    {
+        return (file > 0 ? fileMask(file - 1) : 0) | (file < 7 ? fileMask(file + 1) : 0);
+    }
+
+    // Ranks strictly in front of rank, seen from color
+    constexpr Chess::Bitboard ranksAhead(int color, int rank)
+    {
+        if (color == 0)
+            return rank >= 7 ? 0 : ~Chess::Bitboard(0) << (8 * (rank + 1));
+        return rank <= 0 ? 0 : ~Chess::Bitboard(0) >> (8 * (8 - rank));
+    }
+
+    constexpr Chess::Bitboard relativeRank(int color, int rank)
+    {
+        return RANK_1 << (8 * (color == 0 ? rank : 7 - rank));
+    }
+}
+
+void Chess::Evaluation::evaluatePawns(const Position &position, PawnTable::Entry &entry)
+{
+    for (int color = 0; color < 2; color++)
+    {
+        Bitboard ours = position.pieces(color, PieceType::Pawn);
+        Bitboard theirs = position.pieces(color ^ 1, PieceType::Pawn);
+
+        int score = 0;
+        for (int file = 0; file < 8; file++)
+        {
+            int count = Bitboards::count(ours & fileMask(file));
+            if (count > 1)
+                score -= (count - 1) * DOUBLED_PENALTY;
+
+            // Shield of a king on this file
+            Bitboard shelter = ours & (fileMask(file) | adjacentFiles(file));
+            entry.shield[color][file] = static_cast<std::int8_t>(Bitboards::count(shelter & relativeRank(color, 1)) * SHIELD_BONUS[0] +
+                                                                 Bitboards::count(shelter & relativeRank(color, 2)) * SHIELD_BONUS[1]);
+        }
+
+        for (Bitboard squares = ours; squares;)
+        {
+            int square = Bitboards::popLsb(squares);
+            int file = square % 8, rank = square / 8;
+            Bitboard ahead = ranksAhead(color, rank);
+
+            if ((theirs & ahead & (fileMask(file) | adjacentFiles(file))) == 0 && (ours & ahead & fileMask(file)) == 0)
+                score += PASSED_BONUS[color == 0 ? rank : 7 - rank];
+
+            if ((ours & adjacentFiles(file)) == 0)
+            {
+                score -= ISOLATED_PENALTY;
+            }
+            else if ((ours & adjacentFiles(file) & ~ahead) == 0)
+            {
+                // Every neighbour has advanced and an enemy pawn guards the square in front
+                int stop = square + (color == 0 ? 8 : -8);
+                if (Bitboards::PAWN_ATTACKS[color][stop] & theirs)
+                    score -= BACKWARD_PENALTY;
+            }
+        }
+        entry.score[color] = static_cast<std::int16_t>(score);
+    }
+}
+
+int Chess::Evaluation::evaluate(const Position &position, PawnTable *pawnTable)
+{
+    std::array<int, 2> score = {0, 0};
+    int nonPawnMaterial = 0;
+
+    for (int type = PieceType::Pawn; type <= PieceType::Queen; type++)
+    {
+        for (int color = 0; color < 2; color++)
+        {
+            // Black reads the tables mirrored vertically
+            int flip = color == 0 ? 0 : 56;
+            for (auto squares = position.pieces(color, type); squares;)
+            {
+                int square = Bitboards::popLsb(squares);
+                score[color] += PIECE_VALUES[type] + (*TABLES[type])[square ^ flip];
+                if (type != PieceType::Pawn)
+                    nonPawnMaterial += PIECE_VALUES[type];
+            }
+        }
+    }
+
+    const auto &kingTable = nonPawnMaterial <= ENDGAME_MATERIAL ? KING_ENDGAME_TABLE : KING_TABLE;
+    score[0] += kingTable[position.kingSquare(0)];
+    score[1] += kingTable[position.kingSquare(1) ^ 56];
+
+    PawnTable::Entry computed;
+    const PawnTable::Entry *pawns = &computed;
+    if (pawnTable != nullptr)
+    {
+        auto &entry = pawnTable->entry(position.pawnKey());
+        bool hit = entry.key == position.pawnKey();
+        pawnTable->recordProbe(hit);
+        if (!hit)
+        {
+            evaluatePawns(position, entry);
+            entry.key = position.pawnKey();
+        }
+        pawns = &entry;
+    }
+    else
+    {
+        evaluatePawns(position, computed);
+    }
+
+    for (int color = 0; color < 2; color++)
+    {
+        score[color] += pawns->score[color];
+
+        // A king still on its first two ranks hides behind its pawns
+        int king = position.kingSquare(color);
+        int kingRank = color == 0 ? king / 8 : 7 - king / 8;
+        if (nonPawnMaterial > ENDGAME_MATERIAL && kingRank <= 1)
+            score[color] += pawns->shield[color][king % 8];
+    }
+
+    int us = position.sideToMove();
+    return score[us] - score[us ^ 1] + TEMPO;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <array>
+
+#include "PawnTable.h"
+#include "Position.h"
+
+namespace Chess::Evaluation
+{
+    // Centipawns by piece type (Pawn..King), shared with move ordering
+    constexpr std::array<int, 7> PIECE_VALUES = {0, 100, 500, 320, 330, 900, 0};
+
+    // Hand-crafted evaluation (material, piece-square tables and pawn structure) in centipawns
+    // for the side to move. Used whenever no NNUE network is loaded. Without a pawn table the
+    // pawn structure is computed every time.
+    int evaluate(const Position &position, PawnTable *pawnTable = nullptr);
+
+    // Pawn-structure terms of the position, stored in entry (its key is left alone)
+    void evaluatePawns(const Position &position, PawnTable::Entry &entry);
+}
@@ -0,0 +1,73 @@
+#include "GameClock.h"
+
+#include <algorithm>
+#include <cstdio>
+
+void Chess::GameClock::reset(std::int64_t baseMs, std::int64_t incrementMs)
+{
+    m_Remaining = {baseMs, baseMs};
+    m_Increment = incrementMs;
+    m_Running = -1;
+}
+
+void Chess::GameClock::start(int side)
+{
+    stop();
+    m_Running = side;
+    m_TurnStart = Clock::now();
+}
+
+void Chess::GameClock::stop()
+{
+    if (m_Running == -1)
+        return;
+
+    m_Remaining[m_Running] -= elapsed();
+    m_Running = -1;
+}
+
+void Chess::GameClock::press()
+{
+    if (m_Running == -1)
+        return;
+
+    int side = m_Running;
+    stop();
+
+    // No increment for a move made after the flag fell
+    if (m_Remaining[side] > 0)
+        m_Remaining[side] += m_Increment;
+    start(side ^ 1);
+}
+
+std::int64_t Chess::GameClock::remaining(int side) const
+{
+    return side == m_Running ? m_Remaining[side] - elapsed() : m_Remaining[side];
+}
+
+int Chess::GameClock::flagged() const
+{
+    for (int side = 0; side < 2; side++)
+    {
+        if (remaining(side) <= 0)
+            return side;
+    }
+    return -1;
+}
+
+std::string Chess::GameClock::format(std::int64_t ms)
+{
+    ms = std::max<std::int64_t>(ms, 0);
+
+    char text[32];
+    if (ms < 10'000)
+        std::snprintf(text, sizeof(text), "%lld.%lld", static_cast<long long>(ms / 1000), static_cast<long long>(ms / 100 % 10));
+    else
+        std::snprintf(text, sizeof(text), "%lld:%02lld", static_cast<long long>(ms / 60'000), static_cast<long long>(ms / 1000 % 60));
+    return text;
+}
+
+std::int64_t Chess::GameClock::elapsed() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_TurnStart).count();
+}
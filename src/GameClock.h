@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace Chess
+{
+    // Two-sided chess clock with a Fischer increment. Sides are 0 (White) and 1 (Black);
+    // only one clock runs at a time.
+    class GameClock
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        std::array<std::int64_t, 2> m_Remaining = {0, 0}; // Milliseconds, excluding the running turn
+        std::int64_t m_Increment = 0;
+
+        int m_Running = -1;
+        Clock::time_point m_TurnStart;
+
+    public:
+        void reset(std::int64_t baseMs, std::int64_t incrementMs);
+
+        // Starts (or resumes) the clock of side
+        void start(int side);
+
+        // Pauses the running clock, keeping its time
+        void stop();
+
+        // The running side completed a move: its clock stops, gains the increment, and the other side's starts
+        void press();
+
+        // Live value, the running turn included (negative once flagged)
+        std::int64_t remaining(int side) const;
+
+        std::int64_t increment() const
+        {
+            return m_Increment;
+        }
+
+        // Side whose clock runs, -1 if stopped
+        int running() const
+        {
+            return m_Running;
+        }
+
+        // Side out of time, -1 if none
+        int flagged() const;
+
+        // m:ss, or s.t under ten seconds
+        static std::string format(std::int64_t ms);
+
+    private:
+        std::int64_t elapsed() const;
+    };
+}
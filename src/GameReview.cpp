@@ -0,0 +1,198 @@
+#include "GameReview.h"
+#include "Tracer.h"
+
+#include <cmath>
+
+unsigned Chess::GameReview::threadCount()
+{
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+}
+
+bool Chess::GameReview::start(const Position &start, const std::vector<PackedMove> &moves, const SearchLimits &limits, const Nnue::Network *network)
+{
+    stop();
+
+    if (!m_Table.isAllocated() && !m_Table.resize(DEFAULT_HASH_MB))
+        return false;
+    if (m_Pool == nullptr)
+    {
+        m_Pool = std::make_unique<ThreadPool>(threadCount());
+        for (unsigned i = 0; i < m_Pool->size(); i++)
+            m_Searches.push_back(std::make_unique<Search>());
+    }
+
+    // Each task searches its own copy, with the game's history for repetitions
+    m_Moves = moves;
+    m_Positions.assign(1, start);
+    for (auto move : moves)
+    {
+        m_Positions.push_back(m_Positions.back());
+        m_Positions.back().makeMove(move);
+    }
+
+    m_Table.clear();
+    m_Table.newSearch();
+    {
+        std::lock_guard lock(m_Mutex);
+        m_IdleSearches.clear();
+        for (auto &search : m_Searches)
+        {
+            search->setNetwork(network);
+            search->setTranspositionTable(&m_Table, false);
+            m_IdleSearches.push_back(search.get());
+        }
+
+        m_Snapshot = Snapshot();
+        m_Snapshot.positions.resize(m_Positions.size());
+        m_Snapshot.verdicts.assign(m_Moves.size(), Verdict::Pending);
+        m_Version++;
+    }
+
+    m_Cancelled = false;
+    m_Remaining = m_Positions.size();
+    m_Start = std::chrono::steady_clock::now();
+
+    // In game order, so the score graph fills from the left
+    for (std::size_t i = 0; i < m_Positions.size(); i++)
+    {
+        m_Pool->submit([this, i, limits]
+                       { review(i, limits); });
+    }
+    return true;
+}
+
+void Chess::GameReview::stop()
+{
+    if (m_Pool == nullptr)
+        return;
+
+    // Queued positions return at once, running searches at their next limit check
+    m_Cancelled = true;
+    for (auto &search : m_Searches)
+        search->stop();
+    m_Pool->wait();
+
+    for (auto &search : m_Searches)
+        search->resetSignals();
+    m_Remaining = 0;
+}
+
+bool Chess::GameReview::poll(Snapshot &snapshot, std::uint64_t &version) const
+{
+    std::lock_guard lock(m_Mutex);
+    if (version == m_Version)
+        return false;
+
+    snapshot = m_Snapshot;
+    version = m_Version;
+    return true;
+}
+
+double Chess::GameReview::winPercent(int score)
+{
+    // Logistic fit of game results against engine scores
+    constexpr double SLOPE = 0.00368208;
+    return 50.0 + 50.0 * (2.0 / (1.0 + std::exp(-SLOPE * score)) - 1.0);
+}
+
+const char *Chess::GameReview::annotation(Verdict verdict)
+{
+    switch (verdict)
+    {
+    case Verdict::Inaccuracy:
+        return "?!";
+    case Verdict::Mistake:
+        return "?";
+    case Verdict::Blunder:
+        return "??";
+    default:
+        return "";
+    }
+}
+
+void Chess::GameReview::review(std::size_t index, const SearchLimits &limits)
+{
+    if (m_Cancelled.load(std::memory_order_relaxed))
+    {
+        m_Remaining.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    CHESS_TRACE_SCOPE("GameReview position");
+
+    Search *search;
+    {
+        std::lock_guard lock(m_Mutex);
+        search = m_IdleSearches.back();
+        m_IdleSearches.pop_back();
+    }
+
+    auto position = m_Positions[index];
+    PositionResult result;
+    result.done = true;
+
+    // A finished game has nothing to search
+    MoveList moves;
+    position.generateLegal(moves);
+    if (moves.size() == 0)
+    {
+        result.score = position.inCheck() ? -Search::MATE_SCORE : 0;
+    }
+    else
+    {
+        auto searched = search->run(position, limits);
+        result.score = searched.score;
+        result.depth = searched.depth;
+        result.bestMove = searched.bestMove;
+    }
+    if (position.sideToMove() == 1)
+        result.score = -result.score;
+
+    std::lock_guard lock(m_Mutex);
+    m_IdleSearches.push_back(search);
+
+    // A search cut short by stop() is not worth showing
+    if (m_Cancelled.load(std::memory_order_relaxed))
+    {
+        m_Remaining.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_Snapshot.positions[index] = result;
+    m_Snapshot.completed++;
+    m_Snapshot.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_Start).count();
+    if (index > 0)
+        m_Snapshot.verdicts[index - 1] = grade(index - 1);
+    if (index < m_Moves.size())
+        m_Snapshot.verdicts[index] = grade(index);
+    m_Version++;
+
+    m_Remaining.fetch_sub(1, std::memory_order_relaxed);
+}
+
+Chess::GameReview::Verdict Chess::GameReview::grade(std::size_t index) const
+{
+    // Winning chances lost by the move, in percentage points
+    constexpr double INACCURACY = 10.0;
+    constexpr double MISTAKE = 20.0;
+    constexpr double BLUNDER = 30.0;
+
+    const auto &before = m_Snapshot.positions[index];
+    const auto &after = m_Snapshot.positions[index + 1];
+    if (!before.done || !after.done)
+        return Verdict::Pending;
+
+    if (m_Moves[index] == before.bestMove)
+        return Verdict::Best;
+
+    int sign = m_Positions[index].sideToMove() == 0 ? 1 : -1;
+    double lost = winPercent(sign * before.score) - winPercent(sign * after.score);
+    if (lost >= BLUNDER)
+        return Verdict::Blunder;
+    if (lost >= MISTAKE)
+        return Verdict::Mistake;
+    if (lost >= INACCURACY)
+        return Verdict::Inaccuracy;
+    return Verdict::Good;
+}
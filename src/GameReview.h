@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Nnue.h"
+#include "Position.h"
+#include "Search.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+namespace Chess
+{
+    // Searches every position of a game on a thread pool, one position per task, and grades
+    // each move by how much it lowered the mover's winning chances. Positions are independent
+    // searches (each on its own copy of the position) sharing one transposition table, so
+    // neighbouring plies reuse each other's work. Results come in as they complete; all
+    // methods are for the owning thread only.
+    class GameReview
+    {
+    public:
+        static constexpr std::size_t DEFAULT_HASH_MB = 64;
+        static constexpr std::uint64_t DEFAULT_NODES = 250000; // Per position
+
+        enum class Verdict : std::uint8_t
+        {
+            Pending, // A position on either side is not searched yet
+            Best,    // The engine's choice
+            Good,
+            Inaccuracy,
+            Mistake,
+            Blunder,
+        };
+
+        struct PositionResult
+        {
+            bool done = false;
+            int score = 0; // Centipawns (or a mate score) for White
+            int depth = 0;
+            PackedMove bestMove;
+        };
+
+        struct Snapshot
+        {
+            std::vector<PositionResult> positions; // Before the first move, then after each one
+            std::vector<Verdict> verdicts;         // One per move
+            std::size_t completed = 0;
+            std::int64_t timeMs = 0;
+        };
+
+    private:
+        TranspositionTable m_Table;
+        std::unique_ptr<ThreadPool> m_Pool;
+        std::vector<std::unique_ptr<Search>> m_Searches; // One per pool thread
+        std::vector<Search *> m_IdleSearches;            // Guarded by m_Mutex
+        std::atomic<bool> m_Cancelled = false;
+        std::atomic<std::size_t> m_Remaining = 0;
+
+        std::vector<Position> m_Positions;
+        std::vector<PackedMove> m_Moves;
+        std::chrono::steady_clock::time_point m_Start;
+
+        // Written by the pool threads after every position
+        mutable std::mutex m_Mutex;
+        Snapshot m_Snapshot;
+        std::uint64_t m_Version = 0;
+
+    public:
+        GameReview() = default;
+
+        ~GameReview()
+        {
+            stop();
+        }
+
+        GameReview(const GameReview &) = delete;
+        GameReview &operator=(const GameReview &) = delete;
+
+        // Reviews moves played from start (which must all be legal); stops any running review first.
+        // limits applies to each position. false if the hash table can't be allocated
+        bool start(const Position &start, const std::vector<PackedMove> &moves, const SearchLimits &limits, const Nnue::Network *network);
+        void stop();
+
+        bool isRunning() const
+        {
+            return m_Remaining.load(std::memory_order_relaxed) > 0;
+        }
+
+        // Every hardware thread but one, which is left to the window
+        static unsigned threadCount();
+
+        // Copies the latest results if they are newer than version (and updates version)
+        bool poll(Snapshot &snapshot, std::uint64_t &version) const;
+
+        // Expected score of the side with score (centipawns for it), in percent
+        static double winPercent(int score);
+
+        // "?!", "?" or "??", empty for the rest
+        static const char *annotation(Verdict verdict);
+
+    private:
+        void review(std::size_t index, const SearchLimits &limits);
+
+        // Move index, once both its positions are known
+        Verdict grade(std::size_t index) const;
+    };
+}
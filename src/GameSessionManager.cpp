@@ -0,0 +1,296 @@
+#include "GameSessionManager.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <future>
+
+// LATENCY
+
+void Chess::LatencyHistogram::record(std::uint64_t nanoseconds)
+{
+    nanoseconds = std::max<std::uint64_t>(nanoseconds, 1);
+    int exponent = 63 - std::countl_zero(nanoseconds);
+    int fraction = exponent >= 2 ? static_cast<int>((nanoseconds >> (exponent - 2)) & 3) : 0;
+    m_Counts[exponent * SUB_BUCKETS + fraction]++;
+    m_Total++;
+}
+
+void Chess::LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (std::size_t i = 0; i < m_Counts.size(); i++)
+        m_Counts[i] += other.m_Counts[i];
+    m_Total += other.m_Total;
+}
+
+std::uint64_t Chess::LatencyHistogram::percentile(double fraction) const
+{
+    if (m_Total == 0)
+        return 0;
+
+    auto target = static_cast<std::uint64_t>(fraction * (m_Total - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < m_Counts.size(); i++)
+    {
+        seen += m_Counts[i];
+        if (seen >= target)
+        {
+            // Upper edge of the bucket
+            int exponent = static_cast<int>(i) / SUB_BUCKETS;
+            int sub = static_cast<int>(i) % SUB_BUCKETS;
+            if (exponent < 2)
+                return std::uint64_t(2) << exponent;
+            return (std::uint64_t(SUB_BUCKETS + sub + 1)) << (exponent - 2);
+        }
+    }
+    return 0;
+}
+
+// REQUESTS
+
+void Chess::GameSessionManager::Request::setText(std::string_view text)
+{
+    length = static_cast<std::uint8_t>(std::min(text.size(), MAX_PAYLOAD));
+    std::copy_n(text.begin(), length, payload.begin());
+}
+
+// MANAGER
+
+Chess::GameSessionManager::GameSessionManager(unsigned shards)
+{
+    if (shards == 0)
+        shards = std::max(1u, std::thread::hardware_concurrency());
+    shards = std::min(shards, MAX_SHARDS);
+
+    m_Shards.reserve(shards);
+    for (unsigned i = 0; i < shards; i++)
+        m_Shards.push_back(std::make_unique<Shard>());
+
+    for (unsigned i = 0; i < shards; i++)
+    {
+        auto &shard = *m_Shards[i];
+        shard.worker = std::thread([this, &shard, i]
+                                   { workerLoop(shard, i); });
+    }
+}
+
+Chess::GameSessionManager::~GameSessionManager()
+{
+    for (auto &shard : m_Shards)
+    {
+        {
+            std::lock_guard lock(shard->queueMutex);
+            shard->stopping = true;
+        }
+        shard->queueReady.notify_one();
+    }
+
+    for (auto &shard : m_Shards)
+        shard->worker.join();
+}
+
+void Chess::GameSessionManager::submit(const Request &request, Callback callback)
+{
+    // New sessions are spread round robin, the rest go to the shard in their id
+    unsigned index = request.command == Command::Create ? m_NextShard.fetch_add(1, std::memory_order_relaxed) % shardCount()
+                                                        : (request.session & 0xff) % shardCount();
+    auto &shard = *m_Shards[index];
+
+    {
+        std::lock_guard lock(shard.queueMutex);
+        shard.queue.emplace_back(request, std::move(callback));
+    }
+    shard.queueReady.notify_one();
+}
+
+Chess::GameSessionManager::Response Chess::GameSessionManager::execute(const Request &request)
+{
+    std::promise<Response> promise;
+    auto future = promise.get_future();
+    submit(request, [&promise](const Response &response)
+           { promise.set_value(response); });
+    return future.get();
+}
+
+void Chess::GameSessionManager::workerLoop(Shard &shard, unsigned index)
+{
+    std::deque<std::pair<Request, Callback>> batch;
+    Tracer::setThreadName("Session shard " + std::to_string(index));
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(shard.queueMutex);
+            shard.queueReady.wait(lock, [&shard]
+                                  { return shard.stopping || !shard.queue.empty(); });
+
+            if (shard.queue.empty())
+                return; // Stopping
+
+            // Take everything queued at once to keep the lock short
+            batch.swap(shard.queue);
+        }
+
+        CHESS_TRACE_SCOPE("Session batch");
+        for (auto &[request, callback] : batch)
+        {
+            auto response = handle(shard, index, request);
+            if (callback)
+                callback(response);
+        }
+        batch.clear();
+    }
+}
+
+Chess::GameSessionManager::GameState Chess::GameSessionManager::gameState(const Position &position)
+{
+    MoveList moves;
+    position.generateLegal(moves);
+    if (moves.size() == 0)
+        return position.inCheck() ? GameState::Checkmate : GameState::Stalemate;
+    if (position.repetitionCount() >= 2 || position.halfmoveClock() >= 100 || position.hasInsufficientMaterial())
+        return GameState::Draw;
+    return GameState::Ongoing;
+}
+
+std::size_t Chess::GameSessionManager::sessionBytes(const Session &session)
+{
+    return sizeof(Session) + session.position.history().capacity() * sizeof(Position::State);
+}
+
+Chess::GameSessionManager::Response Chess::GameSessionManager::handle(Shard &shard, unsigned index, const Request &request)
+{
+    Response response;
+    response.tag = request.tag;
+    response.session = request.session;
+
+    if (request.command == Command::Create)
+    {
+        Position position;
+        if (request.length != 0 && !position.setFen(request.text()))
+        {
+            response.status = Status::InvalidFen;
+            return response;
+        }
+
+        std::uint16_t slot;
+        if (!shard.freeSlots.empty())
+        {
+            slot = shard.freeSlots.back();
+            shard.freeSlots.pop_back();
+        }
+        else if (shard.sessions.size() < MAX_SLOTS)
+        {
+            slot = static_cast<std::uint16_t>(shard.sessions.size());
+            shard.sessions.emplace_back();
+        }
+        else
+        {
+            response.status = Status::BadRequest; // Shard is full
+            return response;
+        }
+
+        auto &session = shard.sessions[slot];
+        session.position = std::move(position);
+        session.active = true;
+        session.moves = 0;
+
+        response.session = (std::uint32_t(session.generation) << 24) | (std::uint32_t(slot) << 8) | index;
+        response.state = gameState(session.position);
+        response.payload = session.position.fen();
+
+        std::lock_guard lock(shard.statsMutex);
+        shard.activeSessions++;
+        shard.sessionBytes += sessionBytes(session);
+        shard.maxSessionBytes = std::max(shard.maxSessionBytes, sessionBytes(session));
+        return response;
+    }
+
+    // Everything else addresses an existing session
+    std::uint32_t slot = (request.session >> 8) & 0xffff;
+    if ((request.session & 0xff) != index || slot >= shard.sessions.size() || !shard.sessions[slot].active || shard.sessions[slot].generation != (request.session >> 24))
+    {
+        response.status = Status::UnknownSession;
+        return response;
+    }
+    auto &session = shard.sessions[slot];
+
+    switch (request.command)
+    {
+    case Command::Move:
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::size_t bytesBefore = sessionBytes(session);
+
+        if (gameState(session.position) != GameState::Ongoing)
+        {
+            response.status = Status::GameOver;
+        }
+        else
+        {
+            auto move = session.position.parseMove(request.text());
+            if (move.isNone())
+            {
+                response.status = Status::IllegalMove;
+            }
+            else
+            {
+                session.position.makeMove(move);
+                session.position.compactHistory();
+                session.moves++;
+            }
+        }
+        response.state = gameState(session.position);
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard lock(shard.statsMutex);
+        shard.latency.record(static_cast<std::uint64_t>(elapsed));
+        shard.sessionBytes += sessionBytes(session) - bytesBefore;
+        shard.maxSessionBytes = std::max(shard.maxSessionBytes, sessionBytes(session));
+        break;
+    }
+    case Command::Query:
+        response.state = gameState(session.position);
+        break;
+    case Command::Close:
+    {
+        std::lock_guard lock(shard.statsMutex);
+        shard.activeSessions--;
+        shard.sessionBytes -= sessionBytes(session);
+
+        session.active = false;
+        session.generation++;
+        session.position = Position();
+        shard.freeSlots.push_back(static_cast<std::uint16_t>(slot));
+        return response;
+    }
+    default:
+        response.status = Status::BadRequest;
+        return response;
+    }
+
+    response.payload = session.position.fen();
+    return response;
+}
+
+Chess::GameSessionManager::Statistics Chess::GameSessionManager::statistics() const
+{
+    Statistics statistics;
+    LatencyHistogram latency;
+
+    for (const auto &shard : m_Shards)
+    {
+        std::lock_guard lock(shard->statsMutex);
+        statistics.sessions += shard->activeSessions;
+        statistics.sessionBytes += shard->sessionBytes;
+        statistics.maxSessionBytes = std::max(statistics.maxSessionBytes, shard->maxSessionBytes);
+        latency.merge(shard->latency);
+    }
+
+    statistics.moves = latency.count();
+    statistics.p50Nanoseconds = latency.percentile(0.50);
+    statistics.p99Nanoseconds = latency.percentile(0.99);
+    return statistics;
+}
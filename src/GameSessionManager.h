@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Position.h"
+
+namespace Chess
+{
+    // Move-apply latency in log-linear buckets (4 per power of two of nanoseconds)
+    class LatencyHistogram
+    {
+    private:
+        static constexpr int SUB_BUCKETS = 4;
+        std::array<std::uint64_t, 64 * SUB_BUCKETS> m_Counts{};
+        std::uint64_t m_Total = 0;
+
+    public:
+        void record(std::uint64_t nanoseconds);
+        void merge(const LatencyHistogram &other);
+
+        // Upper bound of the bucket holding the given fraction (0.5 = median), 0 if empty
+        std::uint64_t percentile(double fraction) const;
+
+        std::uint64_t count() const
+        {
+            return m_Total;
+        }
+    };
+
+    // Hosts many independent games in one process. Sessions live in shards, each owned by one
+    // worker thread, so requests for different shards never contend. A session is a Position
+    // plus a few counters; its undo history is cut at every irreversible move.
+    class GameSessionManager
+    {
+    public:
+        enum class Command : std::uint8_t
+        {
+            Create = 1, // Payload: FEN (empty = standard start)
+            Move = 2,   // Payload: UCI or SAN
+            Query = 3,
+            Close = 4,
+        };
+
+        enum class Status : std::uint8_t
+        {
+            Ok,
+            UnknownSession,
+            IllegalMove,
+            InvalidFen,
+            GameOver,
+            BadRequest,
+        };
+
+        enum class GameState : std::uint8_t
+        {
+            Ongoing,
+            Checkmate,
+            Stalemate,
+            Draw,
+        };
+
+        static constexpr std::size_t MAX_PAYLOAD = 255;
+
+        struct Request
+        {
+            std::uint32_t tag = 0; // Echoed back, lets clients pipeline
+            std::uint32_t session = 0;
+            Command command = Command::Query;
+            std::uint8_t length = 0;
+            std::array<char, MAX_PAYLOAD> payload{};
+
+            std::string_view text() const
+            {
+                return {payload.data(), length};
+            }
+
+            void setText(std::string_view text);
+        };
+
+        struct Response
+        {
+            std::uint32_t tag = 0;
+            std::uint32_t session = 0;
+            Status status = Status::Ok;
+            GameState state = GameState::Ongoing;
+            std::string payload; // FEN after Create, Move and Query
+        };
+
+        using Callback = std::function<void(const Response &)>;
+
+        struct Statistics
+        {
+            std::size_t sessions = 0;
+            std::size_t sessionBytes = 0; // Total, undo history included
+            std::size_t maxSessionBytes = 0;
+            std::uint64_t moves = 0;
+            std::uint64_t p50Nanoseconds = 0;
+            std::uint64_t p99Nanoseconds = 0;
+        };
+
+    private:
+        // Session ids: generation (8 bits) | slot (16 bits) | shard (8 bits)
+        static constexpr unsigned MAX_SHARDS = 256;
+        static constexpr unsigned MAX_SLOTS = 1 << 16;
+
+        struct Session
+        {
+            Position position;
+            std::uint8_t generation = 0;
+            bool active = false;
+            std::uint16_t moves = 0;
+        };
+
+        struct Shard
+        {
+            std::thread worker;
+
+            std::mutex queueMutex;
+            std::condition_variable queueReady;
+            std::deque<std::pair<Request, Callback>> queue;
+            bool stopping = false;
+
+            // Owned by the worker thread
+            std::vector<Session> sessions;
+            std::vector<std::uint16_t> freeSlots;
+
+            // Copied out under statsMutex for statistics()
+            mutable std::mutex statsMutex;
+            LatencyHistogram latency;
+            std::size_t activeSessions = 0;
+            std::size_t sessionBytes = 0;
+            std::size_t maxSessionBytes = 0;
+        };
+
+        std::vector<std::unique_ptr<Shard>> m_Shards;
+        std::atomic<unsigned> m_NextShard = 0;
+
+    public:
+        // 0 = one shard per hardware thread
+        explicit GameSessionManager(unsigned shards = 0);
+        ~GameSessionManager();
+
+        GameSessionManager(const GameSessionManager &) = delete;
+        GameSessionManager &operator=(const GameSessionManager &) = delete;
+
+        // Queues a request; callback runs on the shard's worker thread
+        void submit(const Request &request, Callback callback);
+
+        // Blocking convenience wrapper around submit
+        Response execute(const Request &request);
+
+        unsigned shardCount() const
+        {
+            return static_cast<unsigned>(m_Shards.size());
+        }
+
+        Statistics statistics() const;
+
+    private:
+        void workerLoop(Shard &shard, unsigned index);
+        Response handle(Shard &shard, unsigned index, const Request &request);
+
+        static GameState gameState(const Position &position);
+        static std::size_t sessionBytes(const Session &session);
+    };
+}
@@ -0,0 +1,127 @@
+#include "GameTree.h"
+
+Chess::GameTree::GameTree()
+{
+    m_Nodes.reserve(512);
+    clear(0, 0);
+}
+
+void Chess::GameTree::clear(std::uint64_t rootKey, int halfmoveClock)
+{
+    m_Nodes.clear();
+    m_FreeNodes.clear();
+    m_Checkpoints.clear();
+
+    Node root{};
+    root.move.key = rootKey;
+    root.move.halfmoveClock = static_cast<std::uint16_t>(halfmoveClock);
+    root.parent = NONE;
+    root.firstChild = NONE;
+    root.nextSibling = NONE;
+    root.ply = 0;
+
+    m_Nodes.push_back(root);
+}
+
+Chess::GameTree::NodeIndex Chess::GameTree::findChild(NodeIndex parent, const Move &move) const
+{
+    for (auto child = m_Nodes[parent].firstChild; child != NONE; child = m_Nodes[child].nextSibling)
+    {
+        const auto &other = m_Nodes[child].move;
+        // Promotions to different pieces are different moves
+        if (other.from == move.from && other.to == move.to && other.kind == move.kind &&
+            (move.kind != Move::Kind::Promotion || other.movedPieceSymbol == move.movedPieceSymbol))
+            return child;
+    }
+    return NONE;
+}
+
+Chess::GameTree::NodeIndex Chess::GameTree::addChild(NodeIndex parent, const Move &move)
+{
+    Node node{};
+    node.move = move;
+    node.parent = parent;
+    node.firstChild = NONE;
+    node.nextSibling = NONE;
+    node.ply = m_Nodes[parent].ply + 1;
+
+    NodeIndex index;
+    if (!m_FreeNodes.empty())
+    {
+        index = m_FreeNodes.back();
+        m_FreeNodes.pop_back();
+        m_Nodes[index] = node;
+    }
+    else
+    {
+        index = static_cast<NodeIndex>(m_Nodes.size());
+        m_Nodes.push_back(node);
+    }
+
+    // Append as the last alternative
+    auto *link = &m_Nodes[parent].firstChild;
+    while (*link != NONE)
+        link = &m_Nodes[*link].nextSibling;
+    *link = index;
+
+    return index;
+}
+
+void Chess::GameTree::promote(NodeIndex node)
+{
+    auto parent = m_Nodes[node].parent;
+    if (parent == NONE || m_Nodes[parent].firstChild == node)
+        return;
+
+    // Unlink, then insert at the front of the siblings list
+    auto *link = &m_Nodes[parent].firstChild;
+    while (*link != node)
+        link = &m_Nodes[*link].nextSibling;
+    *link = m_Nodes[node].nextSibling;
+
+    m_Nodes[node].nextSibling = m_Nodes[parent].firstChild;
+    m_Nodes[parent].firstChild = node;
+}
+
+void Chess::GameTree::remove(NodeIndex node)
+{
+    auto parent = m_Nodes[node].parent;
+    if (parent == NONE)
+        return; // The root can only be cleared
+
+    auto *link = &m_Nodes[parent].firstChild;
+    while (*link != node)
+        link = &m_Nodes[*link].nextSibling;
+    *link = m_Nodes[node].nextSibling;
+
+    // Recycle the subtree (breadth-first, the free list doubles as the work queue)
+    auto first = m_FreeNodes.size();
+    m_FreeNodes.push_back(node);
+    for (auto i = first; i < m_FreeNodes.size(); i++)
+    {
+        for (auto child = m_Nodes[m_FreeNodes[i]].firstChild; child != NONE; child = m_Nodes[child].nextSibling)
+            m_FreeNodes.push_back(child);
+        m_Checkpoints.erase(m_FreeNodes[i]);
+    }
+}
+
+Chess::GameTree::NodeIndex Chess::GameTree::checkpointAbove(NodeIndex node) const
+{
+    while (node != NONE && !m_Checkpoints.contains(node))
+        node = m_Nodes[node].parent;
+    return node;
+}
+
+Chess::GameTree::NodeIndex Chess::GameTree::commonAncestor(NodeIndex a, NodeIndex b) const
+{
+    while (m_Nodes[a].ply > m_Nodes[b].ply)
+        a = m_Nodes[a].parent;
+    while (m_Nodes[b].ply > m_Nodes[a].ply)
+        b = m_Nodes[b].parent;
+    while (a != b)
+    {
+        a = m_Nodes[a].parent;
+        b = m_Nodes[b].parent;
+    }
+    return a;
+}
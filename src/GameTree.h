@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "Move.h"
+
+namespace Chess
+{
+    // Tree of every line played or analysed in a game: variations share their common
+    // prefix. Nodes are allocated from a per-game arena (one vector, addressed by index,
+    // only cleared on restart) and deleted variations are recycled through a free list.
+    // Every CHECKPOINT_INTERVAL plies a node can also keep the whole board, so any node is
+    // a few moves away from a position that can be set up directly.
+    class GameTree
+    {
+    public:
+        using NodeIndex = std::uint32_t;
+
+        static constexpr NodeIndex NONE = std::numeric_limits<NodeIndex>::max();
+        static constexpr NodeIndex ROOT = 0;
+
+        struct Node
+        {
+            Move move; // Move leading here (the root only uses key and halfmoveClock)
+
+            NodeIndex parent;
+            NodeIndex firstChild;  // Main continuation
+            NodeIndex nextSibling; // Next alternative to this move
+
+            std::uint16_t ply;
+        };
+
+        static constexpr int CHECKPOINT_INTERVAL = 8;
+
+        // Board after the node's move (the side to move follows from the ply)
+        struct Checkpoint
+        {
+            std::array<std::uint8_t, 64> pieces; // Piece descriptors, 0 for empty squares
+            std::uint32_t whiteScore;
+            std::uint32_t blackScore;
+        };
+
+    private:
+        std::vector<Node> m_Nodes;
+        std::vector<NodeIndex> m_FreeNodes;
+        std::unordered_map<NodeIndex, Checkpoint> m_Checkpoints;
+
+    public:
+        GameTree();
+
+        // Drops every line and starts again from a position with the given key
+        void clear(std::uint64_t rootKey, int halfmoveClock);
+
+        // Child of parent reached by the same move, NONE if it was never played
+        NodeIndex findChild(NodeIndex parent, const Move &move) const;
+
+        // Adds move as the last alternative after parent (the main line if it is the first)
+        NodeIndex addChild(NodeIndex parent, const Move &move);
+
+        // Makes node the main continuation of its parent
+        void promote(NodeIndex node);
+
+        // Unlinks node and recycles its whole subtree
+        void remove(NodeIndex node);
+
+        void setCheckpoint(NodeIndex node, const Checkpoint &checkpoint)
+        {
+            m_Checkpoints[node] = checkpoint;
+        }
+
+        // nullptr if the node has none
+        const Checkpoint *checkpoint(NodeIndex node) const
+        {
+            auto it = m_Checkpoints.find(node);
+            return it != m_Checkpoints.end() ? &it->second : nullptr;
+        }
+
+        // Node itself or its closest ancestor with a checkpoint, NONE if there is none
+        NodeIndex checkpointAbove(NodeIndex node) const;
+
+        // Deepest common ancestor of both nodes (possibly one of them)
+        NodeIndex commonAncestor(NodeIndex a, NodeIndex b) const;
+
+        Node &operator[](NodeIndex index)
+        {
+            return m_Nodes[index];
+        }
+
+        const Node &operator[](NodeIndex index) const
+        {
+            return m_Nodes[index];
+        }
+
+        std::size_t nodeCount() const
+        {
+            return m_Nodes.size() - m_FreeNodes.size();
+        }
+
+        std::size_t memoryUsage() const
+        {
+            return m_Nodes.capacity() * sizeof(Node) + m_FreeNodes.capacity() * sizeof(NodeIndex) +
+                   m_Checkpoints.size() * (sizeof(NodeIndex) + sizeof(Checkpoint) + 2 * sizeof(void *));
+        }
+    };
+}
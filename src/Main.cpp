@@ -1,10 +1,17 @@
 #include "Chess.h"
 
+#include <cstdlib>
+
 constexpr auto WINDOW_WIDTH = 856u;
 constexpr auto WINDOW_HEIGHT = 600u;
 
 int main()
 {
+    // CHESS_TRACE=1 traces from the start; SIGUSR1 dumps the trace, SIGUSR2 switches it
+    Chess::Tracer::setThreadName("Main");
+    Chess::Tracer::setEnabled(std::getenv("CHESS_TRACE") != nullptr);
+    Chess::Tracer::installSignalHandler();
+
     // Game window (SQUARED)
     auto window = sf::RenderWindow(sf::VideoMode({WINDOW_WIDTH, WINDOW_HEIGHT}), "Chess!", sf::Style::Close | sf::Style::Resize);
     window.setMinimumSize(sf::Vector2u(WINDOW_WIDTH, WINDOW_HEIGHT));
@@ -21,6 +28,8 @@ int main()
     sf::Clock deltaClock;
     while (window.isOpen())
     {
+        CHESS_PROFILE_SECTION(Update);
+
         // Handling events
         while (const std::optional event = window.pollEvent())
         {
@@ -33,6 +42,12 @@ int main()
             {
                 chess.handleClick(sf::Mouse::getPosition(window));
             }
+            else if (const auto *keyPressed = event->getIf<sf::Event::KeyPressed>())
+            {
+                // Not while typing in a text field
+                if (!ImGui::GetIO().WantCaptureKeyboard)
+                    chess.handleKey(keyPressed->code);
+            }
             else if (event->is<sf::Event::Resized>())
             {
                 window.setView(sf::View(sf::FloatRect(sf::Vector2f(0, 0), sf::Vector2f(window.getSize().x, window.getSize().y))));
@@ -44,14 +59,20 @@ int main()
             ImGui::SFML::ProcessEvent(window, *event);
         }
 
+        // Clock and computer player
+        chess.update();
+
         // Preparing GUI
         ImGui::SFML::Update(window, deltaClock.restart());
+        CHESS_PROFILE_SECTION(GUI);
         chess.prepareGUI();
 
         // Rendering
+        CHESS_PROFILE_SECTION(Draw);
         window.clear();
         window.draw(chess);
         ImGui::SFML::Render(window);
+        CHESS_PROFILE_FRAME_END();
         window.display();
     }
 }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace Chess
+{
+    // Read-only memory mapping of a whole file (mmap / MapViewOfFile)
+    class MappedFile
+    {
+    private:
+        const std::byte *m_Data = nullptr;
+        std::size_t m_Size = 0;
+
+#ifdef _WIN32
+        void *m_File = nullptr;
+        void *m_Mapping = nullptr;
+#endif
+
+    public:
+        MappedFile() = default;
+
+        ~MappedFile()
+        {
+            close();
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        MappedFile(MappedFile &&other) noexcept
+        {
+            swap(other);
+        }
+
+        MappedFile &operator=(MappedFile &&other) noexcept
+        {
+            if (this != &other)
+            {
+                close();
+                swap(other);
+            }
+            return *this;
+        }
+
+        // Returns false if the file cannot be opened or is empty
+        bool open(const std::string &path);
+        void close();
+
+        bool isOpen() const
+        {
+            return m_Data != nullptr;
+        }
+
+        const std::byte *data() const
+        {
+            return m_Data;
+        }
+
+        std::size_t size() const
+        {
+            return m_Size;
+        }
+
+    private:
+        void swap(MappedFile &other) noexcept
+        {
+            std::swap(m_Data, other.m_Data);
+            std::swap(m_Size, other.m_Size);
+#ifdef _WIN32
+            std::swap(m_File, other.m_File);
+            std::swap(m_Mapping, other.m_Mapping);
+#endif
+        }
+    };
+}
@@ -0,0 +1,303 @@
+#include "MateSolver.h"
+#include "Tracer.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+
+namespace
+{
+    using Chess::MoveList;
+    using Chess::Position;
+
+    // Proof and disproof numbers saturate here: a node at INFINITE is decided
+    constexpr std::uint32_t INFINITE = 1u << 30;
+
+    // Moves left and the attacker are hashed into the key: the same position is a different
+    // problem with fewer moves, and its numbers are reversed for the other attacker
+    constexpr std::uint64_t problemKey(int movesLeft, int attacker)
+    {
+        std::uint64_t state = 0x4d617465ull + static_cast<std::uint64_t>(movesLeft * 2 + attacker); // "Mate"
+        return Chess::Zobrist::splitMix64(state);
+    }
+
+    std::uint32_t saturatedSum(std::uint64_t a, std::uint64_t b)
+    {
+        return static_cast<std::uint32_t>(std::min<std::uint64_t>(a + b, INFINITE));
+    }
+}
+
+Chess::MateSolver::MateSolver(std::size_t tableMegabytes)
+{
+    // Power of two for the index mask
+    std::size_t slots = std::max<std::size_t>(tableMegabytes, 1) * 1024 * 1024 / sizeof(Slot);
+    m_Table.assign(std::bit_floor(slots), Slot{});
+}
+
+Chess::MateSolver::Result Chess::MateSolver::solve(const Position &position, int maxMoves, std::uint64_t nodeLimit)
+{
+    CHESS_TRACE_SCOPE("MateSolver::solve");
+    auto start = std::chrono::steady_clock::now();
+
+    m_Nodes = 0;
+    m_NodeLimit = nodeLimit;
+    m_Aborted = false;
+    m_Attacker = position.sideToMove();
+
+    Result result;
+    auto root = position;
+    for (int moves = 1; moves <= maxMoves && !m_Aborted; moves++)
+    {
+        if (prove(root, moves))
+        {
+            result.mateIn = moves;
+            break;
+        }
+    }
+
+    if (result.mateIn != 0)
+    {
+        // Every first move that mates as fast: a puzzle has exactly one
+        MoveList moves;
+        generate(root, result.mateIn, moves);
+        for (auto move : moves)
+        {
+            root.makeMove(move);
+            if (prove(root, result.mateIn - 1))
+                result.keyMoves.push_back(move);
+            root.unmakeMove();
+        }
+
+        if (!result.keyMoves.empty())
+        {
+            result.line.push_back(result.keyMoves.front());
+            auto replay = root;
+            replay.makeMove(result.keyMoves.front());
+            extendLine(replay, result.mateIn - 1, result.line);
+        }
+    }
+
+    if (m_Aborted)
+        result.status = Status::Unknown;
+    else
+        result.status = result.mateIn != 0 ? Status::Mate : Status::NoMate;
+
+    result.nodes = m_Nodes;
+    result.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool Chess::MateSolver::prove(Position &position, int movesLeft)
+{
+    search(position, movesLeft, INFINITE, INFINITE);
+    if (m_Aborted)
+        return false;
+
+    std::uint32_t phi, delta;
+    lookup(position.key(), movesLeft, phi, delta);
+    return position.sideToMove() == m_Attacker ? phi == 0 : delta == 0;
+}
+
+void Chess::MateSolver::search(Position &position, int movesLeft, std::uint32_t phiThreshold, std::uint32_t deltaThreshold)
+{
+    if ((++m_Nodes & 1023) == 0 && (m_StopRequested.load(std::memory_order_relaxed) || (m_NodeLimit != 0 && m_Nodes >= m_NodeLimit)))
+        m_Aborted = true;
+    if (m_Aborted)
+        return;
+
+    std::uint64_t key = position.key();
+    bool attacking = position.sideToMove() == m_Attacker;
+
+    MoveList moves;
+    generate(position, movesLeft, moves);
+
+    std::uint32_t phi, delta;
+    if (terminal(position, movesLeft, moves, phi, delta))
+    {
+        store(key, movesLeft, phi, delta);
+        return;
+    }
+
+    // Children are defender nodes with one attacking move less, or attacker nodes with as many
+    int childMovesLeft = attacking ? movesLeft - 1 : movesLeft;
+    std::array<std::uint64_t, 256> childKeys;
+    for (int i = 0; i < moves.count; i++)
+    {
+        position.makeMove(moves.moves[i]);
+        childKeys[i] = position.key();
+        position.unmakeMove();
+    }
+
+    while (true)
+    {
+        // phi is the best child's delta (one winning move is enough), delta the sum of the children's phi
+        int best = 0;
+        std::uint32_t bestPhi = 0;
+        std::uint32_t bestDelta = INFINITE;
+        std::uint32_t secondDelta = INFINITE;
+        phi = INFINITE;
+        delta = 0;
+        for (int i = 0; i < moves.count; i++)
+        {
+            std::uint32_t childPhi, childDelta;
+            lookup(childKeys[i], childMovesLeft, childPhi, childDelta);
+
+            delta = saturatedSum(delta, childPhi);
+            if (childDelta < bestDelta)
+            {
+                secondDelta = bestDelta;
+                bestDelta = childDelta;
+                bestPhi = childPhi;
+                best = i;
+            }
+            else if (childDelta < secondDelta)
+            {
+                secondDelta = childDelta;
+            }
+        }
+        phi = bestDelta;
+
+        if (phi >= phiThreshold || delta >= deltaThreshold)
+            break;
+
+        std::uint32_t childPhiThreshold = deltaThreshold >= INFINITE ? INFINITE : deltaThreshold - (delta - bestPhi);
+        std::uint32_t childDeltaThreshold = std::min(phiThreshold, saturatedSum(secondDelta, 1));
+
+        position.makeMove(moves.moves[best]);
+        search(position, childMovesLeft, childPhiThreshold, childDeltaThreshold);
+        position.unmakeMove();
+
+        if (m_Aborted)
+            return;
+    }
+
+    store(key, movesLeft, phi, delta);
+}
+
+bool Chess::MateSolver::terminal(const Position &position, int movesLeft, const MoveList &moves, std::uint32_t &phi, std::uint32_t &delta) const
+{
+    bool attacking = position.sideToMove() == m_Attacker;
+
+    // Mated, stalemated, or nothing left that could mate in time: the attacker has failed
+    if (attacking && moves.count == 0)
+    {
+        phi = INFINITE;
+        delta = 0;
+        return true;
+    }
+
+    if (!attacking && moves.count == 0 && position.inCheck())
+    {
+        phi = INFINITE;
+        delta = 0;
+        return true;
+    }
+
+    // Stalemate, or the defender is still standing when the moves run out
+    if (!attacking && (moves.count == 0 || movesLeft == 0))
+    {
+        phi = 0;
+        delta = INFINITE;
+        return true;
+    }
+    return false;
+}
+
+void Chess::MateSolver::generate(Position &position, int movesLeft, MoveList &moves) const
+{
+    position.generateLegal(moves);
+    if (position.sideToMove() != m_Attacker || movesLeft != 1)
+        return;
+
+    int count = 0;
+    for (int i = 0; i < moves.count; i++)
+    {
+        position.makeMove(moves.moves[i]);
+        if (position.inCheck())
+            moves.moves[count++] = moves.moves[i];
+        position.unmakeMove();
+    }
+    moves.count = count;
+}
+
+void Chess::MateSolver::lookup(std::uint64_t key, int movesLeft, std::uint32_t &phi, std::uint32_t &delta) const
+{
+    key ^= problemKey(movesLeft, m_Attacker);
+    const auto &slot = m_Table[key & (m_Table.size() - 1)];
+    if (slot.key == key)
+    {
+        phi = slot.phi;
+        delta = slot.delta;
+    }
+    else
+    {
+        phi = 1;
+        delta = 1;
+    }
+}
+
+void Chess::MateSolver::store(std::uint64_t key, int movesLeft, std::uint32_t phi, std::uint32_t delta)
+{
+    key ^= problemKey(movesLeft, m_Attacker);
+    m_Table[key & (m_Table.size() - 1)] = {key, phi, delta};
+}
+
+int Chess::MateSolver::mateDistance(Position &position, int movesLeft)
+{
+    for (int moves = 1; moves <= movesLeft; moves++)
+    {
+        if (prove(position, moves))
+            return moves;
+    }
+    return 0;
+}
+
+void Chess::MateSolver::extendLine(Position &position, int movesLeft, std::vector<PackedMove> &line)
+{
+    while (!m_Aborted)
+    {
+        // Defender: the reply that puts the mate off longest
+        MoveList replies;
+        position.generateLegal(replies);
+        if (replies.count == 0)
+            return;
+
+        PackedMove reply;
+        int longest = 0;
+        for (auto move : replies)
+        {
+            position.makeMove(move);
+            int distance = mateDistance(position, movesLeft);
+            position.unmakeMove();
+            if (distance > longest || reply.isNone())
+            {
+                longest = distance;
+                reply = move;
+            }
+        }
+        if (longest <= 0)
+            return;
+
+        position.makeMove(reply);
+        line.push_back(reply);
+        movesLeft = longest;
+
+        // Attacker: any move that keeps the mate on schedule
+        MoveList moves;
+        generate(position, movesLeft, moves);
+        auto next = std::find_if(moves.begin(), moves.end(), [&](PackedMove move)
+                                 {
+                                     position.makeMove(move);
+                                     bool mates = prove(position, movesLeft - 1);
+                                     position.unmakeMove();
+                                     return mates; });
+        if (next == moves.end())
+            return;
+
+        position.makeMove(*next);
+        line.push_back(*next);
+        movesLeft--;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "PackedMove.h"
+#include "Position.h"
+
+namespace Chess
+{
+    // Forced mate prover: depth-first proof-number search (df-pn) for the side to move.
+    // Every node is searched with the number of attacking moves left, so the proof is exactly
+    // "mate in N"; proof and disproof numbers are kept in an always-replace table keyed by
+    // position, moves left and attacker, so proofs carry over from one solve() to the next.
+    // solve() finds the shortest mate up to a limit, then proves that no other first move
+    // mates as fast. One instance per thread; only stop() may be called from another thread.
+    class MateSolver
+    {
+    public:
+        static constexpr std::size_t DEFAULT_TABLE_MB = 16;
+        static constexpr std::uint64_t DEFAULT_NODE_LIMIT = 5'000'000;
+
+        enum class Status
+        {
+            Mate,    // Forced mate in mateIn moves, and none shorter
+            NoMate,  // Proven: no forced mate within the move limit
+            Unknown, // Node limit reached or stopped
+        };
+
+        struct Result
+        {
+            Status status = Status::Unknown;
+            int mateIn = 0;
+            std::vector<PackedMove> keyMoves; // Every first move that mates in mateIn, the solution first
+            std::vector<PackedMove> line;     // Solution against the longest defence found
+            std::uint64_t nodes = 0;
+            std::int64_t timeMs = 0;
+
+            bool isUnique() const
+            {
+                return status == Status::Mate && keyMoves.size() == 1;
+            }
+        };
+
+    private:
+        struct Slot
+        {
+            std::uint64_t key; // 0 = empty
+            std::uint32_t phi;
+            std::uint32_t delta;
+        };
+
+        std::vector<Slot> m_Table;
+        int m_Attacker = 0;
+
+        std::uint64_t m_Nodes = 0;
+        std::uint64_t m_NodeLimit = 0;
+        std::atomic<bool> m_StopRequested = false;
+        bool m_Aborted = false;
+
+    public:
+        explicit MateSolver(std::size_t tableMegabytes = DEFAULT_TABLE_MB);
+
+        // Mate for the side to move in at most maxMoves moves
+        Result solve(const Position &position, int maxMoves, std::uint64_t nodeLimit = DEFAULT_NODE_LIMIT);
+
+        // Safe to call from another thread; solve() returns Unknown. A stop that arrives
+        // before solve() has started still applies to it.
+        void stop()
+        {
+            m_StopRequested = true;
+        }
+
+        // Drops a stop that arrived after the last solve() ended (only between solves)
+        void resetSignals()
+        {
+            m_StopRequested = false;
+        }
+
+    private:
+        // Whether the attacker mates within movesLeft moves (false once aborted)
+        bool prove(Position &position, int movesLeft);
+
+        // Proof-number search of one node until its numbers reach a threshold, from the point
+        // of view of the side to move: phi proves it wins, delta proves it doesn't
+        void search(Position &position, int movesLeft, std::uint32_t phiThreshold, std::uint32_t deltaThreshold);
+
+        // Numbers of a node without children to search, false for any other node
+        bool terminal(const Position &position, int movesLeft, const MoveList &moves, std::uint32_t &phi, std::uint32_t &delta) const;
+
+        // Attacker moves worth trying: only checks can mate on the last move
+        void generate(Position &position, int movesLeft, MoveList &moves) const;
+
+        void lookup(std::uint64_t key, int movesLeft, std::uint32_t &phi, std::uint32_t &delta) const;
+        void store(std::uint64_t key, int movesLeft, std::uint32_t phi, std::uint32_t delta);
+
+        // Fewest moves (up to movesLeft) the attacker to move needs to mate, 0 if none
+        int mateDistance(Position &position, int movesLeft);
+        // Appends the longest defence and the mate against it, from a defender node
+        void extendLine(Position &position, int movesLeft, std::vector<PackedMove> &line);
+    };
+}
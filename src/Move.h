@@ -1,26 +1,56 @@
 #pragma once
 
+#include <cctype>
+#include <cstdint>
+
 #include "Piece.h"
 
 namespace Chess
 {
+    // Compact history record (16 bytes): castling rook squares and the en passant
+    // victim are implied by from/to, so every move kind fits the same layout.
     struct Move
     {
-        int from;
-        int to;
+        enum Kind : std::uint8_t
+        {
+            Normal,
+            Castling,
+            EnPassant,
+            Promotion,
+        };
 
-        char movedPieceSymbol;
-        char otherPieceSymbol;
-    };
+        std::uint64_t key = 0;           // Position key after the move
+        std::uint16_t halfmoveClock = 0; // Plies since the last capture or pawn move, after the move
 
-    struct CastlingMove : public Move
-    {
-        int rookFrom;
-        int rookTo;
-    };
+        std::uint8_t from;
+        std::uint8_t to;
 
-    struct EnPassantMove : public Move
-    {
-        int enPassantTarget;
+        char movedPieceSymbol; // Promoted piece for promotions
+        char otherPieceSymbol; // Captured piece ('x' if none) or castling rook
+
+        Kind kind;
+        bool firstMove; // The moved piece had never moved before
+
+        int rookFrom() const
+        {
+            return to > from ? from + 3 : from - 4;
+        }
+
+        int rookTo() const
+        {
+            return to > from ? from + 1 : from - 1;
+        }
+
+        int enPassantTarget() const
+        {
+            return to + (std::isupper(movedPieceSymbol) ? -8 : 8);
+        }
+
+        bool isIrreversible() const
+        {
+            return halfmoveClock == 0;
+        }
     };
-}
\ No newline at end of file
+
+    static_assert(sizeof(Move) == 16);
+}
@@ -0,0 +1,175 @@
+#include "MovePicker.h"
+#include "Evaluation.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+// HISTORY
+
+void Chess::HistoryTable::update(int side, PackedMove move, int bonus)
+{
+    auto &score = m_Scores[side][move.from()][move.to()];
+    bonus = std::clamp(bonus, -MAX, MAX);
+    score = static_cast<std::int16_t>(score + bonus - score * std::abs(bonus) / MAX);
+}
+
+void Chess::HistoryTable::age()
+{
+    for (auto &from : m_Scores)
+    {
+        for (auto &to : from)
+        {
+            for (auto &score : to)
+                score = static_cast<std::int16_t>(score / 2);
+        }
+    }
+}
+
+// PICKER
+
+Chess::MovePicker::MovePicker(const Position &position, PackedMove hashMove, const std::array<PackedMove, 2> &killers, PackedMove counterMove, const HistoryTable &history)
+    : m_Position(position), m_History(history), m_HashMove(hashMove), m_Killers(killers), m_CounterMove(counterMove)
+{
+    if (!m_HashMove.isNone() && !position.isPseudoLegal(m_HashMove))
+        m_HashMove = {};
+}
+
+Chess::MovePicker::MovePicker(const Position &position, const HistoryTable &history)
+    : m_Position(position), m_History(history), m_Killers{}, m_Stage(Stage::GenerateCaptures), m_CapturesOnly(true)
+{
+}
+
+Chess::PackedMove Chess::MovePicker::next()
+{
+    switch (m_Stage)
+    {
+    case Stage::HashMove:
+        m_Stage = Stage::GenerateCaptures;
+        if (!m_HashMove.isNone())
+            return m_HashMove;
+        [[fallthrough]];
+
+    case Stage::GenerateCaptures:
+        m_Position.generate(m_Moves, Position::Generate::Captures);
+        scoreCaptures();
+        m_Stage = Stage::Captures;
+        [[fallthrough]];
+
+    case Stage::Captures:
+        while (m_Current < m_Moves.count)
+        {
+            auto move = pickBest();
+            if (move == m_HashMove)
+                continue;
+
+            // Only computed for captures actually reached
+            if (m_Position.see(move) < 0)
+            {
+                std::swap(m_Moves.moves[m_BadCaptures++], m_Moves.moves[m_Current - 1]);
+                continue;
+            }
+            return move;
+        }
+        if (m_CapturesOnly)
+        {
+            m_Stage = Stage::Done;
+            break;
+        }
+        m_Stage = Stage::Killers;
+        [[fallthrough]];
+
+    case Stage::Killers:
+        while (m_KillerIndex < 2)
+        {
+            auto killer = m_Killers[m_KillerIndex++];
+            if (!killer.isNone() && killer != m_HashMove && isQuiet(m_Position, killer) && m_Position.isPseudoLegal(killer))
+                return killer;
+            m_Killers[m_KillerIndex - 1] = {}; // Not played: must not be skipped among the quiets
+        }
+        m_Stage = Stage::CounterMove;
+        [[fallthrough]];
+
+    case Stage::CounterMove:
+        m_Stage = Stage::GenerateQuiets;
+        if (!m_CounterMove.isNone() && m_CounterMove != m_HashMove && m_CounterMove != m_Killers[0] && m_CounterMove != m_Killers[1] &&
+            isQuiet(m_Position, m_CounterMove) && m_Position.isPseudoLegal(m_CounterMove))
+            return m_CounterMove;
+        m_CounterMove = {};
+        [[fallthrough]];
+
+    case Stage::GenerateQuiets:
+        // Appended behind the captures, which keeps the losing ones for later
+        m_Position.generate(m_Moves, Position::Generate::Quiets);
+        scoreQuiets();
+        m_Stage = Stage::Quiets;
+        [[fallthrough]];
+
+    case Stage::Quiets:
+        while (m_Current < m_Moves.count)
+        {
+            auto move = pickBest();
+            if (!isTableMove(move))
+                return move;
+        }
+        m_Current = 0;
+        m_Stage = Stage::BadCaptures;
+        [[fallthrough]];
+
+    case Stage::BadCaptures:
+        if (m_Current < m_BadCaptures)
+            return m_Moves.moves[m_Current++];
+        m_Stage = Stage::Done;
+        [[fallthrough]];
+
+    case Stage::Done:
+        break;
+    }
+
+    return {};
+}
+
+void Chess::MovePicker::scoreCaptures()
+{
+    // Least valuable attacker first among equal victims (the king last)
+    constexpr std::array<int, 7> ATTACKER_ORDER = {0, 0, 3, 1, 2, 4, 5};
+
+    for (int i = 0; i < m_Moves.count; i++)
+    {
+        auto move = m_Moves.moves[i];
+        int victim = move.kind() == PackedMove::EnPassant ? PieceType::Pawn : m_Position.pieceAt(move.to()) & 7;
+        int score = Evaluation::PIECE_VALUES[victim] * 8 - ATTACKER_ORDER[m_Position.pieceAt(move.from()) & 7];
+
+        // Queen promotions rank with the best captures, underpromotions after every capture
+        if (move.kind() == PackedMove::Promotion)
+            score += move.promotionType() == PieceType::Queen ? Evaluation::PIECE_VALUES[PieceType::Queen] * 8 : -Evaluation::PIECE_VALUES[PieceType::Queen] * 16;
+
+        m_Scores[i] = score;
+    }
+}
+
+void Chess::MovePicker::scoreQuiets()
+{
+    int side = m_Position.sideToMove();
+    for (int i = m_Current; i < m_Moves.count; i++)
+        m_Scores[i] = m_History.get(side, m_Moves.moves[i]);
+}
+
+Chess::PackedMove Chess::MovePicker::pickBest()
+{
+    // Selection, not a full sort: most nodes only need the first move or two
+    int best = m_Current;
+    for (int i = m_Current + 1; i < m_Moves.count; i++)
+    {
+        if (m_Scores[i] > m_Scores[best])
+            best = i;
+    }
+
+    std::swap(m_Moves.moves[best], m_Moves.moves[m_Current]);
+    std::swap(m_Scores[best], m_Scores[m_Current]);
+    return m_Moves.moves[m_Current++];
+}
+
+bool Chess::MovePicker::isTableMove(PackedMove move) const
+{
+    return move == m_HashMove || move == m_Killers[0] || move == m_Killers[1] || move == m_CounterMove;
+}
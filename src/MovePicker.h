@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "PackedMove.h"
+#include "Position.h"
+
+namespace Chess
+{
+    // Quiet move scores by side, from and to square. Updates pull values towards the bonus
+    // ("gravity"), so they stay within +/-MAX without periodic rescaling.
+    class HistoryTable
+    {
+    public:
+        static constexpr int MAX = 16384;
+
+    private:
+        std::array<std::array<std::array<std::int16_t, 64>, 64>, 2> m_Scores{};
+
+    public:
+        int get(int side, PackedMove move) const
+        {
+            return m_Scores[side][move.from()][move.to()];
+        }
+
+        // Positive for a move that caused a cutoff, negative for those tried before it
+        void update(int side, PackedMove move, int bonus);
+
+        // Halves every score, so older searches weigh less
+        void age();
+
+        void clear()
+        {
+            m_Scores = {};
+        }
+    };
+
+    // Hands out the moves of a position one at a time, best guesses first: hash move,
+    // winning and equal captures (MVV-LVA), killers, counter move, quiets by history, and
+    // captures that lose material (SEE) last. Each stage is generated only when the previous
+    // ones didn't produce a cutoff. Moves are pseudo-legal: the caller still checks Position::isLegal.
+    class MovePicker
+    {
+    public:
+        enum class Stage
+        {
+            HashMove,
+            GenerateCaptures,
+            Captures,
+            Killers,
+            CounterMove,
+            GenerateQuiets,
+            Quiets,
+            BadCaptures,
+            Done,
+        };
+
+    private:
+        const Position &m_Position;
+        const HistoryTable &m_History;
+
+        PackedMove m_HashMove;
+        std::array<PackedMove, 2> m_Killers;
+        PackedMove m_CounterMove;
+
+        Stage m_Stage = Stage::HashMove;
+        int m_KillerIndex = 0;
+        bool m_CapturesOnly = false;
+
+        // Losing captures are moved to the front as they come up: [0, m_BadCaptures)
+        MoveList m_Moves;
+        std::array<int, 256> m_Scores;
+        int m_Current = 0;
+        int m_BadCaptures = 0;
+
+    public:
+        // Table moves may come from other positions: they are only played if pseudo-legal here
+        MovePicker(const Position &position, PackedMove hashMove, const std::array<PackedMove, 2> &killers, PackedMove counterMove, const HistoryTable &history);
+
+        // Quiescence search: only captures and promotions that don't lose material
+        MovePicker(const Position &position, const HistoryTable &history);
+
+        // No move once everything was returned
+        PackedMove next();
+
+        Stage stage() const
+        {
+            return m_Stage;
+        }
+
+        // Neither a capture nor a promotion
+        static bool isQuiet(const Position &position, PackedMove move)
+        {
+            return !position.isCapture(move) && move.kind() != PackedMove::Promotion;
+        }
+
+    private:
+        void scoreCaptures();
+        void scoreQuiets();
+
+        // Highest scored of the remaining generated moves
+        PackedMove pickBest();
+
+        // Already returned by the hash, killer or counter move stage
+        bool isTableMove(PackedMove move) const;
+    };
+}
@@ -1,7 +1,12 @@
 #include "Chess.h"
+#include "Bitboard.h"
 
 void Chess::Game::calculatePossibleMoves(int index)
 {
+    CHESS_PROFILE_PROBE(CalculatePossibleMoves);
+    CHESS_TRACE_SCOPE("Game::calculatePossibleMoves");
+    CHESS_NO_ALLOC_SCOPE("calculatePossibleMoves", Log);
+
     m_PossibleMoves.clear();
 
     switch (m_Pieces[index]->getType())
@@ -54,6 +59,16 @@ void Chess::Game::addMovesInDirection(int startFile, int startRank, int fileIncr
     }
 }
 
+bool Chess::Game::isPathClear(int from, int to) const
+{
+    for (auto path = Bitboards::BETWEEN[from][to]; path;)
+    {
+        if (m_Pieces[Bitboards::popLsb(path)] != nullptr)
+            return false;
+    }
+    return true;
+}
+
 void Chess::Game::calculatePawnMoves(int index)
 {
     auto pawn = m_Pieces[index];
@@ -79,45 +94,31 @@ void Chess::Game::calculatePawnMoves(int index)
         }
     }
 
-    // En passant
-    if (startRank == (pawn->getColor() == Piece::Color::White ? 4 : 3))
+    // Captures (diagonals off the board are already excluded by the attack table)
+    int colorIndex = pawn->getColor() == Piece::Color::White ? 0 : 1;
+    int enPassantRank = pawn->getColor() == Piece::Color::White ? 5 : 2;
+
+    for (auto targets = Bitboards::PAWN_ATTACKS[colorIndex][index]; targets;)
     {
-        int leftFile = startFile - 1;
-        int rightFile = startFile + 1;
-        int enPassantRank = startRank + dir;
-
-        if (leftFile >= 0 && m_Pieces[fileRankToIndex(leftFile, startRank)] != nullptr &&
-            m_Pieces[fileRankToIndex(leftFile, startRank)]->getType() == Piece::Type::Pawn &&
-            m_Pieces[fileRankToIndex(leftFile, startRank)]->getColor() != pawn->getColor() &&
-            m_Pieces[fileRankToIndex(leftFile, startRank)]->isEnPassantVulnerable())
+        int targetIndex = Bitboards::popLsb(targets);
+        auto target = m_Pieces[targetIndex];
+
+        if (target != nullptr)
         {
-            m_PossibleMoves.push_back(fileRankToIndex(leftFile, enPassantRank));
+            if (target->getColor() != pawn->getColor())
+                m_PossibleMoves.push_back(targetIndex);
         }
-
-        if (rightFile < 8 && m_Pieces[fileRankToIndex(rightFile, startRank)] != nullptr &&
-            m_Pieces[fileRankToIndex(rightFile, startRank)]->getType() == Piece::Type::Pawn &&
-            m_Pieces[fileRankToIndex(rightFile, startRank)]->getColor() != pawn->getColor() &&
-            m_Pieces[fileRankToIndex(rightFile, startRank)]->isEnPassantVulnerable())
+        else if (indexToRank(targetIndex) == enPassantRank)
         {
-            m_PossibleMoves.push_back(fileRankToIndex(rightFile, enPassantRank));
+            // En passant: the pawn that just passed stands beside us
+            auto passed = m_Pieces[targetIndex - dir * 8];
+            if (passed != nullptr && passed->getType() == Piece::Type::Pawn &&
+                passed->getColor() != pawn->getColor() && passed->isEnPassantVulnerable())
+            {
+                m_PossibleMoves.push_back(targetIndex);
+            }
         }
     }
-
-    // Capture diagonally
-    int captureLeftIndex = fileRankToIndex(startFile - 1, startRank + dir);
-    int captureRightIndex = fileRankToIndex(startFile + 1, startRank + dir);
-
-    if (startFile > 0 && isValidIndex(captureLeftIndex) && m_Pieces[captureLeftIndex] != nullptr &&
-        m_Pieces[captureLeftIndex]->getColor() != pawn->getColor())
-    {
-        m_PossibleMoves.push_back(captureLeftIndex);
-    }
-
-    if (startFile < 7 && isValidIndex(captureRightIndex) && m_Pieces[captureRightIndex] != nullptr &&
-        m_Pieces[captureRightIndex]->getColor() != pawn->getColor())
-    {
-        m_PossibleMoves.push_back(captureRightIndex);
-    }
 }
 
 void Chess::Game::calculateRookMoves(int index)
@@ -136,22 +137,13 @@ void Chess::Game::calculateRookMoves(int index)
 void Chess::Game::calculateKnightMoves(int index)
 {
     auto knight = m_Pieces[index];
-    int startFile = indexToFile(index);
-    int startRank = indexToRank(index);
-
-    std::array<std::pair<int, int>, 8> knightMoves = {{{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}}};
 
-    for (const auto &move : knightMoves)
+    for (auto targets = Bitboards::KNIGHT_ATTACKS[index]; targets;)
     {
-        int file = startFile + move.first;
-        int rank = startRank + move.second;
-        if (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+        int targetIndex = Bitboards::popLsb(targets);
+        if (m_Pieces[targetIndex] == nullptr || m_Pieces[targetIndex]->getColor() != knight->getColor())
         {
-            int targetIndex = fileRankToIndex(file, rank);
-            if (m_Pieces[targetIndex] == nullptr || m_Pieces[targetIndex]->getColor() != knight->getColor())
-            {
-                m_PossibleMoves.push_back(targetIndex);
-            }
+            m_PossibleMoves.push_back(targetIndex);
         }
     }
 }
@@ -192,19 +184,12 @@ void Chess::Game::calculateKingMoves(int index)
     int startFile = indexToFile(index);
     int startRank = indexToRank(index);
 
-    std::array<std::pair<int, int>, 8> kingMoves = {{{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}}};
-
-    for (const auto &move : kingMoves)
+    for (auto targets = Bitboards::KING_ATTACKS[index]; targets;)
     {
-        int file = startFile + move.first;
-        int rank = startRank + move.second;
-        if (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+        int targetIndex = Bitboards::popLsb(targets);
+        if (m_Pieces[targetIndex] == nullptr || m_Pieces[targetIndex]->getColor() != king->getColor())
         {
-            int targetIndex = fileRankToIndex(file, rank);
-            if (m_Pieces[targetIndex] == nullptr || m_Pieces[targetIndex]->getColor() != king->getColor())
-            {
-                m_PossibleMoves.push_back(targetIndex);
-            }
+            m_PossibleMoves.push_back(targetIndex);
         }
     }
 
@@ -216,16 +201,7 @@ void Chess::Game::calculateKingMoves(int index)
             m_Pieces[fileRankToIndex(7, startRank)]->getType() == Piece::Type::Rook &&
             !m_Pieces[fileRankToIndex(7, startRank)]->hasMoved())
         {
-            bool pathClear = true;
-            for (int i = startFile + 1; i < 7; ++i)
-            {
-                if (m_Pieces[fileRankToIndex(i, startRank)] != nullptr)
-                {
-                    pathClear = false;
-                    break;
-                }
-            }
-            if (pathClear)
+            if (isPathClear(index, fileRankToIndex(7, startRank)))
             {
                 m_PossibleMoves.push_back(fileRankToIndex(startFile + 2, startRank));
             }
@@ -236,16 +212,7 @@ void Chess::Game::calculateKingMoves(int index)
             m_Pieces[fileRankToIndex(0, startRank)]->getType() == Piece::Type::Rook &&
             !m_Pieces[fileRankToIndex(0, startRank)]->hasMoved())
         {
-            bool pathClear = true;
-            for (int i = startFile - 1; i > 0; --i)
-            {
-                if (m_Pieces[fileRankToIndex(i, startRank)] != nullptr)
-                {
-                    pathClear = false;
-                    break;
-                }
-            }
-            if (pathClear)
+            if (isPathClear(index, fileRankToIndex(0, startRank)))
             {
                 m_PossibleMoves.push_back(fileRankToIndex(startFile - 2, startRank));
             }
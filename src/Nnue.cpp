@@ -0,0 +1,296 @@
+#include "Nnue.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CHESS_NNUE_X86 1
+#include <immintrin.h>
+#endif
+
+// KERNELS
+
+namespace
+{
+    using UpdateKernel = void (*)(std::int16_t *, const std::int16_t *const *, int, const std::int16_t *const *, int);
+    using OutputKernel = std::int32_t (*)(const std::int16_t *, const std::int16_t *, const std::int16_t *);
+
+    using namespace Chess::Nnue;
+
+    void updateScalar(std::int16_t *accumulator, const std::int16_t *const *added, int addedCount, const std::int16_t *const *removed, int removedCount)
+    {
+        for (int i = 0; i < HIDDEN; i++)
+        {
+            // Wraps modulo 2^16 exactly like the 16-bit SIMD lanes
+            int value = accumulator[i];
+            for (int a = 0; a < addedCount; a++)
+                value += added[a][i];
+            for (int r = 0; r < removedCount; r++)
+                value -= removed[r][i];
+            accumulator[i] = static_cast<std::int16_t>(value);
+        }
+    }
+
+    std::int32_t outputScalar(const std::int16_t *us, const std::int16_t *them, const std::int16_t *weights)
+    {
+        std::int32_t sum = 0;
+        for (int i = 0; i < HIDDEN; i++)
+        {
+            sum += std::clamp<std::int32_t>(us[i], 0, CLIP) * weights[i];
+            sum += std::clamp<std::int32_t>(them[i], 0, CLIP) * weights[HIDDEN + i];
+        }
+        return sum;
+    }
+
+#ifdef CHESS_NNUE_X86
+    __attribute__((target("avx2"))) void updateAvx2(std::int16_t *accumulator, const std::int16_t *const *added, int addedCount, const std::int16_t *const *removed, int removedCount)
+    {
+        for (int i = 0; i < HIDDEN; i += 16)
+        {
+            auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(accumulator + i));
+            for (int a = 0; a < addedCount; a++)
+                value = _mm256_add_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(added[a] + i)));
+            for (int r = 0; r < removedCount; r++)
+                value = _mm256_sub_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(removed[r] + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(accumulator + i), value);
+        }
+    }
+
+    __attribute__((target("avx2"))) std::int32_t outputAvx2(const std::int16_t *us, const std::int16_t *them, const std::int16_t *weights)
+    {
+        const auto zero = _mm256_setzero_si256();
+        const auto clip = _mm256_set1_epi16(CLIP);
+
+        auto sum = _mm256_setzero_si256();
+        for (int i = 0; i < HIDDEN; i += 16)
+        {
+            auto a = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(us + i)), zero), clip);
+            auto b = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(them + i)), zero), clip);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i))));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(b, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + HIDDEN + i))));
+        }
+
+        auto half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+        return _mm_cvtsi128_si32(half);
+    }
+
+    __attribute__((target("avx512f,avx512bw"))) void updateAvx512(std::int16_t *accumulator, const std::int16_t *const *added, int addedCount, const std::int16_t *const *removed, int removedCount)
+    {
+        for (int i = 0; i < HIDDEN; i += 32)
+        {
+            auto value = _mm512_loadu_si512(accumulator + i);
+            for (int a = 0; a < addedCount; a++)
+                value = _mm512_add_epi16(value, _mm512_loadu_si512(added[a] + i));
+            for (int r = 0; r < removedCount; r++)
+                value = _mm512_sub_epi16(value, _mm512_loadu_si512(removed[r] + i));
+            _mm512_storeu_si512(accumulator + i, value);
+        }
+    }
+
+    __attribute__((target("avx512f,avx512bw"))) std::int32_t outputAvx512(const std::int16_t *us, const std::int16_t *them, const std::int16_t *weights)
+    {
+        const auto zero = _mm512_setzero_si512();
+        const auto clip = _mm512_set1_epi16(CLIP);
+
+        auto sum = _mm512_setzero_si512();
+        for (int i = 0; i < HIDDEN; i += 32)
+        {
+            auto a = _mm512_min_epi16(_mm512_max_epi16(_mm512_loadu_si512(us + i), zero), clip);
+            auto b = _mm512_min_epi16(_mm512_max_epi16(_mm512_loadu_si512(them + i), zero), clip);
+            sum = _mm512_add_epi32(sum, _mm512_madd_epi16(a, _mm512_loadu_si512(weights + i)));
+            sum = _mm512_add_epi32(sum, _mm512_madd_epi16(b, _mm512_loadu_si512(weights + HIDDEN + i)));
+        }
+        alignas(64) std::int32_t lanes[16];
+        _mm512_store_si512(lanes, sum);
+
+        std::int32_t total = 0;
+        for (auto lane : lanes)
+            total += lane;
+        return total;
+    }
+#endif
+
+    bool supports(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case Kernel::Scalar:
+            return true;
+#ifdef CHESS_NNUE_X86
+        case Kernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+        case Kernel::Avx512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+        default:
+            return false;
+        }
+    }
+
+    struct Kernels
+    {
+        Kernel kernel;
+        UpdateKernel update;
+        OutputKernel output;
+    };
+
+    Kernels kernelsFor(Kernel kernel)
+    {
+        switch (kernel)
+        {
+#ifdef CHESS_NNUE_X86
+        case Kernel::Avx2:
+            return {kernel, updateAvx2, outputAvx2};
+        case Kernel::Avx512:
+            return {kernel, updateAvx512, outputAvx512};
+#endif
+        default:
+            return {Kernel::Scalar, updateScalar, outputScalar};
+        }
+    }
+
+    Kernels selectKernels()
+    {
+#ifdef CHESS_NNUE_X86
+        __builtin_cpu_init(); // Runs during static initialization
+#endif
+        for (auto kernel : {Kernel::Avx512, Kernel::Avx2})
+        {
+            if (supports(kernel))
+                return kernelsFor(kernel);
+        }
+        return kernelsFor(Kernel::Scalar);
+    }
+
+    Kernels s_Kernels = selectKernels();
+}
+
+Chess::Nnue::Kernel Chess::Nnue::activeKernel()
+{
+    return s_Kernels.kernel;
+}
+
+bool Chess::Nnue::setKernel(Kernel kernel)
+{
+    if (!supports(kernel))
+        return false;
+
+    s_Kernels = kernelsFor(kernel);
+    return true;
+}
+
+const char *Chess::Nnue::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Kernel::Avx2:
+        return "AVX2";
+    case Kernel::Avx512:
+        return "AVX-512";
+    default:
+        return "scalar";
+    }
+}
+
+void Chess::Nnue::updateRows(std::int16_t *accumulator, const std::int16_t *const *added, int addedCount, const std::int16_t *const *removed, int removedCount)
+{
+    s_Kernels.update(accumulator, added, addedCount, removed, removedCount);
+}
+
+// NETWORK
+
+Chess::Nnue::Network &Chess::Nnue::defaultNetwork()
+{
+    static Network network;
+    return network;
+}
+
+bool Chess::Nnue::Network::load(const std::string &path)
+{
+    MappedFile file;
+    if (!file.open(path) || file.size() != FILE_SIZE)
+        return false;
+
+    std::uint32_t header[4];
+    std::memcpy(header, file.data(), sizeof(header));
+    if (std::memcmp(header, "CHNN", 4) != 0 || header[1] != VERSION || header[2] != FEATURES || header[3] != HIDDEN)
+        return false;
+
+    // The weights are used straight from the mapping
+    auto weights = reinterpret_cast<const std::int16_t *>(file.data() + HEADER_SIZE);
+    m_FeatureBiases = weights;
+    m_FeatureWeights = m_FeatureBiases + HIDDEN;
+    m_OutputWeights = m_FeatureWeights + std::size_t(FEATURES) * HIDDEN;
+    std::memcpy(&m_OutputBias, m_OutputWeights + 2 * HIDDEN, sizeof(m_OutputBias));
+
+    m_File = std::move(file);
+    m_Path = path;
+    return true;
+}
+
+void Chess::Nnue::Network::refresh(Accumulator &accumulator, int perspective, const std::array<std::uint8_t, 64> &board) const
+{
+    int kingSquare = -1;
+    std::array<const std::int16_t *, 32> rows;
+    int rowCount = 0;
+
+    for (int square = 0; square < 64; square++)
+    {
+        if ((board[square] & 7) == 6 && (board[square] >> 3) == perspective)
+            kingSquare = square;
+    }
+
+    for (int square = 0; square < 64 && kingSquare != -1; square++)
+    {
+        int code = board[square];
+        if (code == 0 || (code & 7) == 6 || rowCount == static_cast<int>(rows.size()))
+            continue;
+        rows[rowCount++] = featureWeights(featureIndex(perspective, kingSquare, code, square));
+    }
+
+    auto &values = accumulator.values[perspective];
+    std::memcpy(values.data(), m_FeatureBiases, sizeof(values));
+    s_Kernels.update(values.data(), rows.data(), rowCount, nullptr, 0);
+}
+
+int Chess::Nnue::Network::update(Accumulator &accumulator, const std::array<int, 2> &kingSquares, const DirtyPieces &dirty) const
+{
+    int needsRefresh = 0;
+    for (int i = 0; i < dirty.count; i++)
+    {
+        if ((dirty.piece[i] & 7) == 6)
+            needsRefresh |= 1 << (dirty.piece[i] >> 3);
+    }
+
+    for (int perspective = 0; perspective < 2; perspective++)
+    {
+        if (needsRefresh & (1 << perspective))
+            continue;
+
+        std::array<const std::int16_t *, 3> added, removed;
+        int addedCount = 0, removedCount = 0;
+
+        for (int i = 0; i < dirty.count; i++)
+        {
+            if ((dirty.piece[i] & 7) == 6)
+                continue; // The opponent's king is not a feature
+
+            if (dirty.from[i] != -1)
+                removed[removedCount++] = featureWeights(featureIndex(perspective, kingSquares[perspective], dirty.piece[i], dirty.from[i]));
+            if (dirty.to[i] != -1)
+                added[addedCount++] = featureWeights(featureIndex(perspective, kingSquares[perspective], dirty.piece[i], dirty.to[i]));
+        }
+
+        s_Kernels.update(accumulator.values[perspective].data(), added.data(), addedCount, removed.data(), removedCount);
+    }
+
+    return needsRefresh;
+}
+
+int Chess::Nnue::Network::evaluate(const Accumulator &accumulator, int sideToMove) const
+{
+    std::int64_t sum = s_Kernels.output(accumulator.values[sideToMove].data(), accumulator.values[sideToMove ^ 1].data(), m_OutputWeights);
+    return static_cast<int>((sum + m_OutputBias) * EVAL_SCALE / (CLIP * OUTPUT_QUANT));
+}
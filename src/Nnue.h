@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.h"
+
+namespace Chess::Nnue
+{
+    // HalfKP network: every non-king piece is a feature relative to each side's king square,
+    // feeding a 256-wide int16 accumulator per perspective, then a clipped ReLU and one output.
+    //
+    // File layout (little-endian, mapped as is):
+    //   char magic[4] = "CHNN", uint32 version, uint32 features, uint32 hidden
+    //   int16 featureBiases[HIDDEN]
+    //   int16 featureWeights[FEATURES][HIDDEN]
+    //   int16 outputWeights[2][HIDDEN]   (side to move first)
+    //   int32 outputBias
+
+    constexpr std::uint32_t VERSION = 1;
+    constexpr int PIECE_KINDS = 10; // Pawn..Queen x (own, their)
+    constexpr int FEATURES = 64 * PIECE_KINDS * 64;
+    constexpr int HIDDEN = 256;
+
+    // Quantization: activations are clipped to [0, CLIP], so every dot product fits an int32
+    // (CLIP * 32768 * 2 * HIDDEN < 2^31) and every kernel gives bit-identical results
+    constexpr int CLIP = 127;
+    constexpr int OUTPUT_QUANT = 64;
+    constexpr int EVAL_SCALE = 400;
+
+    constexpr std::size_t HEADER_SIZE = 16;
+    constexpr std::size_t FILE_SIZE = HEADER_SIZE + sizeof(std::int16_t) * (HIDDEN + std::size_t(FEATURES) * HIDDEN + 2 * HIDDEN) + sizeof(std::int32_t);
+
+    // Perspective 0 = White, 1 = Black; piece codes use the Piece descriptor bits (color | type)
+    constexpr int featureIndex(int perspective, int kingSquare, int pieceCode, int square)
+    {
+        int flip = perspective == 0 ? 0 : 56; // Black sees the board upside down
+        int kind = ((pieceCode & 7) - 1) * 2 + ((pieceCode >> 3) != perspective);
+        return ((kingSquare ^ flip) * PIECE_KINDS + kind) * 64 + (square ^ flip);
+    }
+
+    struct alignas(64) Accumulator
+    {
+        std::array<std::array<std::int16_t, HIDDEN>, 2> values;
+    };
+
+    // Pieces that changed squares in one move (castling moves two, a capture removes a third)
+    struct DirtyPieces
+    {
+        int count = 0;
+        std::array<int, 3> piece{};
+        std::array<int, 3> from{}; // -1 when the piece appears
+        std::array<int, 3> to{};   // -1 when the piece disappears
+
+        void add(int pieceCode, int fromSquare, int toSquare)
+        {
+            piece[count] = pieceCode;
+            from[count] = fromSquare;
+            to[count] = toSquare;
+            count++;
+        }
+    };
+
+    enum class Kernel
+    {
+        Scalar,
+        Avx2,
+        Avx512,
+    };
+
+    class Network
+    {
+    private:
+        MappedFile m_File;
+
+        // Views into the mapping
+        const std::int16_t *m_FeatureBiases = nullptr;
+        const std::int16_t *m_FeatureWeights = nullptr;
+        const std::int16_t *m_OutputWeights = nullptr;
+        std::int32_t m_OutputBias = 0;
+
+        std::string m_Path;
+
+    public:
+        // Returns false (and keeps the previous network) if the file is missing or malformed
+        bool load(const std::string &path);
+
+        bool isLoaded() const
+        {
+            return m_FeatureWeights != nullptr;
+        }
+
+        const std::string &path() const
+        {
+            return m_Path;
+        }
+
+        // Recomputes one perspective from scratch; board holds a piece code per square (0 = empty)
+        void refresh(Accumulator &accumulator, int perspective, const std::array<std::uint8_t, 64> &board) const;
+
+        // Applies one move to both perspectives. A king move changes every feature of its own
+        // perspective: that side is skipped and its bit (1 << perspective) is returned for a refresh.
+        int update(Accumulator &accumulator, const std::array<int, 2> &kingSquares, const DirtyPieces &dirty) const;
+
+        // Centipawns from the point of view of the side to move (0 = White, 1 = Black)
+        int evaluate(const Accumulator &accumulator, int sideToMove) const;
+
+        const std::int16_t *featureWeights(int feature) const
+        {
+            return m_FeatureWeights + std::size_t(feature) * HIDDEN;
+        }
+
+        const std::int16_t *featureBiases() const
+        {
+            return m_FeatureBiases;
+        }
+    };
+
+    // Process-wide network shared by the game and every search thread
+    Network &defaultNetwork();
+
+    // SIMD kernels are picked at start-up from the CPU features; setKernel can force a
+    // lower one (returns false if the CPU does not support it)
+    Kernel activeKernel();
+    bool setKernel(Kernel kernel);
+    const char *kernelName(Kernel kernel);
+
+    // Accumulator row arithmetic shared with the batch evaluator:
+    // accumulator += sum(added rows) - sum(removed rows)
+    void updateRows(std::int16_t *accumulator, const std::int16_t *const *added, int addedCount, const std::int16_t *const *removed, int removedCount);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace Chess
+{
+    // 16-bit move used by the headless engine: from (6 bits) | to (6 bits) | kind (2 bits) | promotion (2 bits).
+    // Castling is encoded as the king move (e1g1, e1c1, ...), en passant by its destination square.
+    class PackedMove
+    {
+    public:
+        enum Kind : std::uint8_t
+        {
+            Normal,
+            Promotion,
+            EnPassant,
+            Castling,
+        };
+
+    private:
+        std::uint16_t m_Value = 0;
+
+        // Promotion field to piece type (Knight, Bishop, Rook, Queen)
+        static constexpr std::array<int, 4> PROMOTION_TYPES = {3, 4, 2, 5};
+
+    public:
+        constexpr PackedMove() = default;
+
+        constexpr PackedMove(int from, int to, Kind kind = Normal, int promotionType = 5)
+        {
+            int promotion = promotionType == 3 ? 0 : promotionType == 4 ? 1
+                                                 : promotionType == 2   ? 2
+                                                                        : 3;
+            m_Value = static_cast<std::uint16_t>(from | (to << 6) | (kind << 12) | (promotion << 14));
+        }
+
+        static constexpr PackedMove fromRaw(std::uint16_t value)
+        {
+            PackedMove move;
+            move.m_Value = value;
+            return move;
+        }
+
+        constexpr std::uint16_t raw() const
+        {
+            return m_Value;
+        }
+
+        constexpr int from() const
+        {
+            return m_Value & 63;
+        }
+
+        constexpr int to() const
+        {
+            return (m_Value >> 6) & 63;
+        }
+
+        constexpr Kind kind() const
+        {
+            return static_cast<Kind>((m_Value >> 12) & 3);
+        }
+
+        // Piece type a pawn promotes to (only meaningful for Kind::Promotion)
+        constexpr int promotionType() const
+        {
+            return PROMOTION_TYPES[m_Value >> 14];
+        }
+
+        // The null move (a1a1) doubles as "no move"
+        constexpr bool isNone() const
+        {
+            return m_Value == 0;
+        }
+
+        constexpr bool operator==(const PackedMove &) const = default;
+
+        // Long algebraic notation (e2e4, e7e8q), "0000" for no move
+        std::string toUci() const
+        {
+            if (isNone())
+                return "0000";
+
+            std::string uci = {
+                static_cast<char>('a' + from() % 8),
+                static_cast<char>('1' + from() / 8),
+                static_cast<char>('a' + to() % 8),
+                static_cast<char>('1' + to() / 8),
+            };
+            if (kind() == Promotion)
+                uci += " prnbqk"[promotionType()];
+            return uci;
+        }
+    };
+
+    static_assert(sizeof(PackedMove) == 2);
+
+    // Fixed capacity list (no legal position has more than 218 moves)
+    struct MoveList
+    {
+        std::array<PackedMove, 256> moves;
+        int count = 0;
+
+        void add(PackedMove move)
+        {
+            moves[count++] = move;
+        }
+
+        PackedMove *begin()
+        {
+            return moves.data();
+        }
+
+        PackedMove *end()
+        {
+            return moves.data() + count;
+        }
+
+        const PackedMove *begin() const
+        {
+            return moves.data();
+        }
+
+        const PackedMove *end() const
+        {
+            return moves.data() + count;
+        }
+
+        int size() const
+        {
+            return count;
+        }
+    };
+}
@@ -0,0 +1,199 @@
+#include "PackedPosition.h"
+
+#include <bit>
+#include <cctype>
+#include <charconv>
+
+namespace
+{
+    constexpr std::string_view PIECE_SYMBOLS = " PRNBQK  prnbqk";
+
+    int symbolToCode(char symbol)
+    {
+        auto index = PIECE_SYMBOLS.find(symbol);
+        return (index == std::string_view::npos || symbol == ' ') ? 0 : static_cast<int>(index);
+    }
+
+    // Next space separated field, "" once the input is exhausted
+    std::string_view nextField(std::string_view &fen)
+    {
+        while (!fen.empty() && fen.front() == ' ')
+            fen.remove_prefix(1);
+
+        auto end = fen.find(' ');
+        auto field = fen.substr(0, end);
+        fen.remove_prefix(field.size());
+        return field;
+    }
+}
+
+bool Chess::PackedPosition::fromFen(std::string_view fen, PackedPosition &out)
+{
+    std::array<std::uint8_t, 64> board{};
+
+    // Piece placement, from a8 to h1
+    auto placement = nextField(fen);
+    int file = 0, rank = 7, count = 0;
+    for (auto symbol : placement)
+    {
+        if (symbol == '/')
+        {
+            if (file != 8 || rank == 0)
+                return false;
+            file = 0;
+            rank--;
+        }
+        else if (symbol >= '1' && symbol <= '8')
+        {
+            file += symbol - '0';
+            if (file > 8)
+                return false;
+        }
+        else
+        {
+            int code = symbolToCode(symbol);
+            if (code == 0 || file > 7 || ++count > 32)
+                return false;
+            board[rank * 8 + file++] = static_cast<std::uint8_t>(code);
+        }
+    }
+    if (rank != 0 || file != 8)
+        return false;
+
+    // Game info (missing trailing fields take their defaults)
+    auto turn = nextField(fen);
+    if (turn != "" && turn != "w" && turn != "b")
+        return false;
+
+    int castling = 0;
+    for (auto right : nextField(fen))
+    {
+        switch (right)
+        {
+        case 'K':
+            castling |= 1;
+            break;
+        case 'Q':
+            castling |= 2;
+            break;
+        case 'k':
+            castling |= 4;
+            break;
+        case 'q':
+            castling |= 8;
+            break;
+        case '-':
+            break;
+        default:
+            return false;
+        }
+    }
+
+    int enPassant = -1;
+    auto epField = nextField(fen);
+    if (epField.size() == 2 && epField[0] >= 'a' && epField[0] <= 'h' && (epField[1] == '3' || epField[1] == '6'))
+        enPassant = (epField[1] - '1') * 8 + (epField[0] - 'a');
+    else if (epField != "" && epField != "-")
+        return false;
+
+    int halfmoveClock = 0, fullmoveNumber = 1;
+    auto halfmoveField = nextField(fen);
+    auto fullmoveField = nextField(fen);
+    std::from_chars(halfmoveField.data(), halfmoveField.data() + halfmoveField.size(), halfmoveClock);
+    std::from_chars(fullmoveField.data(), fullmoveField.data() + fullmoveField.size(), fullmoveNumber);
+
+    out = fromBoard(board, turn == "b" ? 1 : 0, castling, enPassant, halfmoveClock, fullmoveNumber);
+    return true;
+}
+
+Chess::PackedPosition Chess::PackedPosition::fromBoard(const std::array<std::uint8_t, 64> &board, int sideToMove, int castling, int enPassant, int halfmoveClock, int fullmoveNumber)
+{
+    PackedPosition position{};
+
+    int count = 0;
+    for (int square = 0; square < 64 && count < 32; square++)
+    {
+        if (board[square] == 0)
+            continue;
+
+        position.occupancy |= std::uint64_t(1) << square;
+        position.pieces[count / 2] |= static_cast<std::uint8_t>((board[square] & 0xf) << ((count % 2) * 4));
+        count++;
+    }
+
+    position.sideToMove = static_cast<std::uint8_t>(sideToMove);
+    position.castling = static_cast<std::uint8_t>(castling);
+    position.enPassant = static_cast<std::int8_t>(enPassant);
+    position.halfmoveClock = static_cast<std::uint8_t>(halfmoveClock < 0 ? 0 : (halfmoveClock > 255 ? 255 : halfmoveClock));
+    position.fullmoveNumber = static_cast<std::uint16_t>(fullmoveNumber < 1 ? 1 : fullmoveNumber);
+    return position;
+}
+
+std::array<std::uint8_t, 64> Chess::PackedPosition::board() const
+{
+    std::array<std::uint8_t, 64> board{};
+
+    int count = 0;
+    for (auto occupied = occupancy; occupied; occupied &= occupied - 1)
+    {
+        int square = std::countr_zero(occupied);
+        board[square] = (pieces[count / 2] >> ((count % 2) * 4)) & 0xf;
+        count++;
+    }
+    return board;
+}
+
+std::string Chess::PackedPosition::toFen() const
+{
+    auto squares = board();
+    std::string fen;
+
+    for (int rank = 7; rank >= 0; rank--)
+    {
+        int empty = 0;
+        for (int file = 0; file < 8; file++)
+        {
+            int code = squares[rank * 8 + file];
+            if (code == 0)
+            {
+                empty++;
+                continue;
+            }
+            if (empty != 0)
+                fen += static_cast<char>('0' + empty);
+            empty = 0;
+            fen += PIECE_SYMBOLS[code];
+        }
+        if (empty != 0)
+            fen += static_cast<char>('0' + empty);
+        if (rank != 0)
+            fen += '/';
+    }
+
+    fen += sideToMove == 0 ? " w " : " b ";
+
+    if (castling == 0)
+        fen += '-';
+    if (castling & 1)
+        fen += 'K';
+    if (castling & 2)
+        fen += 'Q';
+    if (castling & 4)
+        fen += 'k';
+    if (castling & 8)
+        fen += 'q';
+
+    fen += ' ';
+    if (enPassant >= 0)
+    {
+        fen += static_cast<char>('a' + enPassant % 8);
+        fen += static_cast<char>('1' + enPassant / 8);
+    }
+    else
+    {
+        fen += '-';
+    }
+
+    fen += ' ' + std::to_string(halfmoveClock) + ' ' + std::to_string(fullmoveNumber);
+    return fen;
+}
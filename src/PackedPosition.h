@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Chess
+{
+    // 32-byte position record for bulk storage and batch evaluation: an occupancy
+    // bitboard followed by one 4-bit piece code (color | type) per occupied square.
+    struct PackedPosition
+    {
+        std::uint64_t occupancy;
+        std::array<std::uint8_t, 16> pieces; // Low nibble first, in square order (max 32 pieces)
+
+        std::uint8_t sideToMove; // 0 = White, 1 = Black
+        std::uint8_t castling;   // Zobrist::CastlingRight mask
+        std::int8_t enPassant;   // Target square, -1 if none
+        std::uint8_t halfmoveClock;
+        std::uint16_t fullmoveNumber;
+        std::uint16_t reserved;
+
+        // Returns false on malformed input (out is left untouched)
+        static bool fromFen(std::string_view fen, PackedPosition &out);
+
+        // From a board of piece codes (0 = empty, at most 32 pieces)
+        static PackedPosition fromBoard(const std::array<std::uint8_t, 64> &board, int sideToMove, int castling = 0, int enPassant = -1, int halfmoveClock = 0, int fullmoveNumber = 1);
+
+        std::array<std::uint8_t, 64> board() const;
+        std::string toFen() const;
+
+        bool operator==(const PackedPosition &) const = default;
+    };
+
+    static_assert(sizeof(PackedPosition) == 32);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Chess
+{
+    // Pawn-structure terms of the hand-crafted evaluation, cached by pawn key
+    // (Position::pawnKey). Pawns only change on pawn moves and captures, so most evaluations
+    // in a search find their structure here. One table per searching thread: entries are
+    // plain data, and only the counters may be read from other threads.
+    class PawnTable
+    {
+    public:
+        static constexpr std::size_t DEFAULT_ENTRIES = 1 << 14; // 512 KB
+
+        struct Entry
+        {
+            std::uint64_t key;
+            std::array<std::int16_t, 2> score;               // Passed, isolated, doubled and backward pawns, by color
+            std::array<std::array<std::int8_t, 8>, 2> shield; // Pawns in front of a castled king, by color and king file
+        };
+
+        struct Statistics
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+        };
+
+    private:
+        std::vector<Entry> m_Entries;
+
+        // Written by the owning thread only
+        std::atomic<std::uint64_t> m_Hits = 0;
+        std::atomic<std::uint64_t> m_Misses = 0;
+
+    public:
+        // entries must be a power of two. Every entry starts as the (scoreless) position without pawns
+        explicit PawnTable(std::size_t entries = DEFAULT_ENTRIES)
+            : m_Entries(entries, Entry{})
+        {
+        }
+
+        // Slot of key: a hit if its key matches, otherwise the caller fills it
+        Entry &entry(std::uint64_t key)
+        {
+            return m_Entries[key & (m_Entries.size() - 1)];
+        }
+
+        void recordProbe(bool hit)
+        {
+            auto &counter = hit ? m_Hits : m_Misses;
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        Statistics statistics() const
+        {
+            return {m_Hits.load(std::memory_order_relaxed), m_Misses.load(std::memory_order_relaxed)};
+        }
+
+        std::size_t memoryUsage() const
+        {
+            return m_Entries.capacity() * sizeof(Entry);
+        }
+    };
+}
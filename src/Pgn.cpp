@@ -0,0 +1,202 @@
+#include "Pgn.h"
+#include "Position.h"
+
+#include <algorithm>
+#include <cctype>
+
+bool Chess::writePgn(std::ostream &out, const PgnGame &game)
+{
+    Position position;
+    if (!game.fen.empty() && !position.setFen(game.fen))
+        return false;
+
+    for (const auto &[name, value] : game.tags)
+        out << '[' << name << " \"" << value << "\"]\n";
+    if (!game.fen.empty())
+        out << "[SetUp \"1\"]\n[FEN \"" << game.fen << "\"]\n";
+    out << "[Result \"" << game.result << "\"]\n\n";
+
+    std::string line;
+    auto append = [&](const std::string &token)
+    {
+        if (!line.empty() && line.size() + 1 + token.size() > 80)
+        {
+            out << line << '\n';
+            line.clear();
+        }
+        if (!line.empty())
+            line += ' ';
+        line += token;
+    };
+
+    bool legal = true;
+    for (std::size_t i = 0; i < game.moves.size(); i++)
+    {
+        // Move numbers before White's moves (and before the first move if Black starts)
+        if (position.sideToMove() == 0)
+            append(std::to_string(position.fullmoveNumber()) + '.');
+        else if (i == 0)
+            append(std::to_string(position.fullmoveNumber()) + "...");
+
+        MoveList moves;
+        position.generateLegal(moves);
+        if (std::find(moves.begin(), moves.end(), game.moves[i]) == moves.end())
+        {
+            legal = false;
+            break;
+        }
+
+        append(position.toSan(game.moves[i]));
+        position.makeMove(game.moves[i]);
+    }
+
+    append(game.result);
+    out << line << "\n\n";
+    return legal;
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> Chess::splitPgn(std::string_view text)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> games;
+
+    // A game starts at a tag line that follows movetext (or the start of the file)
+    std::size_t start = std::string_view::npos;
+    bool inMovetext = true;
+    for (std::size_t cursor = 0; cursor < text.size();)
+    {
+        std::size_t end = text.find('\n', cursor);
+        if (end == std::string_view::npos)
+            end = text.size();
+
+        std::size_t first = text.find_first_not_of(" \t\r", cursor);
+        bool isTag = first < end && text[first] == '[';
+        bool isBlank = first >= end;
+        if (isTag && inMovetext)
+        {
+            if (start != std::string_view::npos)
+                games.emplace_back(start, cursor - start);
+            start = cursor;
+        }
+        if (!isBlank)
+            inMovetext = !isTag;
+
+        cursor = end + 1;
+    }
+
+    if (start != std::string_view::npos)
+        games.emplace_back(start, text.size() - start);
+    return games;
+}
+
+bool Chess::readPgn(std::string_view text, PgnGame &game)
+{
+    game = PgnGame();
+
+    Position position;
+    bool positionSet = false;
+
+    std::size_t cursor = 0;
+    auto skipTo = [&](char symbol)
+    {
+        cursor = text.find(symbol, cursor);
+        cursor = cursor == std::string_view::npos ? text.size() : cursor + 1;
+    };
+
+    while (cursor < text.size())
+    {
+        char symbol = text[cursor];
+        if (std::isspace(static_cast<unsigned char>(symbol)))
+        {
+            cursor++;
+        }
+        else if (symbol == '[')
+        {
+            // [Name "Value"]
+            std::size_t end = text.find(']', cursor);
+            std::size_t open = text.find('"', cursor);
+            std::size_t close = open == std::string_view::npos ? open : text.find('"', open + 1);
+            if (end == std::string_view::npos || close == std::string_view::npos || close > end)
+            {
+                skipTo('\n');
+                continue;
+            }
+
+            auto name = text.substr(cursor + 1, open - cursor - 1);
+            while (!name.empty() && name.back() == ' ')
+                name.remove_suffix(1);
+            std::string value(text.substr(open + 1, close - open - 1));
+
+            if (name == "FEN")
+                game.fen = value;
+            else if (name == "Result")
+                game.result = value;
+            else if (name != "SetUp")
+                game.tags.emplace_back(name, value);
+            cursor = end + 1;
+        }
+        else if (symbol == '{')
+        {
+            skipTo('}');
+        }
+        else if (symbol == ';' || symbol == '%')
+        {
+            skipTo('\n');
+        }
+        else if (symbol == '(')
+        {
+            // Variations nest
+            int depth = 0;
+            while (cursor < text.size())
+            {
+                char current = text[cursor];
+                if (current == '{')
+                {
+                    skipTo('}');
+                    continue;
+                }
+
+                cursor++;
+                if (current == '(')
+                    depth++;
+                else if (current == ')' && --depth == 0)
+                    break;
+            }
+        }
+        else
+        {
+            std::size_t end = text.find_first_of(" \t\r\n{}();[", cursor);
+            if (end == std::string_view::npos)
+                end = text.size();
+            auto token = text.substr(cursor, end - cursor);
+            cursor = end;
+
+            if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+            {
+                game.result = std::string(token);
+                break;
+            }
+
+            // Move numbers ("12." or "12...") may be glued to the move
+            std::size_t dot = token.rfind('.');
+            if (dot != std::string_view::npos)
+                token.remove_prefix(dot + 1);
+            if (token.empty() || token.front() == '$')
+                continue;
+
+            if (!positionSet)
+            {
+                if (!game.fen.empty() && !position.setFen(game.fen))
+                    return false;
+                positionSet = true;
+            }
+
+            auto move = position.parseSan(token);
+            if (move.isNone())
+                return false;
+            game.moves.push_back(move);
+            position.makeMove(move);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "PackedMove.h"
+
+namespace Chess
+{
+    struct PgnGame
+    {
+        // Written in this order; Result is taken from result
+        std::vector<std::pair<std::string, std::string>> tags;
+        std::string fen; // Starting position, empty for the standard one
+        std::vector<PackedMove> moves;
+        std::string result = "*"; // 1-0, 0-1, 1/2-1/2 or *
+    };
+
+    // Movetext is written in SAN, wrapped at 80 columns. Returns false if a move is illegal.
+    bool writePgn(std::ostream &out, const PgnGame &game);
+
+    // Byte ranges (offset, length) of the games in a PGN text, each from its first tag line
+    std::vector<std::pair<std::size_t, std::size_t>> splitPgn(std::string_view text);
+
+    // Reads one game: tags (FEN and Result go to their own fields) and the SAN movetext, skipping
+    // move numbers, comments, variations and NAGs. Returns false at the first move that doesn't
+    // parse or isn't legal; game.moves then holds the moves before it.
+    bool readPgn(std::string_view text, PgnGame &game);
+}
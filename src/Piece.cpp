@@ -54,41 +54,70 @@ const sf::Texture Chess::Piece::BLACK_KING_TEXTURE = Chess::Piece::preloadTextur
 
 // OBJECT
 
-Chess::Piece::Piece(char symbol, sf::RectangleShape &tile)
+const sf::Texture &Chess::Piece::textureOf(int code)
 {
-    m_Descriptor = std::isupper(symbol) ? Color::White : Color::Black;
+    bool white = (code & Color::Black) == 0;
+    switch (code & 0b00000111)
+    {
+    case Type::Pawn:
+        return white ? WHITE_PAWN_TEXTURE : BLACK_PAWN_TEXTURE;
+    case Type::Rook:
+        return white ? WHITE_ROOK_TEXTURE : BLACK_ROOK_TEXTURE;
+    case Type::Knight:
+        return white ? WHITE_KNIGHT_TEXTURE : BLACK_KNIGHT_TEXTURE;
+    case Type::Bishop:
+        return white ? WHITE_BISHOP_TEXTURE : BLACK_BISHOP_TEXTURE;
+    case Type::Queen:
+        return white ? WHITE_QUEEN_TEXTURE : BLACK_QUEEN_TEXTURE;
+    default:
+        return white ? WHITE_KING_TEXTURE : BLACK_KING_TEXTURE;
+    }
+}
+
+byte Chess::Piece::descriptorOf(char symbol)
+{
+    byte descriptor = std::isupper(symbol) ? Color::White : Color::Black;
 
     switch (std::tolower(symbol))
     {
     case 'p':
-        m_Descriptor |= Type::Pawn;
-        p_Sprite = new sf::Sprite(std::isupper(symbol) ? WHITE_PAWN_TEXTURE : BLACK_PAWN_TEXTURE);
+        descriptor |= Type::Pawn;
         break;
     case 'r':
-        m_Descriptor |= Type::Rook;
-        p_Sprite = new sf::Sprite(std::isupper(symbol) ? WHITE_ROOK_TEXTURE : BLACK_ROOK_TEXTURE);
+        descriptor |= Type::Rook;
         break;
     case 'n':
-        m_Descriptor |= Type::Knight;
-        p_Sprite = new sf::Sprite(std::isupper(symbol) ? WHITE_KNIGHT_TEXTURE : BLACK_KNIGHT_TEXTURE);
+        descriptor |= Type::Knight;
         break;
     case 'b':
-        m_Descriptor |= Type::Bishop;
-        p_Sprite = new sf::Sprite(std::isupper(symbol) ? WHITE_BISHOP_TEXTURE : BLACK_BISHOP_TEXTURE);
+        descriptor |= Type::Bishop;
         break;
     case 'q':
-        m_Descriptor |= Type::Queen;
-        p_Sprite = new sf::Sprite(std::isupper(symbol) ? WHITE_QUEEN_TEXTURE : BLACK_QUEEN_TEXTURE);
+        descriptor |= Type::Queen;
         break;
     case 'k':
-        m_Descriptor |= Type::King;
-        p_Sprite = new sf::Sprite(std::isupper(symbol) ? WHITE_KING_TEXTURE : BLACK_KING_TEXTURE);
+        descriptor |= Type::King;
         break;
     }
 
+    return descriptor;
+}
+
+Chess::Piece::Piece(char symbol, sf::RectangleShape &tile)
+{
+    m_Descriptor = descriptorOf(symbol);
+    p_Sprite = new sf::Sprite(textureOf(m_Descriptor));
     p_Sprite->setScale(sf::Vector2f(tile.getSize().x / p_Sprite->getTexture().getSize().x, tile.getSize().y / p_Sprite->getTexture().getSize().y));
 }
 
+void Chess::Piece::setDescriptor(byte descriptor)
+{
+    // Every texture has the same size: the scale still fits the tile
+    if ((descriptor & 0b00001111) != getCode())
+        p_Sprite->setTexture(textureOf(descriptor));
+    m_Descriptor = descriptor;
+}
+
 void Chess::Piece::draw(sf::RenderTarget &target, sf::RenderStates states) const
 {
     states.transform.combine(getTransform());
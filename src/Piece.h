@@ -28,6 +28,7 @@ namespace Chess
 
     private:
         static sf::Texture preloadTexture(char symbol);
+        static const sf::Texture &textureOf(int code);
 
         // Preloaded Textures
         static const sf::Texture WHITE_PAWN_TEXTURE;
@@ -78,6 +79,12 @@ namespace Chess
             return static_cast<Type>(m_Descriptor & 0b00000111);
         }
 
+        // Color and type bits, as used to index per-piece tables
+        int getCode() const
+        {
+            return m_Descriptor & 0b00001111;
+        }
+
         bool hasMoved() const
         {
             return (this->m_Descriptor & 0b00010000) >> 4;
@@ -152,6 +159,18 @@ namespace Chess
             }
         }
 
+        // Type, color and flags at once, for history snapshots. Changing the type or color
+        // switches the texture, so a spare piece can stand for any other.
+        byte getDescriptor() const
+        {
+            return m_Descriptor;
+        }
+
+        void setDescriptor(byte descriptor);
+
+        // Descriptor of a piece that has not moved yet
+        static byte descriptorOf(char symbol);
+
         void setEnPassantVulnerable(bool vul)
         {
             if (vul)
@@ -0,0 +1,907 @@
+#include "Position.h"
+#include "Evaluation.h"
+
+#include <algorithm>
+#include <charconv>
+
+using namespace Chess::Bitboards;
+
+namespace
+{
+    using Chess::Bitboard;
+
+    constexpr std::string_view PIECE_SYMBOLS = " PRNBQK  prnbqk";
+    constexpr std::string_view SAN_LETTERS = "  RNBQK";
+
+    constexpr Bitboard RANK_1 = 0xffull;
+    constexpr Bitboard RANK_8 = RANK_1 << 56;
+
+    // Rights kept when a piece moves from or to each square
+    constexpr std::array<std::uint8_t, 64> castlingMasks()
+    {
+        std::array<std::uint8_t, 64> masks{};
+        masks.fill(15);
+        masks[0] = 15 & ~Chess::Zobrist::WhiteQueenside;
+        masks[7] = 15 & ~Chess::Zobrist::WhiteKingside;
+        masks[4] = 15 & ~(Chess::Zobrist::WhiteKingside | Chess::Zobrist::WhiteQueenside);
+        masks[56] = 15 & ~Chess::Zobrist::BlackQueenside;
+        masks[63] = 15 & ~Chess::Zobrist::BlackKingside;
+        masks[60] = 15 & ~(Chess::Zobrist::BlackKingside | Chess::Zobrist::BlackQueenside);
+        return masks;
+    }
+
+    constexpr std::array<std::uint8_t, 64> CASTLING_MASKS = castlingMasks();
+
+    // Rook squares for a castling king destination
+    constexpr int castlingRookFrom(int kingTo)
+    {
+        return kingTo % 8 == 6 ? kingTo + 1 : kingTo - 2;
+    }
+
+    constexpr int castlingRookTo(int kingTo)
+    {
+        return kingTo % 8 == 6 ? kingTo - 1 : kingTo + 1;
+    }
+
+    // Next space separated field, "" once the input is exhausted
+    std::string_view nextField(std::string_view &text)
+    {
+        while (!text.empty() && text.front() == ' ')
+            text.remove_prefix(1);
+
+        auto field = text.substr(0, text.find(' '));
+        text.remove_prefix(field.size());
+        return field;
+    }
+}
+
+Chess::Position::Position()
+{
+    setFen(START_FEN);
+}
+
+// SETUP
+
+void Chess::Position::clear()
+{
+    m_Board.fill(0);
+    m_Pieces.fill(0);
+    m_Colors.fill(0);
+    m_SideToMove = 0;
+    m_Castling = 0;
+    m_EnPassant = -1;
+    m_HalfmoveClock = 0;
+    m_FullmoveNumber = 1;
+    m_Key = 0;
+    m_PawnKey = 0;
+    m_History.clear();
+}
+
+bool Chess::Position::setFen(std::string_view fen)
+{
+    Position position{EmptyBoard{}};
+
+    // Piece placement, from a8 to h1
+    int file = 0, rank = 7;
+    for (auto symbol : nextField(fen))
+    {
+        if (symbol == '/')
+        {
+            if (file != 8 || rank == 0)
+                return false;
+            file = 0;
+            rank--;
+        }
+        else if (symbol >= '1' && symbol <= '8')
+        {
+            file += symbol - '0';
+            if (file > 8)
+                return false;
+        }
+        else
+        {
+            auto code = PIECE_SYMBOLS.find(symbol);
+            if (code == std::string_view::npos || symbol == ' ' || file > 7)
+                return false;
+            position.putPiece(static_cast<int>(code), rank * 8 + file++);
+        }
+    }
+    if (rank != 0 || file != 8)
+        return false;
+
+    if (count(position.pieces(0, PieceType::King)) != 1 || count(position.pieces(1, PieceType::King)) != 1)
+        return false;
+    if ((position.pieces(0, PieceType::Pawn) | position.pieces(1, PieceType::Pawn)) & (RANK_1 | RANK_8))
+        return false;
+
+    auto turn = nextField(fen);
+    if (turn != "" && turn != "w" && turn != "b")
+        return false;
+    position.m_SideToMove = turn == "b" ? 1 : 0;
+
+    for (auto right : nextField(fen))
+    {
+        switch (right)
+        {
+        case 'K':
+            position.m_Castling |= Zobrist::WhiteKingside;
+            break;
+        case 'Q':
+            position.m_Castling |= Zobrist::WhiteQueenside;
+            break;
+        case 'k':
+            position.m_Castling |= Zobrist::BlackKingside;
+            break;
+        case 'q':
+            position.m_Castling |= Zobrist::BlackQueenside;
+            break;
+        case '-':
+            break;
+        default:
+            return false;
+        }
+    }
+
+    // Rights without the king and rook on their squares are dropped
+    auto unmoved = [&position](int square, int code)
+    {
+        return position.m_Board[square] == code;
+    };
+    if (!unmoved(4, makePiece(0, PieceType::King)))
+        position.m_Castling &= ~(Zobrist::WhiteKingside | Zobrist::WhiteQueenside);
+    if (!unmoved(7, makePiece(0, PieceType::Rook)))
+        position.m_Castling &= ~Zobrist::WhiteKingside;
+    if (!unmoved(0, makePiece(0, PieceType::Rook)))
+        position.m_Castling &= ~Zobrist::WhiteQueenside;
+    if (!unmoved(60, makePiece(1, PieceType::King)))
+        position.m_Castling &= ~(Zobrist::BlackKingside | Zobrist::BlackQueenside);
+    if (!unmoved(63, makePiece(1, PieceType::Rook)))
+        position.m_Castling &= ~Zobrist::BlackKingside;
+    if (!unmoved(56, makePiece(1, PieceType::Rook)))
+        position.m_Castling &= ~Zobrist::BlackQueenside;
+
+    auto epField = nextField(fen);
+    if (epField.size() == 2 && epField[0] >= 'a' && epField[0] <= 'h' && epField[1] == (position.m_SideToMove == 0 ? '6' : '3'))
+    {
+        // Kept only if a pawn can take (as in Game::enPassantFile)
+        int target = (epField[1] - '1') * 8 + (epField[0] - 'a');
+        if (PAWN_ATTACKS[position.m_SideToMove ^ 1][target] & position.pieces(position.m_SideToMove, PieceType::Pawn))
+            position.m_EnPassant = target;
+    }
+    else if (epField != "" && epField != "-")
+    {
+        return false;
+    }
+
+    auto halfmoveField = nextField(fen);
+    auto fullmoveField = nextField(fen);
+    std::from_chars(halfmoveField.data(), halfmoveField.data() + halfmoveField.size(), position.m_HalfmoveClock);
+    std::from_chars(fullmoveField.data(), fullmoveField.data() + fullmoveField.size(), position.m_FullmoveNumber);
+    position.m_HalfmoveClock = std::max(0, position.m_HalfmoveClock);
+    position.m_FullmoveNumber = std::max(1, position.m_FullmoveNumber);
+
+    // The side not to move can't be in check
+    if (position.isAttacked(position.kingSquare(position.m_SideToMove ^ 1), position.m_SideToMove))
+        return false;
+
+    position.m_Key ^= Zobrist::KEYS.castling[position.m_Castling];
+    if (position.m_SideToMove == 1)
+        position.m_Key ^= Zobrist::KEYS.side;
+    if (position.m_EnPassant != -1)
+        position.m_Key ^= Zobrist::KEYS.enPassant[position.m_EnPassant % 8];
+
+    *this = std::move(position);
+    return true;
+}
+
+std::string Chess::Position::fen() const
+{
+    return packed().toFen();
+}
+
+void Chess::Position::setPacked(const PackedPosition &packed)
+{
+    // Goes through the FEN path to get the same validation and normalization
+    if (!setFen(packed.toFen()))
+        clear();
+}
+
+Chess::PackedPosition Chess::Position::packed() const
+{
+    return PackedPosition::fromBoard(m_Board, m_SideToMove, m_Castling, m_EnPassant, m_HalfmoveClock, m_FullmoveNumber);
+}
+
+// BOARD UPDATES
+
+void Chess::Position::putPiece(int code, int square)
+{
+    m_Board[square] = static_cast<std::uint8_t>(code);
+    m_Pieces[code] |= squareBit(square);
+    m_Colors[code >> 3] |= squareBit(square);
+    m_Key ^= Zobrist::KEYS.piece[code][square];
+    if ((code & 7) == PieceType::Pawn)
+        m_PawnKey ^= Zobrist::KEYS.piece[code][square];
+}
+
+void Chess::Position::removePiece(int square)
+{
+    int code = m_Board[square];
+    m_Board[square] = 0;
+    m_Pieces[code] ^= squareBit(square);
+    m_Colors[code >> 3] ^= squareBit(square);
+    m_Key ^= Zobrist::KEYS.piece[code][square];
+    if ((code & 7) == PieceType::Pawn)
+        m_PawnKey ^= Zobrist::KEYS.piece[code][square];
+}
+
+void Chess::Position::movePiece(int from, int to)
+{
+    int code = m_Board[from];
+    Bitboard fromTo = squareBit(from) | squareBit(to);
+    m_Board[from] = 0;
+    m_Board[to] = static_cast<std::uint8_t>(code);
+    m_Pieces[code] ^= fromTo;
+    m_Colors[code >> 3] ^= fromTo;
+    m_Key ^= Zobrist::KEYS.piece[code][from] ^ Zobrist::KEYS.piece[code][to];
+    if ((code & 7) == PieceType::Pawn)
+        m_PawnKey ^= Zobrist::KEYS.piece[code][from] ^ Zobrist::KEYS.piece[code][to];
+}
+
+// ATTACKS
+
+Chess::Bitboard Chess::Position::attackersTo(int square, Bitboard occupied) const
+{
+    Bitboard rooks = pieces(0, PieceType::Rook) | pieces(1, PieceType::Rook) | pieces(0, PieceType::Queen) | pieces(1, PieceType::Queen);
+    Bitboard bishops = pieces(0, PieceType::Bishop) | pieces(1, PieceType::Bishop) | pieces(0, PieceType::Queen) | pieces(1, PieceType::Queen);
+
+    return (PAWN_ATTACKS[1][square] & pieces(0, PieceType::Pawn)) |
+           (PAWN_ATTACKS[0][square] & pieces(1, PieceType::Pawn)) |
+           (KNIGHT_ATTACKS[square] & (pieces(0, PieceType::Knight) | pieces(1, PieceType::Knight))) |
+           (KING_ATTACKS[square] & (pieces(0, PieceType::King) | pieces(1, PieceType::King))) |
+           (rookAttacks(square, occupied) & rooks) |
+           (bishopAttacks(square, occupied) & bishops);
+}
+
+int Chess::Position::see(PackedMove move) const
+{
+    // A king capture ends the exchange: it can only happen if the previous capture was illegal
+    constexpr std::array<int, 7> VALUES = {0, Evaluation::PIECE_VALUES[1], Evaluation::PIECE_VALUES[2], Evaluation::PIECE_VALUES[3],
+                                           Evaluation::PIECE_VALUES[4], Evaluation::PIECE_VALUES[5], 20000};
+    constexpr std::array<int, 6> BY_VALUE = {PieceType::Pawn, PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen, PieceType::King};
+
+    if (move.kind() == PackedMove::Castling)
+        return 0;
+
+    int from = move.from();
+    int to = move.to();
+    int side = m_Board[from] >> 3;
+
+    // Balance for the side making each capture, if the exchange stopped right after it
+    std::array<int, 32> gain{};
+    int attacker = m_Board[from] & 7;
+    gain[0] = VALUES[move.kind() == PackedMove::EnPassant ? PieceType::Pawn : m_Board[to] & 7];
+    if (move.kind() == PackedMove::Promotion)
+    {
+        attacker = move.promotionType();
+        gain[0] += VALUES[attacker] - VALUES[PieceType::Pawn];
+    }
+
+    Bitboard all = occupied() ^ squareBit(from);
+    if (move.kind() == PackedMove::EnPassant)
+        all ^= squareBit(to + (side == 0 ? -8 : 8));
+
+    Bitboard diagonal = pieces(0, PieceType::Bishop) | pieces(1, PieceType::Bishop) | pieces(0, PieceType::Queen) | pieces(1, PieceType::Queen);
+    Bitboard straight = pieces(0, PieceType::Rook) | pieces(1, PieceType::Rook) | pieces(0, PieceType::Queen) | pieces(1, PieceType::Queen);
+    Bitboard attackers = attackersTo(to, all) & all;
+
+    int depth = 0;
+    while (true)
+    {
+        side ^= 1;
+        Bitboard ours = attackers & m_Colors[side];
+        if (ours == 0)
+            break;
+
+        // Least valuable attacker recaptures
+        Bitboard next = 0;
+        int type = PieceType::None;
+        for (int candidate : BY_VALUE)
+        {
+            next = ours & pieces(side, candidate);
+            if (next != 0)
+            {
+                type = candidate;
+                break;
+            }
+        }
+
+        depth++;
+        gain[depth] = VALUES[attacker] - gain[depth - 1];
+        if (attacker == PieceType::King)
+            break;
+
+        attacker = type;
+        all ^= next & -next;
+
+        // Sliders behind the piece that just left become attackers
+        if (type == PieceType::Pawn || type == PieceType::Bishop || type == PieceType::Queen)
+            attackers |= bishopAttacks(to, all) & diagonal;
+        if (type == PieceType::Rook || type == PieceType::Queen)
+            attackers |= rookAttacks(to, all) & straight;
+        attackers &= all;
+    }
+
+    // Each side may stop capturing whenever that is better
+    for (; depth > 0; depth--)
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    return gain[0];
+}
+
+Chess::Bitboard Chess::Position::hangingPieces(int color) const
+{
+    Bitboard hanging = 0;
+    for (auto targets = m_Colors[color] & ~pieces(color, PieceType::King); targets;)
+    {
+        int square = popLsb(targets);
+        for (auto attackers = attackersTo(square, occupied()) & m_Colors[color ^ 1]; attackers;)
+        {
+            int from = popLsb(attackers);
+            bool promotes = (m_Board[from] & 7) == PieceType::Pawn && (square / 8 == 0 || square / 8 == 7);
+            if (see(PackedMove(from, square, promotes ? PackedMove::Promotion : PackedMove::Normal)) > 0)
+            {
+                hanging |= squareBit(square);
+                break;
+            }
+        }
+    }
+    return hanging;
+}
+
+// MOVE GENERATION
+
+void Chess::Position::generate(MoveList &moves, Generate type) const
+{
+    int us = m_SideToMove;
+    Bitboard own = m_Colors[us];
+    Bitboard enemy = m_Colors[us ^ 1];
+    Bitboard all = own | enemy;
+
+    Bitboard targets = type == Generate::Captures ? enemy : type == Generate::Quiets ? ~all
+                                                                                      : ~own;
+
+    generatePawnMoves(moves, type);
+
+    for (int pieceType : {PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen, PieceType::King})
+    {
+        for (auto fromSquares = pieces(us, pieceType); fromSquares;)
+        {
+            int from = popLsb(fromSquares);
+
+            Bitboard attacks = 0;
+            switch (pieceType)
+            {
+            case PieceType::Knight:
+                attacks = KNIGHT_ATTACKS[from];
+                break;
+            case PieceType::Bishop:
+                attacks = bishopAttacks(from, all);
+                break;
+            case PieceType::Rook:
+                attacks = rookAttacks(from, all);
+                break;
+            case PieceType::Queen:
+                attacks = queenAttacks(from, all);
+                break;
+            default:
+                attacks = KING_ATTACKS[from];
+                break;
+            }
+
+            for (auto toSquares = attacks & targets; toSquares;)
+                moves.add(PackedMove(from, popLsb(toSquares)));
+        }
+    }
+
+    if (type != Generate::Captures)
+        generateCastling(moves);
+}
+
+void Chess::Position::generatePawnMoves(MoveList &moves, Generate type) const
+{
+    int us = m_SideToMove;
+    int forward = us == 0 ? 8 : -8;
+    int startRank = us == 0 ? 1 : 6;
+    int lastRank = us == 0 ? 7 : 0;
+    Bitboard enemy = m_Colors[us ^ 1];
+    bool noisy = type != Generate::Quiets;
+    bool quiet = type != Generate::Captures;
+
+    auto addPromotions = [&moves](int from, int to)
+    {
+        for (int promotion : {PieceType::Queen, PieceType::Knight, PieceType::Rook, PieceType::Bishop})
+            moves.add(PackedMove(from, to, PackedMove::Promotion, promotion));
+    };
+
+    for (auto pawns = pieces(us, PieceType::Pawn); pawns;)
+    {
+        int from = popLsb(pawns);
+        int to = from + forward;
+        bool promotes = to / 8 == lastRank;
+
+        // Pushes
+        if (m_Board[to] == 0)
+        {
+            if (promotes)
+            {
+                if (noisy)
+                    addPromotions(from, to);
+            }
+            else if (quiet)
+            {
+                moves.add(PackedMove(from, to));
+                if (from / 8 == startRank && m_Board[to + forward] == 0)
+                    moves.add(PackedMove(from, to + forward));
+            }
+        }
+
+        if (!noisy)
+            continue;
+
+        // Captures
+        for (auto targets = PAWN_ATTACKS[us][from] & enemy; targets;)
+        {
+            int target = popLsb(targets);
+            if (promotes)
+                addPromotions(from, target);
+            else
+                moves.add(PackedMove(from, target));
+        }
+
+        if (m_EnPassant != -1 && (PAWN_ATTACKS[us][from] & squareBit(m_EnPassant)))
+            moves.add(PackedMove(from, m_EnPassant, PackedMove::EnPassant));
+    }
+}
+
+void Chess::Position::generateCastling(MoveList &moves) const
+{
+    int us = m_SideToMove;
+    int rights = m_Castling & (us == 0 ? (Zobrist::WhiteKingside | Zobrist::WhiteQueenside) : (Zobrist::BlackKingside | Zobrist::BlackQueenside));
+    if (rights == 0 || inCheck())
+        return;
+
+    int king = us == 0 ? 4 : 60;
+    Bitboard all = occupied();
+
+    // The king may not pass through or land on an attacked square
+    if ((rights & (Zobrist::WhiteKingside | Zobrist::BlackKingside)) && (BETWEEN[king][king + 3] & all) == 0 &&
+        !isAttacked(king + 1, us ^ 1) && !isAttacked(king + 2, us ^ 1))
+        moves.add(PackedMove(king, king + 2, PackedMove::Castling));
+
+    if ((rights & (Zobrist::WhiteQueenside | Zobrist::BlackQueenside)) && (BETWEEN[king][king - 4] & all) == 0 &&
+        !isAttacked(king - 1, us ^ 1) && !isAttacked(king - 2, us ^ 1))
+        moves.add(PackedMove(king, king - 2, PackedMove::Castling));
+}
+
+bool Chess::Position::isLegal(PackedMove move) const
+{
+    if (move.kind() == PackedMove::Castling)
+        return true; // Fully checked by the generator
+
+    int us = m_SideToMove;
+    int from = move.from();
+    int to = move.to();
+    int king = kingSquare(us);
+
+    Bitboard captured = squareBit(to);
+    Bitboard all = (occupied() ^ squareBit(from)) | squareBit(to);
+
+    if (move.kind() == PackedMove::EnPassant)
+    {
+        captured = squareBit(to + (us == 0 ? -8 : 8));
+        all ^= captured;
+    }
+
+    if (from == king)
+        king = to;
+
+    return (attackersTo(king, all) & m_Colors[us ^ 1] & ~captured) == 0;
+}
+
+bool Chess::Position::isPseudoLegal(PackedMove move) const
+{
+    int us = m_SideToMove;
+    int from = move.from();
+    int to = move.to();
+    int piece = m_Board[from];
+
+    if (move.isNone() || piece == 0 || (piece >> 3) != us || (m_Colors[us] & squareBit(to)))
+        return false;
+
+    if (move.kind() == PackedMove::Castling)
+    {
+        MoveList castling;
+        generateCastling(castling);
+        return std::find(castling.begin(), castling.end(), move) != castling.end();
+    }
+
+    Bitboard all = occupied();
+    int type = piece & 7;
+    if (type != PieceType::Pawn)
+    {
+        Bitboard attacks = type == PieceType::Knight ? KNIGHT_ATTACKS[from] : type == PieceType::Bishop ? bishopAttacks(from, all)
+                                                                          : type == PieceType::Rook     ? rookAttacks(from, all)
+                                                                          : type == PieceType::Queen    ? queenAttacks(from, all)
+                                                                                                        : KING_ATTACKS[from];
+        return move == PackedMove(from, to) && (attacks & squareBit(to));
+    }
+
+    if (move.kind() == PackedMove::EnPassant)
+        return move == PackedMove(from, to, PackedMove::EnPassant) && to == m_EnPassant && (PAWN_ATTACKS[us][from] & squareBit(to));
+
+    // Promotions are the only pawn moves to the last rank
+    int forward = us == 0 ? 8 : -8;
+    bool promotes = to / 8 == (us == 0 ? 7 : 0);
+    if (promotes != (move.kind() == PackedMove::Promotion) || (!promotes && move != PackedMove(from, to)))
+        return false;
+
+    if (PAWN_ATTACKS[us][from] & m_Colors[us ^ 1] & squareBit(to))
+        return true;
+    if (m_Board[to] != 0)
+        return false;
+    return to == from + forward || (to == from + 2 * forward && from / 8 == (us == 0 ? 1 : 6) && m_Board[from + forward] == 0);
+}
+
+void Chess::Position::generateLegal(MoveList &moves, Generate type) const
+{
+    MoveList pseudo;
+    generate(pseudo, type);
+
+    for (auto move : pseudo)
+    {
+        if (isLegal(move))
+            moves.add(move);
+    }
+}
+
+// MAKE / UNMAKE
+
+void Chess::Position::updateEnPassant(int from, int to)
+{
+    if (m_EnPassant != -1)
+        m_Key ^= Zobrist::KEYS.enPassant[m_EnPassant % 8];
+    m_EnPassant = -1;
+
+    if (to - from != 16 && from - to != 16)
+        return;
+
+    // Only recorded when an enemy pawn could take
+    int target = (from + to) / 2;
+    int us = m_Board[to] >> 3;
+    if (PAWN_ATTACKS[us][target] & pieces(us ^ 1, PieceType::Pawn))
+    {
+        m_EnPassant = target;
+        m_Key ^= Zobrist::KEYS.enPassant[target % 8];
+    }
+}
+
+void Chess::Position::makeMove(PackedMove move, Nnue::DirtyPieces *dirty)
+{
+    int us = m_SideToMove;
+    int from = move.from();
+    int to = move.to();
+    int piece = m_Board[from];
+
+    State state{
+        .key = m_Key,
+        .move = move,
+        .captured = 0,
+        .castling = static_cast<std::uint8_t>(m_Castling),
+        .enPassant = static_cast<std::int8_t>(m_EnPassant),
+        .halfmoveClock = static_cast<std::uint16_t>(m_HalfmoveClock),
+    };
+
+    Nnue::DirtyPieces ignored;
+    auto &changed = dirty != nullptr ? *dirty : ignored;
+    changed.count = 0;
+
+    m_HalfmoveClock++;
+
+    if (move.kind() == PackedMove::Castling)
+    {
+        int rookFrom = castlingRookFrom(to);
+        int rookTo = castlingRookTo(to);
+        movePiece(from, to);
+        movePiece(rookFrom, rookTo);
+        changed.add(piece, from, to);
+        changed.add(m_Board[rookTo], rookFrom, rookTo);
+    }
+    else
+    {
+        int captureSquare = move.kind() == PackedMove::EnPassant ? to + (us == 0 ? -8 : 8) : to;
+        int captured = m_Board[captureSquare];
+        if (captured != 0)
+        {
+            state.captured = static_cast<std::uint8_t>(captured);
+            changed.add(captured, captureSquare, -1);
+            removePiece(captureSquare);
+            m_HalfmoveClock = 0;
+        }
+
+        if (move.kind() == PackedMove::Promotion)
+        {
+            int promoted = makePiece(us, move.promotionType());
+            removePiece(from);
+            putPiece(promoted, to);
+            changed.add(piece, from, -1);
+            changed.add(promoted, -1, to);
+        }
+        else
+        {
+            movePiece(from, to);
+            changed.add(piece, from, to);
+        }
+
+        if ((piece & 7) == PieceType::Pawn)
+            m_HalfmoveClock = 0;
+    }
+
+    if ((piece & 7) == PieceType::Pawn)
+        updateEnPassant(from, to);
+    else if (m_EnPassant != -1)
+        updateEnPassant(from, from);
+
+    m_Key ^= Zobrist::KEYS.castling[m_Castling];
+    m_Castling &= CASTLING_MASKS[from] & CASTLING_MASKS[to];
+    m_Key ^= Zobrist::KEYS.castling[m_Castling];
+
+    if (us == 1)
+        m_FullmoveNumber++;
+    m_SideToMove ^= 1;
+    m_Key ^= Zobrist::KEYS.side;
+
+    m_History.push_back(state);
+}
+
+void Chess::Position::unmakeMove()
+{
+    if (m_History.empty())
+        return;
+
+    State state = m_History.back();
+    m_History.pop_back();
+
+    m_SideToMove ^= 1;
+    if (m_SideToMove == 1)
+        m_FullmoveNumber--;
+
+    int us = m_SideToMove;
+    auto move = state.move;
+    int from = move.from();
+    int to = move.to();
+
+    if (move.kind() == PackedMove::Castling)
+    {
+        movePiece(to, from);
+        movePiece(castlingRookTo(to), castlingRookFrom(to));
+    }
+    else
+    {
+        if (move.kind() == PackedMove::Promotion)
+        {
+            removePiece(to);
+            putPiece(makePiece(us, PieceType::Pawn), from);
+        }
+        else
+        {
+            movePiece(to, from);
+        }
+
+        if (state.captured != 0)
+            putPiece(state.captured, move.kind() == PackedMove::EnPassant ? to + (us == 0 ? -8 : 8) : to);
+    }
+
+    m_Castling = state.castling;
+    m_EnPassant = state.enPassant;
+    m_HalfmoveClock = state.halfmoveClock;
+    m_Key = state.key;
+}
+
+// NOTATION
+
+std::string Chess::Position::toSan(PackedMove move) const
+{
+    int from = move.from();
+    int to = move.to();
+    int type = m_Board[from] & 7;
+
+    std::string san;
+    if (move.kind() == PackedMove::Castling)
+    {
+        san = to % 8 == 6 ? "O-O" : "O-O-O";
+    }
+    else
+    {
+        if (type == PieceType::Pawn)
+        {
+            if (isCapture(move))
+            {
+                san += static_cast<char>('a' + from % 8);
+                san += 'x';
+            }
+        }
+        else
+        {
+            san += SAN_LETTERS[type];
+
+            // Disambiguation by file, then rank, then both
+            MoveList legal;
+            generateLegal(legal);
+
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (auto other : legal)
+            {
+                if (other.to() != to || other.from() == from || (m_Board[other.from()] & 7) != type)
+                    continue;
+                ambiguous = true;
+                sameFile |= other.from() % 8 == from % 8;
+                sameRank |= other.from() / 8 == from / 8;
+            }
+
+            if (ambiguous && (!sameFile || sameRank))
+                san += static_cast<char>('a' + from % 8);
+            if (ambiguous && sameFile)
+                san += static_cast<char>('1' + from / 8);
+
+            if (isCapture(move))
+                san += 'x';
+        }
+
+        san += static_cast<char>('a' + to % 8);
+        san += static_cast<char>('1' + to / 8);
+
+        if (move.kind() == PackedMove::Promotion)
+        {
+            san += '=';
+            san += SAN_LETTERS[move.promotionType()];
+        }
+    }
+
+    // Check and mate suffixes
+    Position next = *this;
+    next.makeMove(move);
+    if (next.inCheck())
+    {
+        MoveList replies;
+        next.generateLegal(replies);
+        san += replies.size() == 0 ? '#' : '+';
+    }
+
+    return san;
+}
+
+Chess::PackedMove Chess::Position::parseMove(std::string_view text) const
+{
+    // Strip check marks and annotations
+    while (!text.empty() && std::string_view("+#!? ").find(text.back()) != std::string_view::npos)
+        text.remove_suffix(1);
+
+    MoveList legal;
+    generateLegal(legal);
+
+    for (auto move : legal)
+    {
+        if (move.toUci() == text)
+            return move;
+    }
+
+    return parseSan(text);
+}
+
+Chess::PackedMove Chess::Position::parseSan(std::string_view text) const
+{
+    while (!text.empty() && std::string_view("+#!? ").find(text.back()) != std::string_view::npos)
+        text.remove_suffix(1);
+
+    MoveList legal;
+    generateLegal(legal);
+
+    if (text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0")
+    {
+        int file = text.size() == 3 ? 6 : 2;
+        for (auto move : legal)
+        {
+            if (move.kind() == PackedMove::Castling && move.to() % 8 == file)
+                return move;
+        }
+        return {};
+    }
+
+    int type = PieceType::Pawn;
+    if (!text.empty() && SAN_LETTERS.find(text.front()) != std::string_view::npos && text.front() != ' ')
+    {
+        type = static_cast<int>(SAN_LETTERS.find(text.front()));
+        text.remove_prefix(1);
+    }
+
+    // Promotion piece, with or without '='
+    int promotion = 0;
+    if (!text.empty() && SAN_LETTERS.find(text.back()) != std::string_view::npos && text.back() != ' ')
+    {
+        promotion = static_cast<int>(SAN_LETTERS.find(text.back()));
+        text.remove_suffix(1);
+        if (!text.empty() && text.back() == '=')
+            text.remove_suffix(1);
+    }
+
+    if (text.size() < 2)
+        return {};
+    int toFile = text[text.size() - 2] - 'a', toRank = text[text.size() - 1] - '1';
+    if (toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7)
+        return {};
+    int to = toRank * 8 + toFile;
+    text.remove_suffix(2);
+
+    // What is left is disambiguation and the capture mark
+    int fromFile = -1, fromRank = -1;
+    for (char symbol : text)
+    {
+        if (symbol >= 'a' && symbol <= 'h')
+            fromFile = symbol - 'a';
+        else if (symbol >= '1' && symbol <= '8')
+            fromRank = symbol - '1';
+        else if (symbol != 'x' && symbol != ':')
+            return {};
+    }
+
+    for (auto move : legal)
+    {
+        if (move.to() != to || move.kind() == PackedMove::Castling || (m_Board[move.from()] & 7) != type)
+            continue;
+        if ((fromFile != -1 && move.from() % 8 != fromFile) || (fromRank != -1 && move.from() / 8 != fromRank))
+            continue;
+        if ((move.kind() == PackedMove::Promotion) != (promotion != 0) || (promotion != 0 && move.promotionType() != promotion))
+            continue;
+        return move;
+    }
+
+    return {};
+}
+
+// DRAWS
+
+void Chess::Position::compactHistory()
+{
+    auto keep = std::min<std::size_t>(m_HalfmoveClock, m_History.size());
+    m_History.erase(m_History.begin(), m_History.end() - keep);
+}
+
+int Chess::Position::repetitionCount() const
+{
+    int count = 0;
+    int distance = std::min<int>(m_HalfmoveClock, static_cast<int>(m_History.size()));
+
+    // Same side to move only, so every other ply
+    for (int i = 2; i <= distance; i += 2)
+    {
+        if (m_History[m_History.size() - i].key == m_Key)
+            count++;
+    }
+    return count;
+}
+
+bool Chess::Position::hasInsufficientMaterial() const
+{
+    Bitboard heavy = pieces(0, PieceType::Pawn) | pieces(1, PieceType::Pawn) | pieces(0, PieceType::Rook) | pieces(1, PieceType::Rook) |
+                     pieces(0, PieceType::Queen) | pieces(1, PieceType::Queen);
+    if (heavy != 0)
+        return false;
+
+    Bitboard knights = pieces(0, PieceType::Knight) | pieces(1, PieceType::Knight);
+    Bitboard bishops = pieces(0, PieceType::Bishop) | pieces(1, PieceType::Bishop);
+    if (count(knights | bishops) <= 1)
+        return true;
+
+    // Only bishops, all on squares of one color
+    constexpr Bitboard DARK_SQUARES = 0xaa55aa55aa55aa55ull;
+    return knights == 0 && ((bishops & DARK_SQUARES) == 0 || (bishops & ~DARK_SQUARES) == 0);
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bitboard.h"
+#include "Nnue.h"
+#include "PackedMove.h"
+#include "PackedPosition.h"
+#include "Zobrist.h"
+
+namespace Chess
+{
+    // Piece codes are the Piece descriptor bits: color << 3 | type
+    namespace PieceType
+    {
+        enum : int
+        {
+            None = 0,
+            Pawn = 1,
+            Rook = 2,
+            Knight = 3,
+            Bishop = 4,
+            Queen = 5,
+            King = 6,
+        };
+    }
+
+    constexpr int makePiece(int color, int type)
+    {
+        return (color << 3) | type;
+    }
+
+    // Headless, bitboard based position with legal move generation and make/unmake.
+    // Game keys match Game::computeKey, so both can share tables and books.
+    class Position
+    {
+    public:
+        static constexpr std::string_view START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+        enum class Generate
+        {
+            Captures, // Captures and promotions
+            Quiets,   // Everything else, castling included
+            All,
+        };
+
+        // Undo information for one move
+        struct State
+        {
+            std::uint64_t key; // Before the move
+            PackedMove move;
+            std::uint8_t captured;
+            std::uint8_t castling;
+            std::int8_t enPassant;
+            std::uint16_t halfmoveClock;
+        };
+
+    private:
+        std::array<std::uint8_t, 64> m_Board{};
+        std::array<Bitboard, 16> m_Pieces{}; // By piece code
+        std::array<Bitboard, 2> m_Colors{};
+
+        int m_SideToMove = 0;
+        int m_Castling = 0;
+        int m_EnPassant = -1; // Only set when a pawn can actually capture there
+        int m_HalfmoveClock = 0;
+        int m_FullmoveNumber = 1;
+        std::uint64_t m_Key = 0;
+        std::uint64_t m_PawnKey = 0; // Pawns only, restored by unmake like the board
+
+        std::vector<State> m_History;
+
+    public:
+        Position();
+
+        // Returns false (leaving the position untouched) on malformed input. Trailing fields
+        // may be missing; anything after the fullmove number is ignored.
+        bool setFen(std::string_view fen);
+        std::string fen() const;
+
+        void setPacked(const PackedPosition &packed);
+        PackedPosition packed() const;
+
+        // MOVES
+
+        // Pseudo-legal moves (the king may be left in check, castling is fully checked)
+        void generate(MoveList &moves, Generate type = Generate::All) const;
+        void generateLegal(MoveList &moves, Generate type = Generate::All) const;
+
+        // For moves produced by generate()
+        bool isLegal(PackedMove move) const;
+
+        // Whether generate() would produce move here, for moves from elsewhere (killers, tables)
+        bool isPseudoLegal(PackedMove move) const;
+
+        // Fills dirty with the pieces that changed squares, for NNUE accumulator updates
+        void makeMove(PackedMove move, Nnue::DirtyPieces *dirty = nullptr);
+        void unmakeMove();
+
+        bool isCapture(PackedMove move) const
+        {
+            return m_Board[move.to()] != 0 || move.kind() == PackedMove::EnPassant;
+        }
+
+        // NOTATION
+
+        std::string toSan(PackedMove move) const;
+
+        // Accepts UCI (e2e4, e7e8q) or SAN (e4, Nxf3+, O-O); returns no move if not legal
+        PackedMove parseMove(std::string_view text) const;
+
+        // SAN only, without formatting each legal move (fast enough to replay game archives)
+        PackedMove parseSan(std::string_view text) const;
+
+        // STATE
+
+        int pieceAt(int square) const
+        {
+            return m_Board[square];
+        }
+
+        const std::array<std::uint8_t, 64> &board() const
+        {
+            return m_Board;
+        }
+
+        Bitboard pieces(int code) const
+        {
+            return m_Pieces[code];
+        }
+
+        Bitboard pieces(int color, int type) const
+        {
+            return m_Pieces[makePiece(color, type)];
+        }
+
+        Bitboard colorPieces(int color) const
+        {
+            return m_Colors[color];
+        }
+
+        Bitboard occupied() const
+        {
+            return m_Colors[0] | m_Colors[1];
+        }
+
+        int kingSquare(int color) const
+        {
+            return std::countr_zero(pieces(color, PieceType::King));
+        }
+
+        int sideToMove() const
+        {
+            return m_SideToMove;
+        }
+
+        int castling() const
+        {
+            return m_Castling;
+        }
+
+        int enPassant() const
+        {
+            return m_EnPassant;
+        }
+
+        int halfmoveClock() const
+        {
+            return m_HalfmoveClock;
+        }
+
+        int fullmoveNumber() const
+        {
+            return m_FullmoveNumber;
+        }
+
+        std::uint64_t key() const
+        {
+            return m_Key;
+        }
+
+        // Zobrist key of the pawns of both colors alone (0 without pawns), for PawnTable
+        std::uint64_t pawnKey() const
+        {
+            return m_PawnKey;
+        }
+
+        // Moves made since the last setFen/setPacked
+        const std::vector<State> &history() const
+        {
+            return m_History;
+        }
+
+        // Drops undo records older than the last irreversible move (repetitions can't reach
+        // past it). Moves before that point can no longer be unmade.
+        void compactHistory();
+
+        // ATTACKS
+
+        // Pieces of both colors attacking square with the given occupancy
+        Bitboard attackersTo(int square, Bitboard occupied) const;
+
+        bool isAttacked(int square, int byColor) const
+        {
+            return (attackersTo(square, occupied()) & m_Colors[byColor]) != 0;
+        }
+
+        Bitboard checkers() const
+        {
+            return attackersTo(kingSquare(m_SideToMove), occupied()) & m_Colors[m_SideToMove ^ 1];
+        }
+
+        bool inCheck() const
+        {
+            return checkers() != 0;
+        }
+
+        // Static exchange evaluation: material balance in centipawns for the mover once every
+        // capture on the destination square (x-rays included) has been played out in the best
+        // order for both sides. Pins are ignored. Works for either color's moves.
+        int see(PackedMove move) const;
+
+        // Pieces of color (king excluded) the opponent wins material by capturing
+        Bitboard hangingPieces(int color) const;
+
+        // DRAWS
+
+        // Earlier occurrences of the current position since the last irreversible move
+        int repetitionCount() const;
+
+        bool hasInsufficientMaterial() const;
+
+        // Repetition (any earlier occurrence), fifty-move rule or dead position
+        bool isDraw() const
+        {
+            return m_HalfmoveClock >= 100 || repetitionCount() > 0 || hasInsufficientMaterial();
+        }
+
+    private:
+        struct EmptyBoard
+        {
+        };
+
+        explicit Position(EmptyBoard)
+        {
+        }
+
+        void clear();
+
+        void putPiece(int code, int square);
+        void removePiece(int square);
+        void movePiece(int from, int to);
+
+        void updateEnPassant(int from, int to);
+
+        void generatePawnMoves(MoveList &moves, Generate type) const;
+        void generateCastling(MoveList &moves) const;
+    };
+}
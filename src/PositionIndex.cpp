@@ -0,0 +1,249 @@
+#include "PositionIndex.h"
+#include "Pgn.h"
+#include "Position.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    using Chess::PositionIndex;
+
+    // Games parsed (and entries sorted) per task
+    constexpr std::size_t GAMES_PER_CHUNK = 512;
+
+    bool entryLess(const PositionIndex::Entry &a, const PositionIndex::Entry &b)
+    {
+        if (a.key != b.key)
+            return a.key < b.key;
+        return a.game != b.game ? a.game < b.game : a.ply < b.ply;
+    }
+
+    PositionIndex::Result parseResult(const std::string &result)
+    {
+        if (result == "1-0")
+            return PositionIndex::Result::WhiteWins;
+        if (result == "1/2-1/2")
+            return PositionIndex::Result::Draw;
+        if (result == "0-1")
+            return PositionIndex::Result::BlackWins;
+        return PositionIndex::Result::Unknown;
+    }
+}
+
+bool Chess::PositionIndex::build(const std::string &pgnPath, const std::string &indexPath, unsigned threads, BuildStatistics *statistics)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    MappedFile pgn;
+    if (!pgn.open(pgnPath))
+    {
+        std::cerr << "Could not open " << pgnPath << std::endl;
+        return false;
+    }
+
+    std::string_view text(reinterpret_cast<const char *>(pgn.data()), pgn.size());
+    auto ranges = splitPgn(text);
+    if (ranges.size() > UINT32_MAX)
+    {
+        std::cerr << "Too many games in " << pgnPath << std::endl;
+        return false;
+    }
+
+    // Every chunk replays its games and sorts its own entries
+    std::size_t chunkCount = (ranges.size() + GAMES_PER_CHUNK - 1) / GAMES_PER_CHUNK;
+    std::vector<GameEntry> games(ranges.size());
+    std::vector<std::vector<Entry>> chunks(chunkCount);
+    std::atomic<std::uint64_t> truncated = 0;
+
+    ThreadPool pool(threads);
+    pool.parallelFor(chunkCount, 1, [&](std::size_t begin, std::size_t end)
+                     {
+                         PgnGame game;
+                         for (std::size_t chunk = begin; chunk < end; chunk++)
+                         {
+                             auto &entries = chunks[chunk];
+                             std::size_t last = std::min(ranges.size(), (chunk + 1) * GAMES_PER_CHUNK);
+                             for (std::size_t index = chunk * GAMES_PER_CHUNK; index < last; index++)
+                             {
+                                 auto [offset, length] = ranges[index];
+                                 if (!readPgn(text.substr(offset, length), game))
+                                     truncated.fetch_add(1, std::memory_order_relaxed);
+
+                                 // A game from an unreadable FEN has no positions to index
+                                 Position position;
+                                 if (!game.fen.empty() && !position.setFen(game.fen))
+                                 {
+                                     games[index] = {offset, static_cast<std::uint32_t>(std::min<std::size_t>(length, UINT32_MAX)), 0, parseResult(game.result), 0};
+                                     continue;
+                                 }
+                                 if (game.moves.size() > UINT16_MAX)
+                                     game.moves.resize(UINT16_MAX);
+
+                                 auto gameIndex = static_cast<std::uint32_t>(index);
+                                 for (std::size_t ply = 0; ply <= game.moves.size(); ply++)
+                                 {
+                                     std::uint16_t move = ply < game.moves.size() ? game.moves[ply].raw() : 0;
+                                     entries.push_back({position.key(), gameIndex, static_cast<std::uint16_t>(ply), move});
+                                     if (move != 0)
+                                         position.makeMove(game.moves[ply]);
+                                 }
+
+                                 games[index] = {offset, static_cast<std::uint32_t>(std::min<std::size_t>(length, UINT32_MAX)),
+                                                 static_cast<std::uint16_t>(game.moves.size()), parseResult(game.result), 0};
+                             }
+                             std::sort(entries.begin(), entries.end(), entryLess);
+                         } });
+
+    // Pairwise merges, in parallel within each round
+    while (chunks.size() > 1)
+    {
+        std::vector<std::vector<Entry>> merged((chunks.size() + 1) / 2);
+        pool.parallelFor(merged.size(), 1, [&](std::size_t begin, std::size_t end)
+                         {
+                             for (std::size_t i = begin; i < end; i++)
+                             {
+                                 if (2 * i + 1 == chunks.size())
+                                 {
+                                     merged[i] = std::move(chunks[2 * i]);
+                                     continue;
+                                 }
+
+                                 auto &left = chunks[2 * i], &right = chunks[2 * i + 1];
+                                 merged[i].resize(left.size() + right.size());
+                                 std::merge(left.begin(), left.end(), right.begin(), right.end(), merged[i].begin(), entryLess);
+                                 std::vector<Entry>().swap(left);
+                                 std::vector<Entry>().swap(right);
+                             } });
+        chunks = std::move(merged);
+    }
+    std::vector<Entry> entries = chunks.empty() ? std::vector<Entry>() : std::move(chunks.front());
+
+    std::vector<std::uint64_t> fences(FENCE_COUNT + 1);
+    std::size_t cursor = 0;
+    for (std::size_t prefix = 0; prefix <= FENCE_COUNT; prefix++)
+    {
+        while (cursor < entries.size() && (entries[cursor].key >> (64 - FENCE_BITS)) < prefix)
+            cursor++;
+        fences[prefix] = cursor;
+    }
+
+    Header header;
+    header.gameCount = games.size();
+    header.entryCount = entries.size();
+    header.pgnSize = pgn.size();
+
+    std::ofstream out(indexPath, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(games.data()), static_cast<std::streamsize>(games.size() * sizeof(GameEntry)));
+    out.write(reinterpret_cast<const char *>(fences.data()), static_cast<std::streamsize>(fences.size() * sizeof(std::uint64_t)));
+    out.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+    if (!out)
+    {
+        std::cerr << "Could not write " << indexPath << std::endl;
+        return false;
+    }
+
+    if (statistics != nullptr)
+    {
+        statistics->games = games.size();
+        statistics->truncatedGames = truncated;
+        statistics->positions = entries.size();
+        statistics->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return true;
+}
+
+bool Chess::PositionIndex::open(const std::string &path)
+{
+    close();
+
+    if (!m_File.open(path))
+    {
+        std::cerr << "Could not open " << path << std::endl;
+        return false;
+    }
+
+    auto header = reinterpret_cast<const Header *>(m_File.data());
+    std::size_t fixed = sizeof(Header) + (FENCE_COUNT + 1) * sizeof(std::uint64_t);
+    if (m_File.size() < fixed || header->magic != MAGIC || header->version != VERSION ||
+        m_File.size() != fixed + header->gameCount * sizeof(GameEntry) + header->entryCount * sizeof(Entry))
+    {
+        std::cerr << path << " is not a position index" << std::endl;
+        m_File.close();
+        return false;
+    }
+
+    m_Header = header;
+    m_Games = reinterpret_cast<const GameEntry *>(m_File.data() + sizeof(Header));
+    m_Fences = reinterpret_cast<const std::uint64_t *>(m_Games + header->gameCount);
+    m_Entries = reinterpret_cast<const Entry *>(m_Fences + FENCE_COUNT + 1);
+    return true;
+}
+
+void Chess::PositionIndex::close()
+{
+    m_File.close();
+    m_Header = nullptr;
+    m_Games = nullptr;
+    m_Fences = nullptr;
+    m_Entries = nullptr;
+}
+
+std::span<const Chess::PositionIndex::Entry> Chess::PositionIndex::find(std::uint64_t key) const
+{
+    if (!isOpen())
+        return {};
+
+    std::size_t prefix = key >> (64 - FENCE_BITS);
+    auto first = m_Entries + m_Fences[prefix], last = m_Entries + m_Fences[prefix + 1];
+    auto lower = std::lower_bound(first, last, key, [](const Entry &entry, std::uint64_t value)
+                                  { return entry.key < value; });
+    auto upper = std::upper_bound(lower, last, key, [](std::uint64_t value, const Entry &entry)
+                                  { return value < entry.key; });
+    return {lower, upper};
+}
+
+std::vector<Chess::PositionIndex::MoveStatistics> Chess::PositionIndex::moveStatistics(std::uint64_t key) const
+{
+    std::vector<MoveStatistics> moves;
+    for (const auto &entry : find(key))
+    {
+        if (entry.move == 0)
+            continue;
+
+        auto move = PackedMove::fromRaw(entry.move);
+        auto it = std::find_if(moves.begin(), moves.end(), [move](const MoveStatistics &statistics)
+                               { return statistics.move == move; });
+        if (it == moves.end())
+        {
+            moves.push_back({move});
+            it = moves.end() - 1;
+        }
+
+        it->games++;
+        switch (m_Games[entry.game].result)
+        {
+        case Result::WhiteWins:
+            it->whiteWins++;
+            break;
+        case Result::Draw:
+            it->draws++;
+            break;
+        case Result::BlackWins:
+            it->blackWins++;
+            break;
+        default:
+            break;
+        }
+    }
+
+    std::stable_sort(moves.begin(), moves.end(), [](const MoveStatistics &a, const MoveStatistics &b)
+                     { return a.games > b.games; });
+    return moves;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "PackedMove.h"
+
+namespace Chess
+{
+    // On-disk map from position key (Zobrist, as Position::key) to every game and ply of a PGN
+    // archive that reached the position. Native byte order, in this order:
+    //
+    //   Header
+    //   GameEntry     games[gameCount]
+    //   std::uint64_t fences[FENCE_COUNT + 1] (first entry of each 16-bit key prefix)
+    //   Entry         entries[entryCount]     (sorted by key, then game and ply)
+    //
+    // The file is memory mapped, so a lookup reads two fences and binary searches the few
+    // entries between them: a couple of page touches however large the archive.
+    class PositionIndex
+    {
+    public:
+        static constexpr std::uint32_t MAGIC = 0x58444943; // "CIDX"
+        static constexpr std::uint32_t VERSION = 1;
+        static constexpr int FENCE_BITS = 16;
+        static constexpr std::size_t FENCE_COUNT = std::size_t(1) << FENCE_BITS;
+
+        enum class Result : std::uint8_t
+        {
+            WhiteWins,
+            Draw,
+            BlackWins,
+            Unknown,
+        };
+
+        struct Header
+        {
+            std::uint32_t magic = MAGIC;
+            std::uint32_t version = VERSION;
+            std::uint64_t gameCount = 0;
+            std::uint64_t entryCount = 0;
+            std::uint64_t pgnSize = 0; // To tell whether a PGN file is the one indexed
+        };
+
+        struct GameEntry
+        {
+            std::uint64_t offset = 0; // Byte range in the PGN file
+            std::uint32_t length = 0;
+            std::uint16_t plies = 0; // Moves read; fewer than in the file if one didn't parse
+            Result result = Result::Unknown;
+            std::uint8_t reserved = 0;
+        };
+
+        struct Entry
+        {
+            std::uint64_t key = 0;
+            std::uint32_t game = 0;
+            std::uint16_t ply = 0;
+            std::uint16_t move = 0; // Raw PackedMove played from the position, 0 at the end of the game
+        };
+
+        static_assert(sizeof(Header) == 32 && sizeof(GameEntry) == 16 && sizeof(Entry) == 16);
+
+        struct MoveStatistics
+        {
+            PackedMove move;
+            std::uint64_t games = 0;
+            std::uint64_t whiteWins = 0;
+            std::uint64_t draws = 0;
+            std::uint64_t blackWins = 0;
+
+            // Of the decided and drawn games, for White
+            double whiteScore() const
+            {
+                auto scored = whiteWins + draws + blackWins;
+                return scored == 0 ? 0.5 : (whiteWins + draws * 0.5) / scored;
+            }
+        };
+
+        struct BuildStatistics
+        {
+            std::uint64_t games = 0;
+            std::uint64_t truncatedGames = 0; // Indexed up to a move that didn't parse
+            std::uint64_t positions = 0;
+            double seconds = 0.0;
+        };
+
+    private:
+        MappedFile m_File;
+        const Header *m_Header = nullptr;
+        const GameEntry *m_Games = nullptr;
+        const std::uint64_t *m_Fences = nullptr;
+        const Entry *m_Entries = nullptr;
+
+    public:
+        // Replays every game of pgnPath on threads threads (0 = all) and writes the index. All
+        // entries are held in memory while sorting (16 bytes per position, twice while merging).
+        static bool build(const std::string &pgnPath, const std::string &indexPath, unsigned threads = 0, BuildStatistics *statistics = nullptr);
+
+        // False (with a message on std::cerr) if the file is missing or not a valid index
+        bool open(const std::string &path);
+        void close();
+
+        bool isOpen() const
+        {
+            return m_Header != nullptr;
+        }
+
+        std::uint64_t gameCount() const
+        {
+            return isOpen() ? m_Header->gameCount : 0;
+        }
+
+        std::uint64_t entryCount() const
+        {
+            return isOpen() ? m_Header->entryCount : 0;
+        }
+
+        std::uint64_t pgnSize() const
+        {
+            return isOpen() ? m_Header->pgnSize : 0;
+        }
+
+        const GameEntry &game(std::uint32_t index) const
+        {
+            return m_Games[index];
+        }
+
+        // Every occurrence of the position, by game and ply
+        std::span<const Entry> find(std::uint64_t key) const;
+
+        // Moves played from the position, most frequent first
+        std::vector<MoveStatistics> moveStatistics(std::uint64_t key) const;
+    };
+}
@@ -0,0 +1,124 @@
+#ifdef CHESS_PROFILING
+
+#include "Profiler.h"
+#include "AllocTracker.h"
+
+#include <imgui.h>
+
+#include <cfloat>
+#include <cstdio>
+
+// PROFILER
+
+Chess::Profiler &Chess::Profiler::get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void Chess::Profiler::beginSection(Section section)
+{
+    auto now = Clock::now();
+
+    if (!m_FrameStarted)
+    {
+        m_FrameStarted = true;
+        m_CurrentSections.fill(0.0f);
+        m_FrameStartAllocations = AllocTracker::threadCounters().allocations;
+    }
+
+    closeSection(now);
+    m_CurrentSection = section;
+    m_SectionStart = now;
+}
+
+void Chess::Profiler::closeSection(Clock::time_point now)
+{
+    if (m_CurrentSection == SectionCount)
+        return;
+
+    m_CurrentSections[m_CurrentSection] += std::chrono::duration<float, std::milli>(now - m_SectionStart).count();
+    m_CurrentSection = SectionCount;
+}
+
+void Chess::Profiler::endFrame()
+{
+    auto now = Clock::now();
+    closeSection(now);
+
+    for (int i = 0; i < SectionCount; i++)
+    {
+        m_SectionHistory[i][m_HistoryOffset] = m_CurrentSections[i];
+    }
+
+    // Whole loop period, including the frame limiter sleep in display()
+    m_FrameHistory[m_HistoryOffset] = m_FrameStart == Clock::time_point() ? 0.0f : std::chrono::duration<float, std::milli>(now - m_FrameStart).count();
+    m_AllocationHistory[m_HistoryOffset] = static_cast<float>(AllocTracker::threadCounters().allocations - m_FrameStartAllocations);
+
+    m_HistoryOffset = (m_HistoryOffset + 1) % HISTORY_SIZE;
+    m_FrameStart = now;
+    m_FrameStarted = false;
+}
+
+void Chess::Profiler::record(Probe probe, std::uint64_t ns)
+{
+    auto &stats = m_Probes[probe];
+    stats.calls++;
+    stats.totalNs += ns;
+    stats.lastNs = ns;
+    if (ns > stats.maxNs)
+        stats.maxNs = ns;
+}
+
+void Chess::Profiler::prepareGUI()
+{
+    if (!ImGui::CollapsingHeader("Performance"))
+        return;
+
+    static const char *SECTION_NAMES[SectionCount] = {"Update", "GUI", "Draw"};
+    static const char *PROBE_NAMES[ProbeCount] = {"calculatePossibleMoves", "registerMove", "registerCastlingMove", "registerEnPassantMove", "undoLastMove"};
+
+    // Frame times
+    int last = (m_HistoryOffset + HISTORY_SIZE - 1) % HISTORY_SIZE;
+    char overlay[32];
+
+    std::snprintf(overlay, sizeof(overlay), "%.2f ms", m_FrameHistory[last]);
+    ImGui::PlotHistogram("Frame", m_FrameHistory.data(), HISTORY_SIZE, m_HistoryOffset, overlay, 0.0f, 33.3f, ImVec2(0, 40));
+
+    for (int i = 0; i < SectionCount; i++)
+    {
+        std::snprintf(overlay, sizeof(overlay), "%.3f ms", m_SectionHistory[i][last]);
+        ImGui::PlotHistogram(SECTION_NAMES[i], m_SectionHistory[i].data(), HISTORY_SIZE, m_HistoryOffset, overlay, 0.0f, 8.0f, ImVec2(0, 30));
+    }
+
+    std::snprintf(overlay, sizeof(overlay), "%.0f", m_AllocationHistory[last]);
+    ImGui::PlotHistogram("Allocs", m_AllocationHistory.data(), HISTORY_SIZE, m_HistoryOffset, overlay, 0.0f, FLT_MAX, ImVec2(0, 30));
+
+    // Hot paths
+    ImGui::TextColored(ImColor(255, 255, 128), "Calls (last / avg / max us):");
+    for (int i = 0; i < ProbeCount; i++)
+    {
+        const auto &stats = m_Probes[i];
+        if (stats.calls == 0)
+        {
+            ImGui::Text("%s: -", PROBE_NAMES[i]);
+            continue;
+        }
+
+        ImGui::Text("%s: %.2f / %.2f / %.2f (%llu)", PROBE_NAMES[i],
+                    stats.lastNs / 1000.0, stats.totalNs / 1000.0 / stats.calls, stats.maxNs / 1000.0,
+                    static_cast<unsigned long long>(stats.calls));
+    }
+
+    // Engine
+    if (m_EngineStats.running)
+    {
+        ImGui::Text("Engine: %.0f knps, hash %.1f%%, pawn hash hits %.1f%%", m_EngineStats.nodesPerSecond / 1000.0, m_EngineStats.hashFull / 10.0, m_EngineStats.pawnHitRate);
+    }
+    else
+    {
+        ImGui::TextDisabled("Engine: idle");
+    }
+}
+
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace Chess
+{
+    // Frame and hot-path timings shown in the "Performance" panel.
+    // Everything is compiled out unless CHESS_PROFILING is defined (see CMakeLists.txt).
+    class Profiler
+    {
+    public:
+        enum Section
+        {
+            Update,
+            GUI,
+            Draw,
+            SectionCount,
+        };
+
+        enum Probe
+        {
+            CalculatePossibleMoves,
+            RegisterMove,
+            RegisterCastlingMove,
+            RegisterEnPassantMove,
+            UndoLastMove,
+            ProbeCount,
+        };
+
+        struct EngineStats
+        {
+            bool running = false;
+            double nodesPerSecond = 0.0;
+            int hashFull = 0; // Permille
+            double pawnHitRate = 0.0; // Percent of evaluations, hand-crafted evaluation only
+        };
+
+        static constexpr int HISTORY_SIZE = 120;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct ProbeStats
+        {
+            std::uint64_t calls = 0;
+            std::uint64_t totalNs = 0;
+            std::uint64_t lastNs = 0;
+            std::uint64_t maxNs = 0;
+        };
+
+        // Rolling histories (milliseconds / allocations), indexed by m_HistoryOffset
+        std::array<std::array<float, HISTORY_SIZE>, SectionCount> m_SectionHistory{};
+        std::array<float, HISTORY_SIZE> m_FrameHistory{};
+        std::array<float, HISTORY_SIZE> m_AllocationHistory{};
+        int m_HistoryOffset = 0;
+
+        // Current frame
+        std::array<float, SectionCount> m_CurrentSections{};
+        Section m_CurrentSection = SectionCount;
+        Clock::time_point m_SectionStart;
+        Clock::time_point m_FrameStart;
+        std::uint64_t m_FrameStartAllocations = 0;
+        bool m_FrameStarted = false;
+
+        std::array<ProbeStats, ProbeCount> m_Probes{};
+        EngineStats m_EngineStats;
+
+    public:
+        static Profiler &get();
+
+        // Frame markers (called from the game loop)
+        void beginSection(Section section);
+        void endFrame();
+
+        void record(Probe probe, std::uint64_t ns);
+
+        void setEngineStats(const EngineStats &stats)
+        {
+            m_EngineStats = stats;
+        }
+
+        void prepareGUI();
+
+    private:
+        void closeSection(Clock::time_point now);
+    };
+
+    class ScopedProbe
+    {
+    private:
+        Profiler::Probe m_Probe;
+        std::chrono::steady_clock::time_point m_Start;
+
+    public:
+        explicit ScopedProbe(Profiler::Probe probe)
+            : m_Probe(probe), m_Start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~ScopedProbe()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - m_Start;
+            Profiler::get().record(m_Probe, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    };
+}
+
+#ifdef CHESS_PROFILING
+#define CHESS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define CHESS_PROFILE_CONCAT(a, b) CHESS_PROFILE_CONCAT_IMPL(a, b)
+#define CHESS_PROFILE_PROBE(probe) Chess::ScopedProbe CHESS_PROFILE_CONCAT(profileProbe, __LINE__)(Chess::Profiler::Probe::probe)
+#define CHESS_PROFILE_SECTION(section) Chess::Profiler::get().beginSection(Chess::Profiler::Section::section)
+#define CHESS_PROFILE_FRAME_END() Chess::Profiler::get().endFrame()
+#else
+#define CHESS_PROFILE_PROBE(probe) ((void)0)
+#define CHESS_PROFILE_SECTION(section) ((void)0)
+#define CHESS_PROFILE_FRAME_END() ((void)0)
+#endif
@@ -0,0 +1,521 @@
+#include "Search.h"
+#include "Evaluation.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    // Whether a stored score settles the node for the window (alpha, beta)
+    bool boundCutoff(const Chess::TranspositionTable::Entry &entry, int alpha, int beta)
+    {
+        using Bound = Chess::TranspositionTable::Bound;
+        return entry.bound == Bound::Exact ||
+               (entry.bound == Bound::Lower && entry.score >= beta) ||
+               (entry.bound == Bound::Upper && entry.score <= alpha);
+    }
+}
+
+Chess::Search::Search(const Nnue::Network *network)
+    : m_Network(network), m_Accumulators(MAX_PLY + 1)
+{
+}
+
+Chess::SearchResult Chess::Search::run(Position &position, const SearchLimits &limits)
+{
+    m_Start = Clock::now();
+
+    m_Aborted = false;
+    m_Nodes = 0;
+    m_NodesSearched.store(0, std::memory_order_relaxed);
+    m_NodeLimit = limits.nodes;
+    m_Limits = limits;
+    m_Pondering = limits.ponder;
+
+    m_Killers = {};
+    m_CounterMoves = {};
+    m_History.age();
+
+    if (m_Table != nullptr && m_AgeTable)
+        m_Table->newSearch();
+
+    m_UseClock = limits.timeLeftMs > 0;
+    if (m_UseClock)
+        m_TimeManager.start(TimeManager::allocate(limits.timeLeftMs, limits.incrementMs, limits.movesToGo, position));
+
+    // A ponder search gets its deadline on ponderhit
+    m_HasDeadline = false;
+    if (!m_Pondering)
+        setDeadline(m_Start);
+
+    if (m_Network != nullptr)
+    {
+        m_Network->refresh(m_Accumulators[0], 0, position.board());
+        m_Network->refresh(m_Accumulators[0], 1, position.board());
+    }
+
+    // Never more lines than legal moves
+    MoveList rootMoves;
+    position.generateLegal(rootMoves);
+    int lineCount = std::clamp(limits.multiPv, 1, std::max(1, static_cast<int>(rootMoves.size())));
+    std::vector<PvLine> previousLines;
+
+    SearchResult result;
+    for (int depth = 1; depth <= std::min(limits.depth, MAX_PLY); depth++)
+    {
+        CHESS_TRACE_SCOPE("Search iteration");
+
+        // Each further line searches the root without the first moves of the lines before it
+        std::vector<PvLine> lines;
+        m_ExcludedRootMoves.clear();
+        for (int line = 0; line < lineCount; line++)
+        {
+            m_PreviousPvLength = 0;
+            if (line < static_cast<int>(previousLines.size()))
+            {
+                const auto &previous = previousLines[line].pv;
+                std::copy(previous.begin(), previous.end(), m_PreviousPv.begin());
+                m_PreviousPvLength = static_cast<int>(previous.size());
+            }
+
+            m_FollowPv = true;
+            int score = negamax(position, depth, -INFINITE_SCORE, INFINITE_SCORE, 0);
+            if (m_Aborted)
+                break;
+
+            PvLine pvLine{score, std::vector<PackedMove>(m_Pv[0].begin(), m_Pv[0].begin() + m_PvLength[0])};
+            extendPv(position, pvLine.pv, depth);
+            if (pvLine.pv.empty() && line > 0)
+                break;
+            if (!pvLine.pv.empty())
+                m_ExcludedRootMoves.push_back(pvLine.pv.front());
+            lines.push_back(std::move(pvLine));
+        }
+        m_ExcludedRootMoves.clear();
+
+        // An interrupted iteration is only trusted for its first move
+        if (m_Aborted)
+        {
+            if (result.bestMove.isNone() && !lines.empty() && !lines.front().pv.empty())
+                result.bestMove = lines.front().pv.front();
+            else if (result.bestMove.isNone() && lines.empty() && m_PvLength[0] > 0)
+                result.bestMove = m_Pv[0][0];
+            break;
+        }
+
+        std::stable_sort(lines.begin(), lines.end(), [](const PvLine &a, const PvLine &b)
+                         { return a.score > b.score; });
+
+        result.score = lines.front().score;
+        result.depth = depth;
+        result.pv = lines.front().pv;
+        result.bestMove = result.pv.empty() ? PackedMove() : result.pv.front();
+        result.lines = lines;
+        previousLines = std::move(lines);
+
+        if (m_OnIteration)
+        {
+            result.nodes = m_Nodes;
+            result.timeMs = elapsedMs();
+            m_OnIteration(result);
+        }
+
+        // No need to look further once every line is a mate (or with nothing to play)
+        if (result.pv.empty() || std::all_of(result.lines.begin(), result.lines.end(), [](const PvLine &line)
+                                             { return isMateScore(line.score); }))
+            break;
+
+        pollPonderHit();
+        if (m_Aborted)
+            break;
+        if (m_UseClock && !m_Pondering && !m_TimeManager.continueSearch(elapsedMs(), result.bestMove, result.score))
+            break;
+    }
+
+    // A ponder search that ran out of depth waits for the opponent's move
+    while (m_Pondering && !m_StopRequested.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pollPonderHit();
+    }
+
+    // Something legal must come out even if the first iteration was cut short
+    if (result.bestMove.isNone() && rootMoves.size() > 0)
+        result.bestMove = rootMoves.moves[0];
+
+    result.nodes = m_Nodes;
+    result.timeMs = elapsedMs();
+    m_NodesSearched.store(m_Nodes, std::memory_order_relaxed);
+    flushTableStatistics();
+
+    resetSignals();
+    return result;
+}
+
+void Chess::Search::checkLimits()
+{
+    pollPonderHit();
+    flushTableStatistics();
+    m_NodesSearched.store(m_Nodes, std::memory_order_relaxed);
+
+    if (m_StopRequested.load(std::memory_order_relaxed))
+        m_Aborted = true;
+    else if (!m_Pondering && ((m_NodeLimit != 0 && m_Nodes >= m_NodeLimit) || (m_HasDeadline && Clock::now() >= m_Deadline)))
+        m_Aborted = true;
+}
+
+void Chess::Search::pollPonderHit()
+{
+    if (!m_Pondering || !m_PonderHit.load(std::memory_order_relaxed))
+        return;
+
+    // The opponent played the predicted move: from now on this is our own clock
+    m_Pondering = false;
+    setDeadline(Clock::now());
+
+    // Pondering already took as long as this move deserved: play the last completed iteration
+    if (m_UseClock && elapsedMs() >= m_TimeManager.budget().optimumMs)
+        m_Aborted = true;
+}
+
+void Chess::Search::setDeadline(Clock::time_point from)
+{
+    std::int64_t limitMs = m_Limits.moveTimeMs;
+    if (m_UseClock)
+        limitMs = limitMs > 0 ? std::min(limitMs, m_TimeManager.budget().maximumMs) : m_TimeManager.budget().maximumMs;
+
+    m_HasDeadline = limitMs > 0;
+    m_Deadline = from + std::chrono::milliseconds(limitMs);
+}
+
+std::int64_t Chess::Search::elapsedMs() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_Start).count();
+}
+
+int Chess::Search::evaluate(const Position &position, int ply)
+{
+    if (m_Network != nullptr)
+        return m_Network->evaluate(m_Accumulators[ply], position.sideToMove());
+    return Evaluation::evaluate(position, &m_PawnTable);
+}
+
+void Chess::Search::makeMove(Position &position, PackedMove move, int ply)
+{
+    if (m_Network == nullptr)
+    {
+        position.makeMove(move);
+        if (m_Table != nullptr)
+            m_Table->prefetch(position.key());
+        return;
+    }
+
+    Nnue::DirtyPieces dirty;
+    position.makeMove(move, &dirty);
+
+    // The accumulator update hides the latency of the child's table probe
+    if (m_Table != nullptr)
+        m_Table->prefetch(position.key());
+
+    auto &accumulator = m_Accumulators[ply + 1];
+    accumulator = m_Accumulators[ply];
+
+    int refresh = m_Network->update(accumulator, {position.kingSquare(0), position.kingSquare(1)}, dirty);
+    for (int perspective = 0; perspective < 2; perspective++)
+    {
+        if (refresh & (1 << perspective))
+            m_Network->refresh(accumulator, perspective, position.board());
+    }
+}
+
+bool Chess::Search::probeTable(const Position &position, TranspositionTable::Entry &entry, int ply)
+{
+    if (m_Table == nullptr)
+        return false;
+
+    if (!m_Table->probe(position.key(), entry))
+    {
+        m_TableMisses++;
+        return false;
+    }
+    m_TableHits++;
+
+    // Stored mates count from the node that found them
+    if (entry.score >= MATE_BOUND)
+        entry.score -= ply;
+    else if (entry.score <= -MATE_BOUND)
+        entry.score += ply;
+    return true;
+}
+
+void Chess::Search::storeTable(const Position &position, PackedMove move, int score, int depth, int alpha, int beta, int ply)
+{
+    if (m_Table == nullptr)
+        return;
+
+    using Bound = TranspositionTable::Bound;
+    Bound bound = score >= beta ? Bound::Lower : score > alpha ? Bound::Exact : Bound::Upper;
+
+    // No move of a fail-low node is better than any other
+    if (bound == Bound::Upper)
+        move = {};
+
+    if (score >= MATE_BOUND)
+        score += ply;
+    else if (score <= -MATE_BOUND)
+        score -= ply;
+
+    m_Table->store(position.key(), move, score, depth, bound);
+}
+
+void Chess::Search::flushTableStatistics()
+{
+    if (m_Table != nullptr)
+        m_Table->recordProbes(m_TableHits, m_TableMisses);
+    m_TableHits = 0;
+    m_TableMisses = 0;
+}
+
+void Chess::Search::extendPv(Position &position, std::vector<PackedMove> &pv, int length)
+{
+    if (m_Table == nullptr)
+        return;
+
+    for (auto move : pv)
+        position.makeMove(move);
+
+    TranspositionTable::Entry entry;
+    while (pv.size() < static_cast<std::size_t>(length) && !position.isDraw() && m_Table->probe(position.key(), entry))
+    {
+        // Any key collision shows up here as a move that doesn't fit the position
+        if (entry.move.isNone() || !position.isPseudoLegal(entry.move) || !position.isLegal(entry.move))
+            break;
+        pv.push_back(entry.move);
+        position.makeMove(entry.move);
+    }
+
+    for (std::size_t i = 0; i < pv.size(); i++)
+        position.unmakeMove();
+}
+
+Chess::PackedMove Chess::Search::counterMove(const Position &position) const
+{
+    const auto &history = position.history();
+    if (history.empty() || history.back().move.isNone())
+        return {};
+
+    int to = history.back().move.to();
+    return m_CounterMoves[position.pieceAt(to)][to];
+}
+
+void Chess::Search::updateQuietStatistics(const Position &position, PackedMove move, int depth, int ply, const std::array<PackedMove, 64> &tried, int triedCount)
+{
+    auto &killers = m_Killers[ply];
+    if (killers[0] != move)
+    {
+        killers[1] = killers[0];
+        killers[0] = move;
+    }
+
+    const auto &history = position.history();
+    if (!history.empty() && !history.back().move.isNone())
+    {
+        int to = history.back().move.to();
+        m_CounterMoves[position.pieceAt(to)][to] = move;
+    }
+
+    // Deeper cutoffs say more; the quiets that failed before it lose as much
+    int bonus = std::min(depth * depth * 16, HistoryTable::MAX / 4);
+    int side = position.sideToMove();
+    m_History.update(side, move, bonus);
+    for (int i = 0; i < triedCount; i++)
+        m_History.update(side, tried[i], -bonus);
+}
+
+int Chess::Search::negamax(Position &position, int depth, int alpha, int beta, int ply)
+{
+    m_PvLength[ply] = 0;
+    m_Nodes++;
+
+    if ((m_Nodes & 1023) == 0)
+        checkLimits();
+    if (m_Aborted)
+        return 0;
+
+    if (ply > 0 && position.isDraw())
+        return 0;
+
+    bool inCheck = position.inCheck();
+    if (inCheck)
+        depth++; // Look one ply past checks
+
+    if (ply >= MAX_PLY)
+        return evaluate(position, ply);
+    if (depth <= 0)
+        return quiescence(position, alpha, beta, ply);
+
+    // Below the root a deep enough stored result whose bound fits the window ends the node
+    TranspositionTable::Entry entry;
+    bool tableHit = probeTable(position, entry, ply);
+    if (tableHit && ply > 0 && entry.depth >= depth && boundCutoff(entry, alpha, beta))
+        return entry.score;
+
+    PackedMove pvMove = m_FollowPv && ply < m_PreviousPvLength ? m_PreviousPv[ply] : PackedMove();
+    PackedMove hashMove = !pvMove.isNone() || !tableHit ? pvMove : entry.move;
+    MovePicker picker(position, hashMove, m_Killers[ply], counterMove(position), m_History);
+
+    int originalAlpha = alpha;
+    PackedMove bestMove;
+
+    std::array<PackedMove, 64> quietsTried;
+    int quietCount = 0;
+    int legalMoves = 0;
+
+    int best = -INFINITE_SCORE;
+    for (auto move = picker.next(); !move.isNone(); move = picker.next())
+    {
+        if (ply == 0 && std::find(m_ExcludedRootMoves.begin(), m_ExcludedRootMoves.end(), move) != m_ExcludedRootMoves.end())
+            continue;
+        if (!position.isLegal(move))
+            continue;
+        legalMoves++;
+
+        bool quiet = MovePicker::isQuiet(position, move);
+
+        // Only the first move of a node on the previous PV continues it
+        m_FollowPv = m_FollowPv && move == pvMove;
+        makeMove(position, move, ply);
+        int score = -negamax(position, depth - 1, -beta, -alpha, ply + 1);
+        position.unmakeMove();
+        m_FollowPv = false;
+
+        if (m_Aborted)
+            return 0;
+
+        if (score > best)
+        {
+            best = score;
+            if (score > alpha)
+            {
+                alpha = score;
+                bestMove = move;
+
+                // Extend the principal variation
+                m_Pv[ply][0] = move;
+                std::copy_n(m_Pv[ply + 1].begin(), m_PvLength[ply + 1], m_Pv[ply].begin() + 1);
+                m_PvLength[ply] = m_PvLength[ply + 1] + 1;
+
+                if (alpha >= beta)
+                {
+                    if (quiet)
+                        updateQuietStatistics(position, move, depth, ply, quietsTried, quietCount);
+                    break;
+                }
+            }
+        }
+
+        if (quiet && quietCount < static_cast<int>(quietsTried.size()))
+            quietsTried[quietCount++] = move;
+    }
+
+    if (legalMoves == 0)
+        best = inCheck ? -MATE_SCORE + ply : 0;
+
+    // A root searched without some of its moves has no result of its own
+    if (ply > 0 || m_ExcludedRootMoves.empty())
+        storeTable(position, bestMove, best, depth, originalAlpha, beta, ply);
+    return best;
+}
+
+int Chess::Search::quiescence(Position &position, int alpha, int beta, int ply)
+{
+    // A capture that can't bring the score near alpha even with this margin is skipped
+    constexpr int DELTA_MARGIN = 200;
+
+    m_PvLength[ply] = 0;
+    m_Nodes++;
+
+    if ((m_Nodes & 1023) == 0)
+        checkLimits();
+    if (m_Aborted)
+        return 0;
+
+    if (position.isDraw())
+        return 0;
+    if (ply >= MAX_PLY)
+        return evaluate(position, ply);
+
+    // Any stored result is at least as deep as this
+    TranspositionTable::Entry entry;
+    if (probeTable(position, entry, ply) && boundCutoff(entry, alpha, beta))
+        return entry.score;
+
+    int originalAlpha = alpha;
+    PackedMove bestMove;
+
+    // Out of check the side to move can stand pat: some quiet move is assumed at least as good
+    bool inCheck = position.inCheck();
+    int best = -INFINITE_SCORE;
+    int standPat = 0;
+    if (!inCheck)
+    {
+        standPat = evaluate(position, ply);
+        if (standPat >= beta)
+            return standPat;
+        alpha = std::max(alpha, standPat);
+        best = standPat;
+    }
+
+    MovePicker picker = inCheck ? MovePicker(position, {}, m_Killers[ply], {}, m_History) : MovePicker(position, m_History);
+
+    int legalMoves = 0;
+    for (auto move = picker.next(); !move.isNone(); move = picker.next())
+    {
+        if (!position.isLegal(move))
+            continue;
+        legalMoves++;
+
+        if (!inCheck)
+        {
+            if (move.kind() == PackedMove::Promotion && move.promotionType() != PieceType::Queen)
+                continue;
+
+            // Delta pruning
+            int captured = move.kind() == PackedMove::EnPassant ? PieceType::Pawn : position.pieceAt(move.to()) & 7;
+            int promotion = move.kind() == PackedMove::Promotion ? Evaluation::PIECE_VALUES[PieceType::Queen] - Evaluation::PIECE_VALUES[PieceType::Pawn] : 0;
+            if (standPat + Evaluation::PIECE_VALUES[captured] + promotion + DELTA_MARGIN <= alpha)
+                continue;
+        }
+
+        makeMove(position, move, ply);
+        int score = -quiescence(position, -beta, -alpha, ply + 1);
+        position.unmakeMove();
+
+        if (m_Aborted)
+            return 0;
+
+        if (score > best)
+        {
+            best = score;
+            if (score > alpha)
+            {
+                alpha = score;
+                bestMove = move;
+
+                m_Pv[ply][0] = move;
+                std::copy_n(m_Pv[ply + 1].begin(), m_PvLength[ply + 1], m_Pv[ply].begin() + 1);
+                m_PvLength[ply] = m_PvLength[ply + 1] + 1;
+
+                if (alpha >= beta)
+                    break;
+            }
+        }
+    }
+
+    if (inCheck && legalMoves == 0)
+        best = -MATE_SCORE + ply;
+
+    storeTable(position, bestMove, best, 0, originalAlpha, beta, ply);
+    return best;
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "MovePicker.h"
+#include "Nnue.h"
+#include "PawnTable.h"
+#include "Position.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
+
+namespace Chess
+{
+    struct SearchLimits
+    {
+        int depth = 64;
+        std::uint64_t nodes = 0;    // 0 = unlimited
+        std::int64_t moveTimeMs = 0; // 0 = unlimited
+
+        // Clock of the side to move, split by the TimeManager
+        std::int64_t timeLeftMs = 0; // 0 = no clock
+        std::int64_t incrementMs = 0;
+        int movesToGo = 0; // 0 = sudden death
+
+        // Search on the opponent's time: no limit applies and run() does not return before
+        // ponderHit() or stop(). After a ponderhit the limits above count from that moment.
+        bool ponder = false;
+
+        // Number of best root moves searched to full depth, each with its own line
+        int multiPv = 1;
+    };
+
+    struct PvLine
+    {
+        int score = 0;
+        std::vector<PackedMove> pv;
+    };
+
+    struct SearchResult
+    {
+        PackedMove bestMove;
+        int score = 0; // Centipawns for the side to move, or a mate score
+        int depth = 0; // Last completed iteration
+        std::uint64_t nodes = 0;
+        std::int64_t timeMs = 0;
+        std::vector<PackedMove> pv;
+        std::vector<PvLine> lines; // Best first; the first one is score and pv above
+    };
+
+    // Iterative deepening alpha-beta. One instance per thread; the network (if any) is shared read-only.
+    class Search
+    {
+    public:
+        // Called from the searching thread after every completed iteration
+        using IterationCallback = std::function<void(const SearchResult &)>;
+
+        static constexpr int MAX_PLY = 128;
+        static constexpr int MATE_SCORE = 32000;
+        static constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY; // Beyond this a score is a forced mate
+        static constexpr int INFINITE_SCORE = 32001;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        const Nnue::Network *m_Network;
+        TranspositionTable *m_Table = nullptr;
+        bool m_AgeTable = true;
+        IterationCallback m_OnIteration;
+
+        // Probe counters, flushed to the table now and then
+        std::uint64_t m_TableHits = 0;
+        std::uint64_t m_TableMisses = 0;
+
+        // Hand-crafted evaluation only, kept from one search to the next
+        PawnTable m_PawnTable;
+
+        std::atomic<bool> m_StopRequested = false;
+        std::atomic<bool> m_PonderHit = false;
+        bool m_Aborted = false;
+        bool m_Pondering = false;
+
+        std::uint64_t m_Nodes = 0;
+        std::atomic<std::uint64_t> m_NodesSearched = 0; // m_Nodes published for other threads
+        std::uint64_t m_NodeLimit = 0;
+        Clock::time_point m_Start;
+        Clock::time_point m_Deadline;
+        bool m_HasDeadline = false;
+
+        SearchLimits m_Limits;
+        TimeManager m_TimeManager;
+        bool m_UseClock = false;
+
+        // Indexed by ply
+        std::vector<Nnue::Accumulator> m_Accumulators;
+        std::array<std::array<PackedMove, MAX_PLY + 1>, MAX_PLY + 1> m_Pv;
+        std::array<int, MAX_PLY + 1> m_PvLength{};
+
+        // Root moves of the lines already found in this iteration (multi-PV)
+        std::vector<PackedMove> m_ExcludedRootMoves;
+
+        // Move ordering. The previous iteration's PV comes first along its path, then the hash move.
+        std::array<PackedMove, MAX_PLY + 1> m_PreviousPv;
+        int m_PreviousPvLength = 0;
+        bool m_FollowPv = false;
+
+        std::array<std::array<PackedMove, 2>, MAX_PLY + 1> m_Killers;
+        std::array<std::array<PackedMove, 64>, 16> m_CounterMoves; // By piece code and destination of the previous move
+        HistoryTable m_History;
+
+    public:
+        // Without a network the hand-crafted evaluation is used
+        explicit Search(const Nnue::Network *network = nullptr);
+
+        // Only between searches
+        void setNetwork(const Nnue::Network *network)
+        {
+            m_Network = network;
+        }
+
+        // Without a table every search starts from scratch. Only between searches; several
+        // searches may share one table, and only one of them (ageTable) starts a new
+        // generation in it per search.
+        void setTranspositionTable(TranspositionTable *table, bool ageTable = true)
+        {
+            m_Table = table;
+            m_AgeTable = ageTable;
+        }
+
+        // Only between searches
+        void setIterationCallback(IterationCallback callback)
+        {
+            m_OnIteration = std::move(callback);
+        }
+
+        // The position is searched in place and left as it was
+        SearchResult run(Position &position, const SearchLimits &limits);
+
+        // Safe to call from another thread; run() returns its best move so far. A stop (or
+        // ponderhit) that arrives before run() has started still applies to it.
+        void stop()
+        {
+            m_StopRequested = true;
+        }
+
+        // The move a ponder search assumed was played: switch to the normal limits
+        void ponderHit()
+        {
+            m_PonderHit = true;
+        }
+
+        // Drops a stop or ponderhit that arrived after the last run() ended (only between searches)
+        void resetSignals()
+        {
+            m_StopRequested = false;
+            m_PonderHit = false;
+        }
+
+        // Nodes of the running (or last) search, safe from any thread; lags by up to 1024 nodes
+        std::uint64_t nodesSearched() const
+        {
+            return m_NodesSearched.load(std::memory_order_relaxed);
+        }
+
+        // Counters are safe to read from any thread
+        const PawnTable &pawnTable() const
+        {
+            return m_PawnTable;
+        }
+
+        static bool isMateScore(int score)
+        {
+            return score >= MATE_BOUND || score <= -MATE_BOUND;
+        }
+
+    private:
+        int negamax(Position &position, int depth, int alpha, int beta, int ply);
+
+        // Captures only (all evasions in check) until the position is quiet
+        int quiescence(Position &position, int alpha, int beta, int ply);
+        int evaluate(const Position &position, int ply);
+
+        void makeMove(Position &position, PackedMove move, int ply);
+
+        // Table lookups with mate scores converted between "from this node" and "from the root"
+        bool probeTable(const Position &position, TranspositionTable::Entry &entry, int ply);
+        void storeTable(const Position &position, PackedMove move, int score, int depth, int alpha, int beta, int ply);
+        void flushTableStatistics();
+
+        // Continues a PV cut short by table hits with the stored moves
+        void extendPv(Position &position, std::vector<PackedMove> &pv, int length);
+
+        PackedMove counterMove(const Position &position) const;
+
+        // A quiet move caused a beta cutoff after the quiets in tried
+        void updateQuietStatistics(const Position &position, PackedMove move, int depth, int ply, const std::array<PackedMove, 64> &tried, int triedCount);
+
+        // Sets m_Aborted once a limit is hit
+        void checkLimits();
+
+        // Leaves ponder mode once ponderHit() was called
+        void pollPonderHit();
+        void setDeadline(Clock::time_point from);
+        std::int64_t elapsedMs() const;
+    };
+}
@@ -0,0 +1,264 @@
+#include "SessionServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// macOS has SO_NOSIGPIPE instead
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+#ifdef _WIN32
+
+bool Chess::SessionServer::isSupported()
+{
+    return false;
+}
+
+bool Chess::SessionServer::start(const std::string &)
+{
+    std::cerr << "Unix-domain sockets are not supported on this platform" << std::endl;
+    return false;
+}
+
+void Chess::SessionServer::stop()
+{
+}
+
+#else
+
+namespace
+{
+    // Full reads and writes over a stream socket
+    bool readAll(int socket, char *data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            auto count = ::read(socket, data, size);
+            if (count <= 0)
+                return false;
+            data += count;
+            size -= static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+
+    bool writeAll(int socket, const char *data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            auto count = ::send(socket, data, size, MSG_NOSIGNAL);
+            if (count <= 0)
+                return false;
+            data += count;
+            size -= static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+}
+
+bool Chess::SessionServer::isSupported()
+{
+    return true;
+}
+
+bool Chess::SessionServer::start(const std::string &path)
+{
+    stop();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    m_ListenSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_ListenSocket < 0)
+        return false;
+
+    ::unlink(path.c_str());
+    if (::bind(m_ListenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(m_ListenSocket, 64) != 0)
+    {
+        std::cerr << "Could not listen on " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(m_ListenSocket);
+        m_ListenSocket = -1;
+        return false;
+    }
+
+    m_Path = path;
+    m_AcceptThread = std::thread([this]
+                                 { acceptLoop(); });
+    return true;
+}
+
+void Chess::SessionServer::stop()
+{
+    if (m_ListenSocket < 0)
+        return;
+
+    // Wakes accept() up
+    ::shutdown(m_ListenSocket, SHUT_RDWR);
+    ::close(m_ListenSocket);
+    m_ListenSocket = -1;
+    m_AcceptThread.join();
+
+    std::lock_guard lock(m_ConnectionsMutex);
+    for (auto &connection : m_Connections)
+    {
+        // Readers that are done have closed their socket, and its number may be reused
+        {
+            std::lock_guard connectionLock(connection->mutex);
+            if (connection->socket >= 0)
+                ::shutdown(connection->socket, SHUT_RDWR);
+        }
+        connection->reader.join();
+    }
+    m_Connections.clear();
+
+    ::unlink(m_Path.c_str());
+}
+
+void Chess::SessionServer::acceptLoop()
+{
+    while (true)
+    {
+        int socket = ::accept(m_ListenSocket, nullptr, nullptr);
+        if (socket < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return; // Listening socket closed
+        }
+
+#ifdef SO_NOSIGPIPE
+        int noSignal = 1;
+        ::setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+#endif
+
+        auto connection = std::make_shared<Connection>();
+        connection->socket = socket;
+
+        std::lock_guard lock(m_ConnectionsMutex);
+
+        // Reap clients that went away
+        std::erase_if(m_Connections, [](const std::shared_ptr<Connection> &old)
+                      {
+            if (!old->finished)
+                return false;
+            old->reader.join();
+            return true; });
+
+        connection->reader = std::thread([this, connection]
+                                         { readLoop(connection); });
+        m_Connections.push_back(connection);
+    }
+}
+
+void Chess::SessionServer::readLoop(std::shared_ptr<Connection> connection)
+{
+    connection->writer = std::thread([this, connection]
+                                     { writeLoop(connection); });
+
+    char header[HEADER_SIZE];
+    GameSessionManager::Request request;
+
+    while (readAll(connection->socket, header, HEADER_SIZE))
+    {
+        std::memcpy(&request.tag, header, 4);
+        std::memcpy(&request.session, header + 4, 4);
+        request.command = static_cast<GameSessionManager::Command>(header[8]);
+        request.length = static_cast<std::uint8_t>(header[9]);
+
+        if (!readAll(connection->socket, request.payload.data(), request.length))
+            break;
+
+        {
+            std::lock_guard lock(connection->mutex);
+            connection->inFlight++;
+        }
+
+        // Responses are queued from the shard thread and sent by the writer thread,
+        // so a slow client never stalls a shard
+        m_Manager.submit(request, [connection](const GameSessionManager::Response &response)
+                         { queueResponse(*connection, response); });
+    }
+
+    // A client that half-closes still gets the responses to everything it sent
+    {
+        std::lock_guard lock(connection->mutex);
+        connection->readDone = true;
+    }
+    connection->pending.notify_one();
+    connection->writer.join();
+
+    {
+        std::lock_guard lock(connection->mutex);
+        ::close(connection->socket);
+        connection->socket = -1;
+    }
+    connection->finished = true;
+}
+
+void Chess::SessionServer::queueResponse(Connection &connection, const GameSessionManager::Response &response)
+{
+    char header[HEADER_SIZE] = {};
+    auto length = static_cast<std::uint8_t>(std::min(response.payload.size(), GameSessionManager::MAX_PAYLOAD));
+    std::memcpy(header, &response.tag, 4);
+    std::memcpy(header + 4, &response.session, 4);
+    header[8] = static_cast<char>(response.status);
+    header[9] = static_cast<char>(response.state);
+    header[10] = static_cast<char>(length);
+
+    {
+        std::lock_guard lock(connection.mutex);
+        connection.inFlight--;
+        if (connection.writeFailed)
+            return;
+        connection.outgoing.insert(connection.outgoing.end(), header, header + HEADER_SIZE);
+        connection.outgoing.insert(connection.outgoing.end(), response.payload.data(), response.payload.data() + length);
+    }
+    connection.pending.notify_one();
+}
+
+void Chess::SessionServer::writeLoop(std::shared_ptr<Connection> connection)
+{
+    std::vector<char> sending;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(connection->mutex);
+            connection->pending.wait(lock, [&connection]
+                                     { return !connection->outgoing.empty() || (connection->readDone && connection->inFlight == 0); });
+            if (connection->outgoing.empty())
+                return; // Closed, and every response sent
+
+            sending.swap(connection->outgoing);
+        }
+
+        if (!writeAll(connection->socket, sending.data(), sending.size()))
+        {
+            {
+                std::lock_guard lock(connection->mutex);
+                connection->writeFailed = true;
+                connection->outgoing.clear();
+            }
+            ::shutdown(connection->socket, SHUT_RDWR); // Ends the reader too
+            return;
+        }
+        sending.clear();
+    }
+}
+
+#endif
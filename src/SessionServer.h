@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameSessionManager.h"
+
+namespace Chess
+{
+    // Serves a GameSessionManager on a local Unix-domain socket (POSIX only).
+    //
+    // Frames are in host byte order. Requests are a 12-byte header followed by the payload:
+    //   uint32 tag, uint32 session, uint8 command, uint8 length, uint16 reserved
+    // Responses (in completion order, matched by tag) are:
+    //   uint32 tag, uint32 session, uint8 status, uint8 state, uint8 length, uint8 reserved
+    class SessionServer
+    {
+    public:
+        static constexpr std::size_t HEADER_SIZE = 12;
+
+    private:
+        struct Connection
+        {
+            int socket = -1; // -1 once closed; guarded by mutex
+            std::thread reader;
+            std::thread writer;
+
+            std::mutex mutex;
+            std::condition_variable pending;
+            std::vector<char> outgoing;
+            std::size_t inFlight = 0; // Requests submitted whose response isn't queued yet
+            bool readDone = false;    // The client closed its side (or the read failed)
+            bool writeFailed = false; // Responses are dropped from then on
+            std::atomic<bool> finished = false;
+        };
+
+        GameSessionManager &m_Manager;
+        std::string m_Path;
+        int m_ListenSocket = -1;
+
+        std::thread m_AcceptThread;
+        std::mutex m_ConnectionsMutex;
+        std::vector<std::shared_ptr<Connection>> m_Connections;
+
+    public:
+        explicit SessionServer(GameSessionManager &manager)
+            : m_Manager(manager)
+        {
+        }
+
+        ~SessionServer()
+        {
+            stop();
+        }
+
+        SessionServer(const SessionServer &) = delete;
+        SessionServer &operator=(const SessionServer &) = delete;
+
+        static bool isSupported();
+
+        // Replaces any stale socket file at path; returns false if it can't listen
+        bool start(const std::string &path);
+        void stop();
+
+    private:
+        void acceptLoop();
+        void readLoop(std::shared_ptr<Connection> connection);
+        void writeLoop(std::shared_ptr<Connection> connection);
+
+        static void queueResponse(Connection &connection, const GameSessionManager::Response &response);
+    };
+}
@@ -0,0 +1,74 @@
+#include "ThreadPool.h"
+#include "Tracer.h"
+
+Chess::ThreadPool::ThreadPool(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    m_Workers.reserve(threads);
+    for (unsigned i = 0; i < threads; i++)
+    {
+        m_Workers.emplace_back([this, i]
+                               {
+                                   Tracer::setThreadName("Pool worker " + std::to_string(i));
+                                   workerLoop(); });
+    }
+}
+
+Chess::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_TaskAvailable.notify_all();
+
+    for (auto &worker : m_Workers)
+        worker.join();
+}
+
+void Chess::ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Tasks.push_back(std::move(task));
+        m_Pending++;
+    }
+    m_TaskAvailable.notify_one();
+}
+
+void Chess::ThreadPool::wait()
+{
+    std::unique_lock lock(m_Mutex);
+    m_AllDone.wait(lock, [this]
+                   { return m_Pending == 0; });
+}
+
+void Chess::ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_Mutex);
+            m_TaskAvailable.wait(lock, [this]
+                                 { return m_Stopping || !m_Tasks.empty(); });
+
+            if (m_Tasks.empty())
+                return; // Stopping
+
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+        }
+
+        {
+            CHESS_TRACE_SCOPE("ThreadPool task");
+            task();
+        }
+
+        std::lock_guard lock(m_Mutex);
+        if (--m_Pending == 0)
+            m_AllDone.notify_all();
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Chess
+{
+    // Fixed set of worker threads consuming a FIFO of tasks
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> m_Workers;
+        std::deque<std::function<void()>> m_Tasks;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_TaskAvailable;
+        std::condition_variable m_AllDone;
+
+        std::size_t m_Pending = 0; // Queued + running
+        bool m_Stopping = false;
+
+    public:
+        // 0 = one thread per hardware thread
+        explicit ThreadPool(unsigned threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        unsigned size() const
+        {
+            return static_cast<unsigned>(m_Workers.size());
+        }
+
+        void submit(std::function<void()> task);
+
+        // Blocks until every submitted task has finished
+        void wait();
+
+        // Runs body(begin, end) over [0, count) in chunks of at most grain items and waits
+        template <typename Body>
+        void parallelFor(std::size_t count, std::size_t grain, Body &&body)
+        {
+            grain = std::max<std::size_t>(grain, 1);
+            for (std::size_t begin = 0; begin < count; begin += grain)
+            {
+                std::size_t end = std::min(count, begin + grain);
+                submit([&body, begin, end]
+                       { body(begin, end); });
+            }
+            wait();
+        }
+
+    private:
+        void workerLoop();
+    };
+}
@@ -0,0 +1,62 @@
+#include "TimeManager.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+Chess::TimeBudget Chess::TimeManager::allocate(std::int64_t remainingMs, std::int64_t incrementMs, int movesToGo, const Position &position)
+{
+    std::int64_t available = std::max<std::int64_t>(remainingMs - MOVE_OVERHEAD_MS, 1);
+
+    // Sudden death: about 44 moves to go with all pieces on, 20 in the endgame
+    std::int64_t movesLeft = movesToGo > 0 ? std::min(movesToGo, 50) : 20 + gamePhase(position);
+
+    TimeBudget budget;
+    budget.optimumMs = available / movesLeft + incrementMs * 3 / 4;
+
+    // Never bet a large part of the clock on one move, unless it's the last before the control
+    std::int64_t cap = movesToGo == 1 ? available * 8 / 10 : available * 3 / 10;
+    budget.maximumMs = std::clamp<std::int64_t>(budget.optimumMs * 5, 1, std::max<std::int64_t>(cap, 1));
+    budget.optimumMs = std::clamp<std::int64_t>(budget.optimumMs, 1, budget.maximumMs);
+    return budget;
+}
+
+int Chess::TimeManager::gamePhase(const Position &position)
+{
+    int phase = 0;
+    for (int color = 0; color < 2; color++)
+    {
+        phase += std::popcount(position.pieces(color, PieceType::Knight) | position.pieces(color, PieceType::Bishop));
+        phase += 2 * std::popcount(position.pieces(color, PieceType::Rook));
+        phase += 4 * std::popcount(position.pieces(color, PieceType::Queen));
+    }
+    return std::min(phase, 24);
+}
+
+void Chess::TimeManager::start(const TimeBudget &budget)
+{
+    m_Budget = budget;
+    m_LastBestMove = {};
+    m_LastScore = 0;
+    m_Stability = 0;
+    m_HasIteration = false;
+}
+
+bool Chess::TimeManager::continueSearch(std::int64_t elapsedMs, PackedMove bestMove, int score)
+{
+    // Percent of the optimum by the number of iterations the best move survived
+    constexpr std::array<int, 5> STABILITY_SCALE = {200, 130, 100, 85, 70};
+
+    m_Stability = m_HasIteration && bestMove == m_LastBestMove ? std::min(m_Stability + 1, 4) : 0;
+
+    std::int64_t target = m_Budget.optimumMs * STABILITY_SCALE[m_Stability] / 100;
+    if (m_HasIteration && score < m_LastScore - 30)
+        target = target * 5 / 4; // Falling score: look for a rescue
+
+    m_LastBestMove = bestMove;
+    m_LastScore = score;
+    m_HasIteration = true;
+
+    // The next iteration typically costs more than all previous ones together
+    return elapsedMs < std::min(target, m_Budget.maximumMs) * 6 / 10;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include "PackedMove.h"
+#include "Position.h"
+
+namespace Chess
+{
+    struct TimeBudget
+    {
+        std::int64_t optimumMs = 0; // Target for a typical move
+        std::int64_t maximumMs = 0; // Hard limit, never exceeded
+    };
+
+    // Splits a clock into per-move budgets. The allocation follows the expected number of
+    // remaining moves (from the game phase); during the search the target shrinks while the
+    // best move stays the same and grows when it changes or the score drops.
+    class TimeManager
+    {
+    public:
+        // Kept in reserve for GUI and scheduling latency
+        static constexpr std::int64_t MOVE_OVERHEAD_MS = 30;
+
+    private:
+        TimeBudget m_Budget;
+
+        PackedMove m_LastBestMove;
+        int m_LastScore = 0;
+        int m_Stability = 0; // Completed iterations since the best move last changed
+        bool m_HasIteration = false;
+
+    public:
+        // movesToGo 0 = sudden death
+        static TimeBudget allocate(std::int64_t remainingMs, std::int64_t incrementMs, int movesToGo, const Position &position);
+
+        // 24 with every piece on the board, 0 in pawn endings
+        static int gamePhase(const Position &position);
+
+        void start(const TimeBudget &budget);
+
+        const TimeBudget &budget() const
+        {
+            return m_Budget;
+        }
+
+        // After each completed iteration: false once another one is not worth starting
+        bool continueSearch(std::int64_t elapsedMs, PackedMove bestMove, int score);
+    };
+}
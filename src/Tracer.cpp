@@ -0,0 +1,299 @@
+#include "Tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using Chess::Tracer;
+
+    // Written by one thread while a dump may read it (a sequence lock on the whole ring): every
+    // field is a relaxed atomic and the dump throws away slots the writer started to reuse
+    struct Event
+    {
+        std::atomic<const char *> name;
+        std::atomic<std::uint64_t> start;
+        std::atomic<std::uint64_t> end;
+        std::atomic<std::uint32_t> thread;
+    };
+
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events = std::make_unique<Event[]>(Tracer::EVENTS_PER_THREAD);
+        std::atomic<std::uint64_t> started = 0; // Events the thread began to write
+        std::atomic<std::uint64_t> written = 0; // Events complete
+        bool inUse = true;                      // Guarded by the registry mutex
+        std::uint32_t owner = 0;                // Thread id of every thread that writes here
+    };
+
+    // Buffers outlive their threads (a pool that has finished still shows up in the next
+    // dump) and are handed to new threads once the old one exits, so short-lived threads
+    // do not pile up buffers. Threads that record take the id of their buffer, so ids and
+    // names are bounded by the buffers plus the threads alive.
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::unordered_map<std::uint32_t, std::string> threadNames;
+        std::uint32_t nextThread = 1;
+        std::atomic<std::uint64_t> clearedAt = 0;
+    };
+
+    // Never destroyed: threads may still record while statics are torn down
+    Registry &registry()
+    {
+        static auto *instance = new Registry;
+        return *instance;
+    }
+
+    struct ThreadSlot
+    {
+        ThreadBuffer *buffer = nullptr;
+        std::uint32_t id = 0;
+
+        ~ThreadSlot()
+        {
+            if (id == 0)
+                return;
+            std::lock_guard lock(registry().mutex);
+            if (buffer != nullptr)
+                buffer->inUse = false;
+            else
+                registry().threadNames.erase(id);
+        }
+    };
+
+    thread_local ThreadSlot t_Slot;
+
+    std::uint32_t threadId()
+    {
+        if (t_Slot.id == 0)
+        {
+            std::lock_guard lock(registry().mutex);
+            t_Slot.id = registry().nextThread++;
+        }
+        return t_Slot.id;
+    }
+
+    ThreadBuffer &threadBuffer()
+    {
+        if (t_Slot.buffer != nullptr)
+            return *t_Slot.buffer;
+
+        threadId();
+
+        auto &shared = registry();
+        std::lock_guard lock(shared.mutex);
+        auto reused = std::find_if(shared.buffers.begin(), shared.buffers.end(), [](const std::unique_ptr<ThreadBuffer> &buffer)
+                                   { return !buffer->inUse; });
+        if (reused != shared.buffers.end())
+        {
+            // The thread takes the exited one's id (and its row in the trace) with the buffer
+            auto &buffer = **reused;
+            buffer.inUse = true;
+            auto name = shared.threadNames.find(t_Slot.id);
+            if (name != shared.threadNames.end())
+            {
+                shared.threadNames[buffer.owner] = std::move(name->second);
+                shared.threadNames.erase(name);
+            }
+            else
+            {
+                shared.threadNames.erase(buffer.owner);
+            }
+            t_Slot.id = buffer.owner;
+            t_Slot.buffer = &buffer;
+            return buffer;
+        }
+
+        shared.buffers.push_back(std::make_unique<ThreadBuffer>());
+        t_Slot.buffer = shared.buffers.back().get();
+        t_Slot.buffer->owner = t_Slot.id;
+        return *t_Slot.buffer;
+    }
+
+    void writeEscaped(std::ostream &out, const std::string &text)
+    {
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) >= 0x20)
+                out << c;
+        }
+    }
+
+    // Microseconds with nanosecond digits, as trace_event expects
+    void writeMicros(std::ostream &out, std::uint64_t ns)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%llu.%03llu", static_cast<unsigned long long>(ns / 1000), static_cast<unsigned long long>(ns % 1000));
+        out << text;
+    }
+
+    std::atomic<bool> s_DumpRequested = false;
+
+#ifndef _WIN32
+    extern "C" void onTraceSignal(int signal)
+    {
+        if (signal == SIGUSR1)
+            s_DumpRequested.store(true);
+        else
+            Tracer::setEnabled(!Tracer::isEnabled());
+    }
+#endif
+}
+
+void Chess::Tracer::setEnabled(bool enabled)
+{
+    s_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Chess::Tracer::clear()
+{
+    registry().clearedAt.store(now(), std::memory_order_relaxed);
+}
+
+void Chess::Tracer::setThreadName(const std::string &name)
+{
+    auto id = threadId();
+    std::lock_guard lock(registry().mutex);
+    registry().threadNames[id] = name;
+}
+
+std::uint64_t Chess::Tracer::now()
+{
+    auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) | 1;
+}
+
+void Chess::Tracer::record(const char *name, std::uint64_t startNs, std::uint64_t endNs)
+{
+    auto &buffer = threadBuffer();
+    auto index = buffer.written.load(std::memory_order_relaxed);
+    buffer.started.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto &event = buffer.events[index % EVENTS_PER_THREAD];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(startNs, std::memory_order_relaxed);
+    event.end.store(endNs, std::memory_order_relaxed);
+    event.thread.store(t_Slot.id, std::memory_order_relaxed);
+
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+bool Chess::Tracer::writeChromeTrace(const std::string &path, std::size_t *eventCount)
+{
+    struct Copy
+    {
+        const char *name;
+        std::uint64_t start;
+        std::uint64_t end;
+        std::uint32_t thread;
+    };
+
+    auto &shared = registry();
+    auto clearedAt = shared.clearedAt.load(std::memory_order_relaxed);
+
+    std::vector<Copy> events;
+    std::unordered_map<std::uint32_t, std::string> threadNames;
+    {
+        // New buffers are only appended under the lock; their contents are read without it
+        std::vector<ThreadBuffer *> buffers;
+        {
+            std::lock_guard lock(shared.mutex);
+            for (auto &buffer : shared.buffers)
+                buffers.push_back(buffer.get());
+            threadNames = shared.threadNames;
+        }
+
+        for (auto *buffer : buffers)
+        {
+            auto written = buffer->written.load(std::memory_order_acquire);
+            auto first = written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+            auto copied = events.size();
+            for (auto i = first; i < written; i++)
+            {
+                const auto &event = buffer->events[i % EVENTS_PER_THREAD];
+                events.push_back({event.name.load(std::memory_order_relaxed), event.start.load(std::memory_order_relaxed),
+                                  event.end.load(std::memory_order_relaxed), event.thread.load(std::memory_order_relaxed)});
+            }
+
+            // Slots the thread went on to reuse while they were copied may hold mixed events
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto started = buffer->started.load(std::memory_order_relaxed);
+            if (started > first + EVENTS_PER_THREAD)
+            {
+                auto stale = std::min<std::uint64_t>(started - EVENTS_PER_THREAD - first, written - first);
+                events.erase(events.begin() + copied, events.begin() + copied + static_cast<std::ptrdiff_t>(stale));
+            }
+        }
+    }
+
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Could not write " << path << std::endl;
+        return false;
+    }
+
+    // Timestamps start at the first event
+    std::uint64_t origin = UINT64_MAX;
+    for (const auto &event : events)
+    {
+        if (event.start >= clearedAt)
+            origin = std::min(origin, event.start);
+    }
+
+    std::size_t count = 0;
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (const auto &[thread, name] : threadNames)
+    {
+        file << (count++ == 0 ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":\"";
+        writeEscaped(file, name);
+        file << "\"}}";
+    }
+
+    std::size_t written = 0;
+    for (const auto &event : events)
+    {
+        if (event.start < clearedAt || event.end < event.start)
+            continue;
+
+        file << (count++ == 0 ? "\n" : ",\n") << "{\"name\":\"";
+        writeEscaped(file, event.name);
+        file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":";
+        writeMicros(file, event.start - origin);
+        file << ",\"dur\":";
+        writeMicros(file, event.end - event.start);
+        file << '}';
+        written++;
+    }
+    file << "\n]}\n";
+
+    if (eventCount != nullptr)
+        *eventCount = written;
+    return static_cast<bool>(file);
+}
+
+void Chess::Tracer::installSignalHandler()
+{
+#ifndef _WIN32
+    std::signal(SIGUSR1, onTraceSignal);
+    std::signal(SIGUSR2, onTraceSignal);
+#endif
+}
+
+bool Chess::Tracer::takeDumpRequest()
+{
+    return s_DumpRequested.exchange(false);
+}
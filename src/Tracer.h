@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Chess
+{
+    // Timeline of scoped trace points on every thread, written as Chrome trace_event JSON
+    // (open it in https://ui.perfetto.dev or chrome://tracing). Each thread records into its
+    // own ring buffer without locks; while tracing is off a trace point costs one relaxed load.
+    // A full buffer overwrites its oldest events, so a dump holds the last EVENTS_PER_THREAD
+    // scopes of each thread.
+    class Tracer
+    {
+    public:
+        static constexpr std::size_t EVENTS_PER_THREAD = 1 << 15;
+
+    private:
+        static inline std::atomic<bool> s_Enabled = false;
+
+    public:
+        static bool isEnabled()
+        {
+            return s_Enabled.load(std::memory_order_relaxed);
+        }
+
+        static void setEnabled(bool enabled);
+
+        // Drops everything recorded so far from later dumps
+        static void clear();
+
+        // Name of the calling thread in the trace
+        static void setThreadName(const std::string &name);
+
+        // Nanoseconds on a steady clock (never 0)
+        static std::uint64_t now();
+
+        // name must outlive the tracer (a string literal)
+        static void record(const char *name, std::uint64_t startNs, std::uint64_t endNs);
+
+        // Every thread's events since the last clear(); the number written goes to eventCount
+        static bool writeChromeTrace(const std::string &path, std::size_t *eventCount = nullptr);
+
+        // SIGUSR1 asks for a dump and SIGUSR2 switches tracing on or off (not on Windows).
+        // A signal handler cannot write files: the owner polls takeDumpRequest()
+        static void installSignalHandler();
+        static bool takeDumpRequest();
+    };
+
+    class TraceScope
+    {
+    private:
+        const char *m_Name;
+        std::uint64_t m_Start;
+
+    public:
+        explicit TraceScope(const char *name)
+            : m_Name(name), m_Start(Tracer::isEnabled() ? Tracer::now() : 0)
+        {
+        }
+
+        ~TraceScope()
+        {
+            if (m_Start != 0)
+                Tracer::record(m_Name, m_Start, Tracer::now());
+        }
+
+        TraceScope(const TraceScope &) = delete;
+        TraceScope &operator=(const TraceScope &) = delete;
+    };
+}
+
+#define CHESS_TRACE_CONCAT_IMPL(a, b) a##b
+#define CHESS_TRACE_CONCAT(a, b) CHESS_TRACE_CONCAT_IMPL(a, b)
+#define CHESS_TRACE_SCOPE(name) Chess::TraceScope CHESS_TRACE_CONCAT(traceScope, __LINE__)(name)
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "PackedMove.h"
+#include "PackedPosition.h"
+
+namespace Chess
+{
+    // One labeled position as written by chess_datagen (40 bytes, little-endian, no header)
+    struct TrainingRecord
+    {
+        PackedPosition position;
+        std::int16_t score;      // Search score in centipawns for the side to move
+        std::uint16_t bestMove;  // PackedMove::raw()
+        std::int8_t result;      // Game result for White: 1 win, 0 draw, -1 loss
+        std::uint8_t reserved[3];
+    };
+
+    static_assert(sizeof(TrainingRecord) == 40);
+}
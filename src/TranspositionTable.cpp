@@ -0,0 +1,237 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if !defined(__SIZEOF_INT128__) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Transparent huge pages are used when the mapping is aligned to them
+    constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+
+    // Data word: move (16) | score (16) | depth (8) | bound (2) | generation (6), upper 16 bits unused
+    constexpr int SCORE_SHIFT = 16;
+    constexpr int DEPTH_SHIFT = 32;
+    constexpr int BOUND_SHIFT = 40;
+    constexpr int GENERATION_SHIFT = 42;
+
+    int boundOf(std::uint64_t data)
+    {
+        return static_cast<int>((data >> BOUND_SHIFT) & 3);
+    }
+
+    int depthOf(std::uint64_t data)
+    {
+        return static_cast<int>((data >> DEPTH_SHIFT) & 0xff);
+    }
+
+    int generationOf(std::uint64_t data)
+    {
+        return static_cast<int>((data >> GENERATION_SHIFT) & 63);
+    }
+}
+
+bool Chess::TranspositionTable::resize(std::size_t megabytes)
+{
+    release();
+
+    std::size_t bytes = std::max<std::size_t>(megabytes, 1) << 20;
+
+#ifdef _WIN32
+    void *mapping = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (mapping == nullptr)
+        return false;
+
+    m_Mapping = mapping;
+    m_MappedBytes = bytes;
+    m_Buckets = static_cast<Bucket *>(mapping);
+#else
+    // Over-map by one huge page to place the table on a huge page boundary
+    std::size_t mappedBytes = bytes + HUGE_PAGE_SIZE;
+    void *mapping = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    auto address = reinterpret_cast<std::uintptr_t>(mapping);
+    auto aligned = (address + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+#ifdef MADV_HUGEPAGE
+    madvise(reinterpret_cast<void *>(aligned), bytes, MADV_HUGEPAGE);
+#endif
+
+    m_Mapping = mapping;
+    m_MappedBytes = mappedBytes;
+    m_Buckets = reinterpret_cast<Bucket *>(aligned);
+#endif
+
+    // Fresh anonymous pages are zero, which is an empty table
+    m_BucketCount = bytes / BUCKET_SIZE;
+    m_Generation = 0;
+    resetStatistics();
+    return true;
+}
+
+void Chess::TranspositionTable::release()
+{
+    if (m_Mapping == nullptr)
+        return;
+
+#ifdef _WIN32
+    VirtualFree(m_Mapping, 0, MEM_RELEASE);
+#else
+    munmap(m_Mapping, m_MappedBytes);
+#endif
+
+    m_Mapping = nullptr;
+    m_Buckets = nullptr;
+    m_BucketCount = 0;
+    m_MappedBytes = 0;
+}
+
+void Chess::TranspositionTable::clear(unsigned threads)
+{
+    if (m_Buckets == nullptr)
+        return;
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Each thread zeroes (and so first-touches) a contiguous slice
+    std::size_t chunk = (m_BucketCount + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++)
+    {
+        std::size_t begin = std::min(m_BucketCount, i * chunk);
+        std::size_t end = std::min(m_BucketCount, begin + chunk);
+        workers.emplace_back([this, begin, end]
+                             { std::memset(static_cast<void *>(m_Buckets + begin), 0, (end - begin) * BUCKET_SIZE); });
+    }
+
+    for (auto &worker : workers)
+        worker.join();
+
+    m_Generation = 0;
+    resetStatistics();
+}
+
+Chess::TranspositionTable::Bucket &Chess::TranspositionTable::bucket(std::uint64_t key) const
+{
+    // Multiply-shift maps the key onto any bucket count without a division
+#ifdef __SIZEOF_INT128__
+    auto index = static_cast<std::size_t>((static_cast<unsigned __int128>(key) * m_BucketCount) >> 64);
+#else
+    auto index = static_cast<std::size_t>(__umulh(key, m_BucketCount));
+#endif
+    return m_Buckets[index];
+}
+
+void Chess::TranspositionTable::prefetch(std::uint64_t key) const
+{
+    if (m_Buckets == nullptr)
+        return;
+
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(&bucket(key));
+#endif
+}
+
+std::uint64_t Chess::TranspositionTable::pack(PackedMove move, int score, int depth, Bound bound, std::uint8_t generation)
+{
+    return std::uint64_t(move.raw()) |
+           std::uint64_t(static_cast<std::uint16_t>(score)) << SCORE_SHIFT |
+           std::uint64_t(std::clamp(depth, 0, 255)) << DEPTH_SHIFT |
+           std::uint64_t(bound) << BOUND_SHIFT |
+           std::uint64_t(generation) << GENERATION_SHIFT;
+}
+
+bool Chess::TranspositionTable::probe(std::uint64_t key, Entry &entry) const
+{
+    if (m_Buckets == nullptr)
+        return false;
+
+    for (auto &slot : bucket(key).slots)
+    {
+        std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) != key || boundOf(data) == 0)
+            continue;
+
+        entry.move = PackedMove::fromRaw(static_cast<std::uint16_t>(data));
+        entry.score = static_cast<std::int16_t>(data >> SCORE_SHIFT);
+        entry.depth = depthOf(data);
+        entry.bound = static_cast<Bound>(boundOf(data));
+        return true;
+    }
+    return false;
+}
+
+void Chess::TranspositionTable::store(std::uint64_t key, PackedMove move, int score, int depth, Bound bound)
+{
+    if (m_Buckets == nullptr)
+        return;
+
+    auto &slots = bucket(key).slots;
+    int generation = m_Generation.load(std::memory_order_relaxed);
+
+    Slot *target = &slots[0];
+    int worst = 1 << 30;
+    for (auto &slot : slots)
+    {
+        std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) == key)
+        {
+            // Same position: keep a deeper result of this search, and its move if there's no new one
+            if (bound != Bound::Exact && generationOf(data) == generation && depthOf(data) > depth + 2)
+                return;
+            if (move.isNone())
+                move = PackedMove::fromRaw(static_cast<std::uint16_t>(data));
+            target = &slot;
+            break;
+        }
+
+        // Entries of older searches count as eight plies shallower per search
+        int age = (generation - generationOf(data)) & 63;
+        int value = boundOf(data) == 0 ? -(1 << 20) : depthOf(data) - 8 * age;
+        if (value < worst)
+        {
+            worst = value;
+            target = &slot;
+        }
+    }
+
+    std::uint64_t data = pack(move, score, depth, bound, static_cast<std::uint8_t>(generation));
+    target->data.store(data, std::memory_order_relaxed);
+    target->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+int Chess::TranspositionTable::hashfull() const
+{
+    if (m_Buckets == nullptr)
+        return 0;
+
+    constexpr std::size_t SAMPLE_BUCKETS = 1000 / ENTRIES_PER_BUCKET;
+
+    int generation = m_Generation.load(std::memory_order_relaxed);
+    int used = 0;
+    std::size_t buckets = std::min(SAMPLE_BUCKETS, m_BucketCount);
+    for (std::size_t i = 0; i < buckets; i++)
+    {
+        for (auto &slot : m_Buckets[i].slots)
+        {
+            std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            used += boundOf(data) != 0 && generationOf(data) == generation;
+        }
+    }
+    return buckets == 0 ? 0 : static_cast<int>(used * 1000 / (buckets * ENTRIES_PER_BUCKET));
+}
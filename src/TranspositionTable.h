@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "PackedMove.h"
+
+namespace Chess
+{
+    // Shared hash table of search results, safe for any number of searching threads without
+    // locks. Each entry is two 64-bit words, data and key ^ data: a torn write (one word from
+    // each of two writers) fails the key check and reads as a miss. Four entries fill one
+    // 64-byte bucket, so a probe touches a single cache line. The table is mapped with
+    // mmap (huge pages where available) or VirtualAlloc, outside the regular heap.
+    class TranspositionTable
+    {
+    public:
+        enum class Bound : std::uint8_t
+        {
+            None,
+            Upper, // Score <= value
+            Lower, // Score >= value
+            Exact,
+        };
+
+        struct Entry
+        {
+            PackedMove move;
+            int score = 0;
+            int depth = 0;
+            Bound bound = Bound::None;
+        };
+
+        struct Statistics
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+        };
+
+        static constexpr std::size_t BUCKET_SIZE = 64;
+        static constexpr int ENTRIES_PER_BUCKET = 4;
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::uint64_t> keyXorData;
+            std::atomic<std::uint64_t> data;
+        };
+
+        struct alignas(BUCKET_SIZE) Bucket
+        {
+            std::array<Slot, ENTRIES_PER_BUCKET> slots;
+        };
+
+        static_assert(sizeof(Bucket) == BUCKET_SIZE);
+
+        Bucket *m_Buckets = nullptr;
+        std::size_t m_BucketCount = 0;
+        std::size_t m_MappedBytes = 0;
+        void *m_Mapping = nullptr;
+
+        std::atomic<std::uint8_t> m_Generation = 0; // 6 bits, bumped by every new search
+
+        std::atomic<std::uint64_t> m_Hits = 0;
+        std::atomic<std::uint64_t> m_Misses = 0;
+
+    public:
+        TranspositionTable() = default;
+
+        explicit TranspositionTable(std::size_t megabytes)
+        {
+            resize(megabytes);
+        }
+
+        ~TranspositionTable()
+        {
+            release();
+        }
+
+        TranspositionTable(const TranspositionTable &) = delete;
+        TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+        // Discards the content; false (leaving no table) if the memory can't be mapped
+        bool resize(std::size_t megabytes);
+
+        // Zeroes the table on threads threads (0 = one per hardware thread). Not while searching.
+        void clear(unsigned threads = 0);
+
+        std::size_t sizeMegabytes() const
+        {
+            return m_BucketCount * BUCKET_SIZE >> 20;
+        }
+
+        bool isAllocated() const
+        {
+            return m_Buckets != nullptr;
+        }
+
+        // Called once before each search, ages older entries for replacement
+        void newSearch()
+        {
+            m_Generation.store((m_Generation.load(std::memory_order_relaxed) + 1) & 63, std::memory_order_relaxed);
+        }
+
+        // Brings the bucket of key into the cache ahead of the probe
+        void prefetch(std::uint64_t key) const;
+
+        bool probe(std::uint64_t key, Entry &entry) const;
+
+        // Replaces the same position, else the shallowest entry of the oldest search in the bucket
+        void store(std::uint64_t key, PackedMove move, int score, int depth, Bound bound);
+
+        // Permille of sampled entries written during the current search
+        int hashfull() const;
+
+        // Probe counters, added in batches by the searches
+        void recordProbes(std::uint64_t hits, std::uint64_t misses)
+        {
+            m_Hits.fetch_add(hits, std::memory_order_relaxed);
+            m_Misses.fetch_add(misses, std::memory_order_relaxed);
+        }
+
+        Statistics statistics() const
+        {
+            return {m_Hits.load(std::memory_order_relaxed), m_Misses.load(std::memory_order_relaxed)};
+        }
+
+        void resetStatistics()
+        {
+            m_Hits = 0;
+            m_Misses = 0;
+        }
+
+    private:
+        void release();
+
+        Bucket &bucket(std::uint64_t key) const;
+
+        static std::uint64_t pack(PackedMove move, int score, int depth, Bound bound, std::uint8_t generation);
+    };
+}
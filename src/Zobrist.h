@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace Chess::Zobrist
+{
+    // Compile-time generated hashing keys (SplitMix64), indexed like Piece descriptors:
+    // PIECE[color | type][square], CASTLING[rights bitmask], EN_PASSANT[file].
+
+    constexpr std::uint64_t splitMix64(std::uint64_t &state)
+    {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    struct Keys
+    {
+        std::array<std::array<std::uint64_t, 64>, 16> piece{};
+        std::array<std::uint64_t, 16> castling{};
+        std::array<std::uint64_t, 8> enPassant{};
+        std::uint64_t side = 0;
+    };
+
+    constexpr Keys generateKeys()
+    {
+        Keys keys;
+        std::uint64_t state = 0x43686573735a6f62ull; // "ChessZob"
+
+        for (auto &squares : keys.piece)
+            for (auto &key : squares)
+                key = splitMix64(state);
+
+        // Rights are XORed in as a whole mask, so each combination is built from the single-right keys
+        std::array<std::uint64_t, 4> rights{};
+        for (auto &key : rights)
+            key = splitMix64(state);
+        for (int mask = 0; mask < 16; mask++)
+            for (int bit = 0; bit < 4; bit++)
+                if (mask & (1 << bit))
+                    keys.castling[mask] ^= rights[bit];
+
+        for (auto &key : keys.enPassant)
+            key = splitMix64(state);
+
+        keys.side = splitMix64(state);
+        return keys;
+    }
+
+    inline constexpr Keys KEYS = generateKeys();
+
+    // Castling rights bitmask
+    enum CastlingRight
+    {
+        WhiteKingside = 1,
+        WhiteQueenside = 2,
+        BlackKingside = 4,
+        BlackQueenside = 8,
+    };
+}
@@ -0,0 +1,95 @@
+// Move generation check: counts the leaf nodes of the legal move tree of well-known positions
+// to a fixed depth and compares them with the published perft numbers. Run by ctest.
+
+#include "Position.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace Chess;
+
+    struct PerftCase
+    {
+        const char *name;
+        const char *fen;
+        std::vector<std::uint64_t> counts; // By depth, from 1
+    };
+
+    // https://www.chessprogramming.org/Perft_Results
+    const std::vector<PerftCase> CASES = {
+        {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {20, 400, 8902, 197281, 4865609}},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", {48, 2039, 97862, 4085603}},
+        {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", {14, 191, 2812, 43238, 674624}},
+        {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", {6, 264, 9467, 422333}},
+        {"position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", {6, 264, 9467, 422333}},
+        {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", {44, 1486, 62379, 2103487}},
+        {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", {46, 2079, 89890, 3894594}},
+    };
+
+    std::uint64_t perft(Position &position, int depth)
+    {
+        MoveList moves;
+        position.generateLegal(moves);
+        if (depth == 1)
+            return moves.size();
+
+        std::uint64_t nodes = 0;
+        for (auto move : moves)
+        {
+            position.makeMove(move);
+            nodes += perft(position, depth - 1);
+            position.unmakeMove();
+        }
+        return nodes;
+    }
+}
+
+int main()
+{
+    int failures = 0;
+    std::uint64_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &test : CASES)
+    {
+        Position position;
+        if (!position.setFen(test.fen))
+        {
+            std::cerr << test.name << ": invalid FEN" << std::endl;
+            failures++;
+            continue;
+        }
+
+        auto fen = position.fen();
+        auto key = position.key();
+        int depth = static_cast<int>(test.counts.size());
+        for (int d = 1; d <= depth; d++)
+        {
+            auto nodes = perft(position, d);
+            total += nodes;
+            if (nodes != test.counts[d - 1])
+            {
+                std::cerr << test.name << ": perft(" << d << ") = " << nodes << ", expected " << test.counts[d - 1] << std::endl;
+                failures++;
+                break;
+            }
+        }
+
+        // Make and unmake must leave the position as it was
+        if (position.fen() != fen || position.key() != key)
+        {
+            std::cerr << test.name << ": position changed by make/unmake" << std::endl;
+            failures++;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << CASES.size() << " positions, " << total << " nodes in " << seconds << " s: "
+              << (failures == 0 ? "passed" : std::to_string(failures) + " failures") << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
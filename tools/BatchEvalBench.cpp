@@ -0,0 +1,167 @@
+// Measures Nnue::evaluateBatch throughput on random positions.
+//
+// chess_batch_bench [--positions N] [--batch N] [--threads N] [--network FILE]
+//
+// Without --network a random network is written to the temporary directory.
+
+#include "BatchEval.h"
+#include "Nnue.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace Chess;
+
+    struct Options
+    {
+        std::size_t positions = 1'000'000;
+        std::size_t batch = 4096;
+        unsigned threads = 0;
+        std::string network;
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--positions")
+                options.positions = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--batch")
+                options.batch = std::max<std::size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+            else if (arg == "--network")
+                options.network = value;
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Small weights so the accumulator stays in range
+    std::string writeRandomNetwork()
+    {
+        auto path = (std::filesystem::temp_directory_path() / "chess_batch_bench.nnue").string();
+        std::ofstream file(path, std::ios::binary);
+
+        std::uint32_t header[3] = {Nnue::VERSION, Nnue::FEATURES, Nnue::HIDDEN};
+        file.write("CHNN", 4);
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+        std::mt19937 rng(2024);
+        std::uniform_int_distribution<int> weight(-8, 8);
+        std::vector<std::int16_t> row(Nnue::HIDDEN);
+
+        // Biases, feature rows, output weights for both halves
+        for (int r = 0; r < Nnue::FEATURES + 3; r++)
+        {
+            for (auto &value : row)
+                value = static_cast<std::int16_t>(weight(rng));
+            file.write(reinterpret_cast<const char *>(row.data()), row.size() * sizeof(std::int16_t));
+        }
+
+        std::int32_t outputBias = 0;
+        file.write(reinterpret_cast<const char *>(&outputBias), sizeof(outputBias));
+        return file ? path : std::string();
+    }
+
+    // Both kings plus up to 30 random pieces (pawns never on the back ranks)
+    std::vector<PackedPosition> randomPositions(std::size_t count)
+    {
+        std::mt19937_64 rng(42);
+        std::vector<PackedPosition> positions;
+        positions.reserve(count);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::array<std::uint8_t, 64> board{};
+            int whiteKing = rng() % 64, blackKing;
+            do
+                blackKing = rng() % 64;
+            while (blackKing == whiteKing);
+            board[whiteKing] = 6;
+            board[blackKing] = 8 | 6;
+
+            int pieces = 2 + rng() % 29;
+            for (int p = 0; p < pieces; p++)
+            {
+                int square = rng() % 64;
+                int type = 1 + rng() % 5;
+                if (board[square] != 0 || (type == 1 && (square < 8 || square >= 56)))
+                    continue;
+                board[square] = static_cast<std::uint8_t>(type | ((rng() & 1) ? 8 : 0));
+            }
+
+            positions.push_back(PackedPosition::fromBoard(board, rng() & 1));
+        }
+        return positions;
+    }
+
+    // Returns positions per second
+    double run(const std::vector<PackedPosition> &positions, std::vector<std::int16_t> &scores, std::size_t batch, ThreadPool *pool)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t begin = 0; begin < positions.size(); begin += batch)
+        {
+            std::size_t count = std::min(batch, positions.size() - begin);
+            Nnue::evaluateBatch(std::span(positions).subspan(begin, count), std::span(scores).subspan(begin, count), pool);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return positions.size() / elapsed.count();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+
+    if (options.network.empty())
+        options.network = writeRandomNetwork();
+    if (!Nnue::defaultNetwork().load(options.network))
+    {
+        std::cerr << "Could not load network " << options.network << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto positions = randomPositions(options.positions);
+    std::vector<std::int16_t> scores(positions.size());
+    ThreadPool pool(options.threads);
+
+    std::cout << "Kernel:    " << Nnue::kernelName(Nnue::activeKernel()) << "\n"
+              << "Positions: " << positions.size() << " (batches of " << options.batch << ")\n";
+
+    double single = run(positions, scores, options.batch, nullptr);
+    std::cout << "Single:    " << static_cast<long long>(single) << " pos/s" << std::endl;
+
+    double pooled = run(positions, scores, options.batch, &pool);
+    std::cout << "Pooled:    " << static_cast<long long>(pooled) << " pos/s on " << pool.size() << " threads"
+              << " (x" << pooled / single << ")" << std::endl;
+
+    long long checksum = 0;
+    for (auto score : scores)
+        checksum += score;
+    std::cout << "Checksum:  " << checksum << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,325 @@
+// Micro-benchmarks of the board's hot paths: FEN parsing, per-piece move generation, move
+// and undo round trips, piece construction and drawing the board into an off-screen target,
+// plus the engine's make/unmake and evaluation, which must not allocate once warmed up
+// (a NoAllocGuard aborts the run if they do when allocation tracking is on).
+//
+// chess_bench [--filter TEXT] [--samples N] [--min-time MS] [--json FILE]
+//
+// Every benchmark is calibrated until one sample takes at least --min-time, then timed over
+// --samples samples. Run it from the directory holding assets/ (the build's bin directory).
+
+#include "AllocTracker.h"
+#include "Chess.h"
+#include "Evaluation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Chess
+{
+    // The private entry points being measured
+    struct BenchmarkAccess
+    {
+        static void restart(Game &game, const std::string &fen)
+        {
+            game.m_FenBuffer = fen;
+            game.restart();
+        }
+
+        static void calculatePossibleMoves(Game &game, int index)
+        {
+            game.calculatePossibleMoves(index);
+        }
+
+        static void registerMove(Game &game, int from, int to)
+        {
+            game.registerMove(from, to);
+        }
+
+        static void undoLastMove(Game &game)
+        {
+            game.undoLastMove();
+        }
+
+        static sf::RectangleShape &tile(Game &game)
+        {
+            return game.m_Tile;
+        }
+    };
+}
+
+namespace
+{
+    using namespace Chess;
+
+    // Italian game: every piece type has moves from the squares used below
+    constexpr const char *MIDDLEGAME_FEN = "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/3P1N2/PPP2PPP/RNBQK2R w KQkq - 0 5";
+    const sf::Vector2u TARGET_SIZE(856, 600);
+
+    struct Options
+    {
+        std::string filter;
+        int samples = 10;
+        double minTimeMs = 20.0;
+        std::string json;
+    };
+
+    struct Benchmark
+    {
+        std::string name;
+        std::function<void(std::uint64_t)> run; // Performs the operation that many times
+        bool allocationFree = false;             // Timed samples run under a NoAllocGuard
+    };
+
+    struct Result
+    {
+        std::string name;
+        std::uint64_t iterations = 0; // Per sample
+        double meanNs = 0.0;
+        double minNs = 0.0;
+        double stddevNs = 0.0;
+        double allocations = 0.0;
+        double bytes = 0.0;
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--filter")
+                options.filter = value;
+            else if (arg == "--samples")
+                options.samples = std::max(2, std::atoi(value.c_str()));
+            else if (arg == "--min-time")
+                options.minTimeMs = std::max(1.0, std::atof(value.c_str()));
+            else if (arg == "--json")
+                options.json = value;
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double timeNs(const Benchmark &benchmark, std::uint64_t iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        benchmark.run(iterations);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    Result measure(const Benchmark &benchmark, const Options &options)
+    {
+        // Doubling until one sample is long enough for the clock (this also warms caches up)
+        std::uint64_t iterations = 1;
+        while (timeNs(benchmark, iterations) < options.minTimeMs * 1e6 && iterations < (std::uint64_t(1) << 30))
+            iterations *= 2;
+
+        Result result;
+        result.name = benchmark.name;
+        result.iterations = iterations;
+
+        std::vector<double> samples;
+        samples.reserve(options.samples);
+        auto before = AllocTracker::threadCounters();
+        {
+            // Calibration has warmed every buffer up: from here on nothing may allocate
+            std::optional<NoAllocGuard> guard;
+            if (benchmark.allocationFree)
+                guard.emplace(benchmark.name.c_str());
+            for (int i = 0; i < options.samples; i++)
+                samples.push_back(timeNs(benchmark, iterations) / iterations);
+        }
+        auto after = AllocTracker::threadCounters();
+
+        double operations = static_cast<double>(iterations) * options.samples;
+        result.allocations = (after.allocations - before.allocations) / operations;
+        result.bytes = (after.bytes - before.bytes) / operations;
+
+        for (auto sample : samples)
+            result.meanNs += sample / samples.size();
+        result.minNs = *std::min_element(samples.begin(), samples.end());
+        for (auto sample : samples)
+            result.stddevNs += (sample - result.meanNs) * (sample - result.meanNs);
+        result.stddevNs = std::sqrt(result.stddevNs / (samples.size() - 1));
+        return result;
+    }
+
+    std::vector<Benchmark> benchmarks(Game &game, sf::RenderTexture *texture)
+    {
+        std::vector<Benchmark> list;
+
+        list.push_back({"fen/restart", [&game](std::uint64_t n)
+                        {
+                            for (std::uint64_t i = 0; i < n; i++)
+                                BenchmarkAccess::restart(game, MIDDLEGAME_FEN);
+                        }});
+
+        // One piece of each type (all White, who is to move)
+        struct Square
+        {
+            const char *type;
+            int index;
+        };
+        for (auto [type, index] : {Square{"pawn", 8}, Square{"rook", 7}, Square{"knight", 21}, Square{"bishop", 26}, Square{"queen", 3}, Square{"king", 4}})
+        {
+            list.push_back({std::string("movegen/") + type, [&game, index](std::uint64_t n)
+                            {
+                                for (std::uint64_t i = 0; i < n; i++)
+                                    BenchmarkAccess::calculatePossibleMoves(game, index);
+                            }});
+        }
+
+        // After the first one, the move is found in the game tree instead of added to it
+        list.push_back({"move/quiet", [&game](std::uint64_t n)
+                        {
+                            for (std::uint64_t i = 0; i < n; i++)
+                            {
+                                BenchmarkAccess::registerMove(game, 1, 18); // Nc3
+                                BenchmarkAccess::undoLastMove(game);
+                            }
+                        }});
+        list.push_back({"move/capture", [&game](std::uint64_t n)
+                        {
+                            for (std::uint64_t i = 0; i < n; i++)
+                            {
+                                BenchmarkAccess::registerMove(game, 21, 36); // Nxe5
+                                BenchmarkAccess::undoLastMove(game);
+                            }
+                        }});
+
+        // Engine board: every legal move made and taken back
+        Position position;
+        position.setFen(MIDDLEGAME_FEN);
+        MoveList moves;
+        position.generateLegal(moves);
+        list.push_back({"position/make-unmake", [position, moves](std::uint64_t n) mutable
+                        {
+                            for (std::uint64_t i = 0; i < n; i++)
+                            {
+                                auto move = moves.moves[i % moves.count];
+                                position.makeMove(move);
+                                position.unmakeMove();
+                            }
+                        },
+                        true});
+
+        // Hand-crafted evaluation with its pawn table, as the search calls it
+        auto pawnTable = std::make_shared<PawnTable>();
+        list.push_back({"eval/classical", [position, pawnTable](std::uint64_t n)
+                        {
+                            int sum = 0;
+                            for (std::uint64_t i = 0; i < n; i++)
+                                sum += Evaluation::evaluate(position, pawnTable.get());
+                            volatile int sink = sum;
+                            (void)sink;
+                        },
+                        true});
+
+        list.push_back({"piece/construct", [&game](std::uint64_t n)
+                        {
+                            auto &tile = BenchmarkAccess::tile(game);
+                            for (std::uint64_t i = 0; i < n; i++)
+                                delete new Piece(i % 2 == 0 ? 'N' : 'q', tile);
+                        }});
+
+        // Display flushes the commands to the driver; it doesn't wait for the GPU
+        if (texture != nullptr)
+        {
+            list.push_back({"draw/board", [&game, texture](std::uint64_t n)
+                            {
+                                for (std::uint64_t i = 0; i < n; i++)
+                                {
+                                    texture->clear();
+                                    texture->draw(game);
+                                    texture->display();
+                                }
+                            }});
+        }
+        return list;
+    }
+
+    bool writeJson(const std::string &path, const std::vector<Result> &results)
+    {
+        std::ofstream out(path);
+        out << std::setprecision(6) << "{\n  \"allocation_tracking\": " << (AllocTracker::ENABLED ? "true" : "false")
+            << ",\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const auto &result = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+                << ", \"ns_per_op\": " << result.meanNs << ", \"ns_min\": " << result.minNs << ", \"ns_stddev\": " << result.stddevNs
+                << ", \"allocations_per_op\": " << result.allocations << ", \"bytes_per_op\": " << result.bytes << "}";
+        }
+        out << "\n  ]\n}\n";
+
+        if (!out)
+        {
+            std::cerr << "Could not write " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+
+    Game game(TARGET_SIZE);
+
+    // Needs an OpenGL context, which headless machines may not provide
+    sf::RenderTexture texture;
+    bool drawing = texture.resize(TARGET_SIZE);
+    if (!drawing)
+        std::cerr << "No off-screen target: skipping draw/board" << std::endl;
+
+    if (!AllocTracker::ENABLED)
+        std::cerr << "Allocation tracking is off: allocations are reported as 0" << std::endl;
+
+    std::vector<Result> results;
+    std::cout << std::left << std::setw(18) << "benchmark" << std::right << std::setw(12) << "ns/op" << std::setw(12) << "min"
+              << std::setw(9) << "cv" << std::setw(12) << "allocs/op" << std::setw(12) << "bytes/op" << std::endl;
+
+    for (const auto &benchmark : benchmarks(game, drawing ? &texture : nullptr))
+    {
+        if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos)
+            continue;
+
+        // Every benchmark leaves the board as it found it
+        BenchmarkAccess::restart(game, MIDDLEGAME_FEN);
+        auto result = measure(benchmark, options);
+        double cv = result.meanNs > 0.0 ? result.stddevNs / result.meanNs * 100.0 : 0.0;
+        std::cout << std::left << std::setw(18) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << result.meanNs << std::setw(12) << result.minNs << std::setw(8) << cv << "%"
+                  << std::setprecision(2) << std::setw(12) << result.allocations << std::setw(12) << result.bytes << std::endl;
+        results.push_back(result);
+    }
+
+    if (!options.json.empty() && !writeJson(options.json, results))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,311 @@
+// Generates labeled training positions by self-play on every core.
+//
+// chess_datagen --output FILE [--positions N] [--threads N] [--nodes N] [--depth N] [--hash MB]
+//               [--random-plies N] [--openings FILE] [--network FILE] [--seed N] [--compress]
+//
+// Games start from a random opening line (random legal moves from the start position or a
+// FEN of the openings file) and are played at a fixed node budget. Every quiet position
+// (not in check, best move neither a capture nor a promotion, no mate score) becomes a
+// TrainingRecord labeled with its search score and the final result of the game. Every thread
+// searches with its own transposition table of --hash megabytes (default 16).
+
+#include "AsyncWriter.h"
+#include "Nnue.h"
+#include "Position.h"
+#include "Search.h"
+#include "TrainingRecord.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace Chess;
+
+    struct Options
+    {
+        std::string output;
+        std::uint64_t positions = 1'000'000;
+        unsigned threads = 0;
+        SearchLimits limits{.depth = Search::MAX_PLY, .nodes = 5000};
+        std::size_t hashMb = 16;
+        int randomPlies = 8;
+        std::string openings;
+        std::string network;
+        std::uint64_t seed = 1;
+        bool compress = false;
+    };
+
+    // Decisive adjudication once the score stays beyond this for a few moves
+    constexpr int RESIGN_SCORE = 3000;
+    constexpr int RESIGN_PLIES = 8;
+    constexpr int MAX_PLIES = 400;
+
+    struct Progress
+    {
+        std::atomic<std::uint64_t> positions = 0;
+        std::atomic<std::uint64_t> games = 0;
+        std::atomic<std::uint64_t> nodes = 0;
+        std::atomic<bool> done = false;
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        bool missing = false;
+        auto value = [&](int &i) -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                missing = true;
+                return "";
+            }
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--output")
+                options.output = value(i);
+            else if (arg == "--positions")
+                options.positions = std::strtoull(value(i).c_str(), nullptr, 10);
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::atoi(value(i).c_str()));
+            else if (arg == "--nodes")
+                options.limits.nodes = std::strtoull(value(i).c_str(), nullptr, 10);
+            else if (arg == "--depth")
+                options.limits.depth = std::atoi(value(i).c_str());
+            else if (arg == "--hash")
+                options.hashMb = std::strtoull(value(i).c_str(), nullptr, 10);
+            else if (arg == "--random-plies")
+                options.randomPlies = std::atoi(value(i).c_str());
+            else if (arg == "--openings")
+                options.openings = value(i);
+            else if (arg == "--network")
+                options.network = value(i);
+            else if (arg == "--seed")
+                options.seed = std::strtoull(value(i).c_str(), nullptr, 10);
+            else if (arg == "--compress")
+                options.compress = true;
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+
+            if (missing)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.output.empty())
+        {
+            std::cerr << "Missing --output" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Plays random legal moves; false if the game ended on the way
+    bool playRandomOpening(Position &position, int plies, std::mt19937_64 &rng)
+    {
+        for (int ply = 0; ply < plies; ply++)
+        {
+            MoveList moves;
+            position.generateLegal(moves);
+            if (moves.size() == 0)
+                return false;
+            position.makeMove(moves.moves[rng() % moves.size()]);
+        }
+
+        MoveList moves;
+        position.generateLegal(moves);
+        return moves.size() > 0;
+    }
+
+    // Returns the result for White and appends the game's quiet positions to records
+    int playGame(Position &position, Search &search, const SearchLimits &limits, std::vector<TrainingRecord> &records, Progress &progress)
+    {
+        int resignPlies = 0;
+
+        for (int ply = 0; ply < MAX_PLIES; ply++)
+        {
+            int us = position.sideToMove();
+
+            MoveList moves;
+            position.generateLegal(moves);
+            if (moves.size() == 0)
+                return position.inCheck() ? (us == 0 ? -1 : 1) : 0;
+            if (position.repetitionCount() >= 2 || position.halfmoveClock() >= 100 || position.hasInsufficientMaterial())
+                return 0;
+
+            auto result = search.run(position, limits);
+            progress.nodes.fetch_add(result.nodes, std::memory_order_relaxed);
+
+            int whiteScore = us == 0 ? result.score : -result.score;
+            resignPlies = std::abs(result.score) >= RESIGN_SCORE ? resignPlies + 1 : 0;
+            if (resignPlies >= RESIGN_PLIES)
+                return whiteScore > 0 ? 1 : -1;
+
+            bool quiet = !position.inCheck() && !position.isCapture(result.bestMove) &&
+                         result.bestMove.kind() != PackedMove::Promotion && !Search::isMateScore(result.score);
+            if (quiet)
+            {
+                TrainingRecord record{};
+                record.position = position.packed();
+                record.score = static_cast<std::int16_t>(result.score);
+                record.bestMove = result.bestMove.raw();
+                records.push_back(record);
+            }
+
+            position.makeMove(result.bestMove);
+        }
+
+        return 0;
+    }
+
+    void generatorLoop(const Options &options, const std::vector<std::string> &openings, const Nnue::Network *network,
+                       AsyncWriter &writer, Progress &progress, unsigned index)
+    {
+        std::mt19937_64 rng(options.seed * 0x9e3779b97f4a7c15ull + index);
+        Search search(network);
+        TranspositionTable table;
+        if (table.resize(options.hashMb))
+            search.setTranspositionTable(&table);
+        AsyncWriter::Channel channel(writer);
+
+        std::vector<TrainingRecord> records;
+        records.reserve(MAX_PLIES);
+
+        Position position;
+        while (!progress.done.load(std::memory_order_relaxed))
+        {
+            position.setFen(openings[rng() % openings.size()]);
+            if (!playRandomOpening(position, options.randomPlies, rng))
+                continue;
+
+            records.clear();
+            int result = playGame(position, search, options.limits, records, progress);
+            for (auto &record : records)
+                record.result = static_cast<std::int8_t>(result);
+
+            // Only copies into this thread's buffer; the disk is the writer thread's business
+            channel.write(records.data(), records.size() * sizeof(TrainingRecord));
+
+            progress.games.fetch_add(1, std::memory_order_relaxed);
+            if (progress.positions.fetch_add(records.size(), std::memory_order_relaxed) + records.size() >= options.positions)
+                progress.done = true;
+        }
+    }
+
+    bool loadOpenings(const std::string &path, std::vector<std::string> &openings)
+    {
+        if (path.empty())
+        {
+            openings.emplace_back(Position::START_FEN);
+            return true;
+        }
+
+        std::ifstream file(path);
+        Position position;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!line.empty() && line[0] != '#' && position.setFen(line))
+                openings.push_back(position.fen());
+        }
+
+        if (openings.empty())
+            std::cerr << "No openings in " << path << std::endl;
+        return !openings.empty();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+
+    std::vector<std::string> openings;
+    if (!loadOpenings(options.openings, openings))
+        return EXIT_FAILURE;
+
+    Nnue::Network network;
+    if (!options.network.empty() && !network.load(options.network))
+    {
+        std::cerr << "Could not load network " << options.network << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (options.compress && !AsyncWriter::compressionAvailable())
+    {
+        std::cerr << "Built without zlib, --compress is not available" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    AsyncWriter writer;
+    if (!writer.open(options.output, options.compress))
+    {
+        std::cerr << "Could not create " << options.output << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Generating " << options.positions << " positions on " << threads << " threads into " << options.output
+              << (options.compress ? " (gzip)" : "") << std::endl;
+
+    Progress progress;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> generators;
+    for (unsigned i = 0; i < threads; i++)
+        generators.emplace_back(generatorLoop, std::cref(options), std::cref(openings), network.isLoaded() ? &network : nullptr,
+                                std::ref(writer), std::ref(progress), i);
+
+    // Progress report once a second
+    while (!progress.done)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto statistics = writer.statistics();
+        std::cout << std::fixed << std::setprecision(0)
+                  << "Positions " << progress.positions << " (" << progress.positions / seconds << "/s)"
+                  << "  Games " << progress.games
+                  << "  Nodes/s " << progress.nodes / seconds
+                  << std::setprecision(1) << "  Queued " << statistics.queuedBytes / 1e6 << " MB" << std::endl;
+    }
+
+    for (auto &generator : generators)
+        generator.join();
+
+    bool written = writer.close();
+    auto statistics = writer.statistics();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Done: " << progress.positions << " positions from " << progress.games << " games in " << seconds << " s\n"
+              << "Written " << statistics.bytesWritten / 1e6 << " MB (" << statistics.bytesSubmitted / 1e6 << " MB raw) in "
+              << statistics.buffersWritten << " writes, " << statistics.buffersAllocated << " buffers, "
+              << statistics.writeSeconds << " s spent writing" << std::endl;
+
+    if (!written)
+    {
+        std::cerr << "Write error on " << options.output << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,212 @@
+// Renders board diagrams for a list of positions, on the CPU and on every core.
+//
+// chess_diagram --input FILE --output DIR [--format png|svg] [--size PX] [--flip] [--threads N] [--assets DIR]
+//
+// Every line of the input is a FEN, optionally followed by ';' and squares or moves to
+// highlight ("...w KQkq - 0 1; e2e4 d4"). Blank lines and lines starting with '#' are skipped.
+// The n-th position is written to DIR/<n, six digits>.<format> (000001.png, ...).
+
+#include "DiagramRenderer.h"
+#include "Position.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace Chess;
+
+    struct Options
+    {
+        std::string input;
+        std::string output;
+        std::string format = "png";
+        std::string assets = "assets";
+        int size = 400;
+        bool flipped = false;
+        unsigned threads = 0;
+    };
+
+    struct Job
+    {
+        int line = 0;
+        std::string fen;
+        std::string highlights;
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--flip")
+            {
+                options.flipped = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--input")
+                options.input = value;
+            else if (arg == "--output")
+                options.output = value;
+            else if (arg == "--format")
+                options.format = value;
+            else if (arg == "--assets")
+                options.assets = value;
+            else if (arg == "--size")
+                options.size = std::max(8, std::atoi(value.c_str()));
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.input.empty() || options.output.empty())
+        {
+            std::cerr << "Both --input and --output are required" << std::endl;
+            return false;
+        }
+        if (options.format != "png" && options.format != "svg")
+        {
+            std::cerr << "Unknown format " << options.format << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Squares (e4) and moves (e2e4, whose squares both count); every square if one is unreadable
+    Bitboard parseHighlights(const std::string &text)
+    {
+        Bitboard squares = 0;
+        std::istringstream words(text);
+        std::string word;
+        while (words >> word)
+        {
+            if (word.size() != 2 && word.size() != 4 && word.size() != 5)
+                return ~Bitboard(0);
+            for (std::size_t i = 0; i + 1 < word.size() && i < 4; i += 2)
+            {
+                if (word[i] < 'a' || word[i] > 'h' || word[i + 1] < '1' || word[i + 1] > '8')
+                    return ~Bitboard(0);
+                squares |= Bitboards::squareBit((word[i + 1] - '1') * 8 + (word[i] - 'a'));
+            }
+        }
+        return squares;
+    }
+
+    bool writeFile(const std::string &path, const void *data, std::size_t size)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        return static_cast<bool>(file);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+
+    DiagramRenderer renderer;
+    if (!renderer.load(options.assets))
+        return EXIT_FAILURE;
+    if (options.format == "png" && !renderer.canRenderPng())
+    {
+        std::cerr << "PNG output needs zlib: use --format svg" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream input(options.input);
+    if (!input)
+    {
+        std::cerr << "Could not open " << options.input << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Job> jobs;
+    std::string line;
+    for (int number = 1; std::getline(input, line); number++)
+    {
+        if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        auto separator = line.find(';');
+        jobs.push_back({number, line.substr(0, separator), separator == std::string::npos ? std::string() : line.substr(separator + 1)});
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.output, error);
+    if (error)
+    {
+        std::cerr << "Could not create " << options.output << ": " << error.message() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::atomic<std::size_t> failed = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    ThreadPool pool(options.threads);
+    pool.parallelFor(jobs.size(), 64, [&](std::size_t begin, std::size_t end)
+                     {
+                         Position position;
+                         std::vector<std::uint8_t> png;
+                         for (std::size_t i = begin; i < end; i++)
+                         {
+                             const auto &job = jobs[i];
+                             DiagramRenderer::Options diagram;
+                             diagram.size = options.size;
+                             diagram.flipped = options.flipped;
+                             diagram.highlights = parseHighlights(job.highlights);
+
+                             if (!position.setFen(job.fen) || diagram.highlights == ~Bitboard(0))
+                             {
+                                 std::cerr << "Line " << job.line << ": unreadable position" << std::endl;
+                                 failed.fetch_add(1, std::memory_order_relaxed);
+                                 continue;
+                             }
+
+                             char name[32];
+                             std::snprintf(name, sizeof(name), "%06zu.%s", i + 1, options.format.c_str());
+                             auto path = (std::filesystem::path(options.output) / name).string();
+
+                             bool written;
+                             if (options.format == "svg")
+                             {
+                                 auto svg = renderer.renderSvg(position.board(), diagram);
+                                 written = writeFile(path, svg.data(), svg.size());
+                             }
+                             else
+                                 written = renderer.renderPng(position.board(), diagram, png) && writeFile(path, png.data(), png.size());
+
+                             if (!written)
+                             {
+                                 std::cerr << "Could not write " << path << std::endl;
+                                 failed.fetch_add(1, std::memory_order_relaxed);
+                             }
+                         } });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::size_t rendered = jobs.size() - failed;
+    std::cout << "Rendered " << rendered << " diagrams in " << seconds << " s (" << static_cast<long long>(rendered / std::max(seconds, 1e-9))
+              << " per second on " << pool.size() << " threads)" << std::endl;
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,333 @@
+// Runs an EPD test suite on every core and reports how many positions the engine solves
+// and how soon.
+//
+// chess_epd --input FILE [--movetime MS] [--nodes N] [--depth N] [--threads N] [--hash MB]
+//           [--network FILE] [--json FILE]
+//
+// A position is solved when the search ends on one of its bm moves and on none of its am
+// moves; positions with neither are skipped. Time and nodes to solution are those of the
+// first iteration from which every later one chose a solving move. Each position is searched
+// on its own with a fresh transposition table of --hash megabytes (default 16), for
+// --movetime milliseconds (default 1000 unless --nodes or --depth is given).
+
+#include "Epd.h"
+#include "Nnue.h"
+#include "Position.h"
+#include "Search.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace Chess;
+
+    struct Options
+    {
+        std::string input;
+        std::string json;
+        std::string network;
+        SearchLimits limits{.depth = Search::MAX_PLY};
+        unsigned threads = 0;
+        std::size_t hashMb = 16;
+    };
+
+    struct TestPosition
+    {
+        int line = 0;
+        std::string id;
+        std::string fen;
+        std::vector<PackedMove> bestMoves; // bm
+        std::vector<PackedMove> avoidMoves; // am
+        std::string expected; // Operands as written, for the report
+
+        // Filled by the search
+        bool solved = false;
+        std::string played; // SAN
+        int depth = 0;
+        std::int64_t timeMs = 0;
+        std::uint64_t nodes = 0;
+        std::int64_t solutionTimeMs = 0; // Only if solved
+        std::uint64_t solutionNodes = 0;
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--input")
+                options.input = value;
+            else if (arg == "--json")
+                options.json = value;
+            else if (arg == "--network")
+                options.network = value;
+            else if (arg == "--movetime")
+                options.limits.moveTimeMs = std::atoll(value.c_str());
+            else if (arg == "--nodes")
+                options.limits.nodes = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--depth")
+                options.limits.depth = std::clamp(std::atoi(value.c_str()), 1, static_cast<int>(Search::MAX_PLY));
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::atoi(value.c_str()));
+            else if (arg == "--hash")
+                options.hashMb = std::strtoull(value.c_str(), nullptr, 10);
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.input.empty())
+        {
+            std::cerr << "--input is required" << std::endl;
+            return false;
+        }
+
+        if (options.limits.moveTimeMs == 0 && options.limits.nodes == 0 && options.limits.depth == Search::MAX_PLY)
+            options.limits.moveTimeMs = 1000;
+        return true;
+    }
+
+    // Moves of a bm or am operation; false if one of them isn't legal here
+    bool readMoves(const Position &position, const EpdOperation *operation, std::vector<PackedMove> &moves, std::string &text)
+    {
+        if (operation == nullptr)
+            return true;
+
+        for (const auto &operand : operation->operands)
+        {
+            auto move = position.parseMove(operand);
+            if (move.isNone())
+                return false;
+            moves.push_back(move);
+            text += (text.empty() ? "" : " ") + operand;
+        }
+        return true;
+    }
+
+    bool loadSuite(const std::string &path, std::vector<TestPosition> &suite)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cerr << "Could not open " << path << std::endl;
+            return false;
+        }
+
+        Position position;
+        std::string line;
+        for (int number = 1; std::getline(file, line); number++)
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            EpdRecord record;
+            if (!readEpd(line, record) || !position.setFen(record.fen))
+            {
+                std::cerr << "Skipping line " << number << ": invalid EPD" << std::endl;
+                continue;
+            }
+
+            TestPosition test;
+            test.line = number;
+            test.id = record.id();
+            test.fen = record.fen;
+
+            std::string avoided;
+            if (!readMoves(position, record.operation("bm"), test.bestMoves, test.expected) ||
+                !readMoves(position, record.operation("am"), test.avoidMoves, avoided))
+            {
+                std::cerr << "Skipping line " << number << ": illegal move in bm or am" << std::endl;
+                continue;
+            }
+            if (test.bestMoves.empty() && test.avoidMoves.empty())
+            {
+                std::cerr << "Skipping line " << number << ": no bm or am" << std::endl;
+                continue;
+            }
+
+            if (!avoided.empty())
+                test.expected += (test.expected.empty() ? "not " : ", not ") + avoided;
+            if (test.id.empty())
+                test.id = "line " + std::to_string(number);
+            suite.push_back(std::move(test));
+        }
+
+        if (suite.empty())
+            std::cerr << "No test positions in " << path << std::endl;
+        return !suite.empty();
+    }
+
+    bool solves(const TestPosition &test, PackedMove move)
+    {
+        auto contains = [move](const std::vector<PackedMove> &moves)
+        {
+            return std::find(moves.begin(), moves.end(), move) != moves.end();
+        };
+        return !move.isNone() && (test.bestMoves.empty() || contains(test.bestMoves)) && !contains(test.avoidMoves);
+    }
+
+    void runTest(TestPosition &test, const Options &options, const Nnue::Network *network)
+    {
+        Position position;
+        position.setFen(test.fen);
+
+        Search search(network);
+        TranspositionTable table;
+        if (table.resize(options.hashMb))
+            search.setTranspositionTable(&table);
+
+        // Solved from the first iteration of the last unbroken run of solving ones
+        bool solving = false;
+        search.setIterationCallback([&](const SearchResult &iteration)
+                                    {
+            if (!solves(test, iteration.bestMove))
+                solving = false;
+            else if (!solving)
+            {
+                solving = true;
+                test.solutionTimeMs = iteration.timeMs;
+                test.solutionNodes = iteration.nodes;
+            } });
+
+        auto result = search.run(position, options.limits);
+
+        // A partial last iteration may still change the move
+        if (solves(test, result.bestMove) && !solving)
+        {
+            solving = true;
+            test.solutionTimeMs = result.timeMs;
+            test.solutionNodes = result.nodes;
+        }
+
+        test.solved = solving && solves(test, result.bestMove);
+        test.played = result.bestMove.isNone() ? "-" : position.toSan(result.bestMove);
+        test.depth = result.depth;
+        test.timeMs = result.timeMs;
+        test.nodes = result.nodes;
+    }
+
+    std::string jsonString(const std::string &text)
+    {
+        std::string escaped;
+        for (auto symbol : text)
+        {
+            if (symbol == '"' || symbol == '\\')
+                escaped += '\\';
+            escaped += symbol;
+        }
+        return '"' + escaped + '"';
+    }
+
+    bool writeJson(const std::string &path, const Options &options, const std::vector<TestPosition> &suite, double seconds)
+    {
+        std::ofstream out(path);
+        out << std::setprecision(6);
+        out << "{\n  \"input\": " << jsonString(options.input) << ",\n  \"movetime_ms\": " << options.limits.moveTimeMs
+            << ",\n  \"nodes\": " << options.limits.nodes << ",\n  \"depth\": " << options.limits.depth
+            << ",\n  \"seconds\": " << seconds << ",\n  \"positions\": [";
+        for (std::size_t i = 0; i < suite.size(); i++)
+        {
+            const auto &test = suite[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"id\": " << jsonString(test.id) << ", \"line\": " << test.line
+                << ", \"expected\": " << jsonString(test.expected) << ", \"played\": " << jsonString(test.played)
+                << ", \"solved\": " << (test.solved ? "true" : "false") << ", \"depth\": " << test.depth
+                << ", \"ms\": " << test.timeMs << ", \"nodes\": " << test.nodes;
+            if (test.solved)
+                out << ", \"solution_ms\": " << test.solutionTimeMs << ", \"solution_nodes\": " << test.solutionNodes;
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+
+        if (!out)
+        {
+            std::cerr << "Could not write " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+
+    std::vector<TestPosition> suite;
+    if (!loadSuite(options.input, suite))
+        return EXIT_FAILURE;
+
+    Nnue::Network network;
+    if (!options.network.empty() && !network.load(options.network))
+    {
+        std::cerr << "Could not load network " << options.network << std::endl;
+        return EXIT_FAILURE;
+    }
+    const Nnue::Network *evaluation = options.network.empty() ? nullptr : &network;
+
+    ThreadPool pool(options.threads);
+    std::cout << suite.size() << " positions on " << pool.size() << " threads" << std::endl;
+
+    std::mutex mutex;
+    std::size_t finished = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto &test : suite)
+    {
+        pool.submit([&]
+                    {
+            runTest(test, options, evaluation);
+
+            std::lock_guard lock(mutex);
+            std::cout << std::setw(5) << ++finished << "  " << (test.solved ? "solved" : "failed") << "  " << test.id
+                      << "  expected " << test.expected << ", played " << test.played << " (depth " << test.depth << ")";
+            if (test.solved)
+                std::cout << "  in " << test.solutionTimeMs << " ms, " << test.solutionNodes << " nodes";
+            std::cout << std::endl; });
+    }
+    pool.wait();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int solved = 0;
+    std::int64_t solutionMs = 0;
+    std::uint64_t solutionNodes = 0, nodes = 0;
+    for (const auto &test : suite)
+    {
+        nodes += test.nodes;
+        if (!test.solved)
+            continue;
+        solved++;
+        solutionMs += test.solutionTimeMs;
+        solutionNodes += test.solutionNodes;
+    }
+
+    std::cout << "\nSolved " << solved << "/" << suite.size() << std::fixed << std::setprecision(1) << " ("
+              << 100.0 * solved / suite.size() << "%)\n";
+    if (solved > 0)
+        std::cout << "Time to solution: " << solutionMs << " ms in total, " << static_cast<double>(solutionMs) / solved
+                  << " ms mean; nodes to solution: " << solutionNodes / solved << " mean\n";
+    std::cout << "Searched " << nodes << " nodes in " << seconds << " s (" << nodes / std::max(seconds, 1e-9) / 1e6 << " Mnps)" << std::endl;
+
+    if (!options.json.empty() && !writeJson(options.json, options, suite, seconds))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+// Builds a position index of a PGN archive, or looks a position up in one.
+//
+// chess_index --pgn FILE --output FILE [--threads N]
+// chess_index --index FILE --fen FEN [--pgn FILE] [--games N]
+//
+// A lookup prints how often each move was played from the position with its score for White,
+// then the first games that reached it (with their tags when the indexed PGN file is given).
+
+#include "MappedFile.h"
+#include "Pgn.h"
+#include "Position.h"
+#include "PositionIndex.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    using namespace Chess;
+
+    struct Options
+    {
+        std::string pgn;
+        std::string output;
+        std::string index;
+        std::string fen;
+        unsigned threads = 0;
+        int games = 10;
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--pgn")
+                options.pgn = value;
+            else if (arg == "--output")
+                options.output = value;
+            else if (arg == "--index")
+                options.index = value;
+            else if (arg == "--fen")
+                options.fen = value;
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+            else if (arg == "--games")
+                options.games = std::atoi(value.c_str());
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        bool build = !options.pgn.empty() && !options.output.empty();
+        bool query = !options.index.empty() && !options.fen.empty();
+        if (build == query)
+        {
+            std::cerr << "Either --pgn and --output, or --index and --fen" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int build(const Options &options)
+    {
+        PositionIndex::BuildStatistics statistics;
+        if (!PositionIndex::build(options.pgn, options.output, options.threads, &statistics))
+            return 1;
+
+        std::cout << "Indexed " << statistics.positions << " positions from " << statistics.games << " games in "
+                  << std::fixed << std::setprecision(1) << statistics.seconds << " s" << std::endl;
+        if (statistics.truncatedGames > 0)
+            std::cout << statistics.truncatedGames << " games were indexed only up to an unreadable move" << std::endl;
+        return 0;
+    }
+
+    int query(const Options &options)
+    {
+        PositionIndex index;
+        if (!index.open(options.index))
+            return 1;
+
+        Position position;
+        if (!position.setFen(options.fen))
+        {
+            std::cerr << "Invalid FEN" << std::endl;
+            return 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto occurrences = index.find(position.key());
+        auto moves = index.moveStatistics(position.key());
+        auto micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << occurrences.size() << " occurrences in " << index.gameCount() << " games (" << std::fixed << std::setprecision(1) << micros << " us)" << std::endl;
+        for (const auto &move : moves)
+        {
+            std::cout << std::setw(8) << position.toSan(move.move) << std::setw(10) << move.games << std::setw(7) << std::setprecision(1) << move.whiteScore() * 100.0 << "%"
+                      << "  (+" << move.whiteWins << " =" << move.draws << " -" << move.blackWins << ")" << std::endl;
+        }
+
+        // Tags come from the PGN file, if it is the one indexed
+        MappedFile pgn;
+        bool withTags = !options.pgn.empty() && pgn.open(options.pgn) && pgn.size() == index.pgnSize();
+        std::string_view text = withTags ? std::string_view(reinterpret_cast<const char *>(pgn.data()), pgn.size()) : std::string_view();
+
+        for (std::size_t i = 0; i < occurrences.size() && static_cast<int>(i) < options.games; i++)
+        {
+            const auto &game = index.game(occurrences[i].game);
+            std::cout << "Game " << occurrences[i].game << " ply " << occurrences[i].ply << " (byte " << game.offset << ")";
+
+            PgnGame tags;
+            if (withTags)
+            {
+                readPgn(text.substr(game.offset, game.length), tags);
+                for (const auto &[name, value] : tags.tags)
+                {
+                    if (name == "White" || name == "Black" || name == "Date")
+                        std::cout << ' ' << value;
+                }
+                std::cout << ' ' << tags.result;
+            }
+            std::cout << std::endl;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    return options.output.empty() ? query(options) : build(options);
+}
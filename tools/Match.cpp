@@ -0,0 +1,432 @@
+// Plays two engine configurations against each other without a window, one game per
+// worker thread, and reports the Elo difference with SPRT bounds as results come in.
+//
+// chess_match [--openings FILE] [--games N] [--concurrency N]
+//             [--nodes N] [--movetime MS] [--depth N] [--tc SECONDS+INCREMENT] [--hash MB]
+//             [--network-a FILE] [--network-b FILE] [--pgn FILE]
+//             [--sprt ELO0 ELO1 ALPHA BETA] [--random-plies N] [--seed N]
+//             [--resign CP MOVES] [--draw CP MOVES FROM_PLY] [--max-plies N]
+//
+// Openings are read one FEN (or EPD) per line; each one is played twice with colors swapped.
+// Without a network an engine uses the hand-crafted evaluation. Each engine gets a fresh
+// transposition table of --hash megabytes (default 16) for every game.
+
+#include "Elo.h"
+#include "Nnue.h"
+#include "Pgn.h"
+#include "Position.h"
+#include "Search.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace Chess;
+
+    struct Options
+    {
+        std::string openings;
+        int games = 0; // 0 = two per opening
+        unsigned concurrency = 0;
+
+        SearchLimits limits{.depth = Search::MAX_PLY};
+        std::int64_t baseMs = 0; // Clock, 0 = no clock
+        std::int64_t incrementMs = 0;
+        std::size_t hashMb = 16;
+
+        std::string networkA, networkB;
+        std::string pgn;
+
+        bool sprt = false;
+        Sprt test;
+
+        int randomPlies = 0;
+        unsigned seed = 1;
+
+        int resignScore = 1000, resignMoves = 3;
+        int drawScore = 10, drawMoves = 8, drawFromPly = 80;
+        int maxPlies = 400;
+    };
+
+    struct Engine
+    {
+        std::string name;
+        const Nnue::Network *network = nullptr;
+    };
+
+    struct GameResult
+    {
+        int scoreA = 0; // 1 win, 0 draw, -1 loss for engine A
+        std::string termination;
+        PgnGame pgn;
+        std::uint64_t nodes = 0;
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        bool missing = false;
+        auto value = [&](int &i) -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                missing = true;
+                return "";
+            }
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--openings")
+                options.openings = value(i);
+            else if (arg == "--games")
+                options.games = std::atoi(value(i).c_str());
+            else if (arg == "--concurrency")
+                options.concurrency = static_cast<unsigned>(std::atoi(value(i).c_str()));
+            else if (arg == "--nodes")
+                options.limits.nodes = std::strtoull(value(i).c_str(), nullptr, 10);
+            else if (arg == "--movetime")
+                options.limits.moveTimeMs = std::atoll(value(i).c_str());
+            else if (arg == "--depth")
+                options.limits.depth = std::atoi(value(i).c_str());
+            else if (arg == "--tc")
+            {
+                auto tc = value(i);
+                auto plus = tc.find('+');
+                options.baseMs = static_cast<std::int64_t>(std::atof(tc.substr(0, plus).c_str()) * 1000.0);
+                if (plus != std::string::npos)
+                    options.incrementMs = static_cast<std::int64_t>(std::atof(tc.substr(plus + 1).c_str()) * 1000.0);
+            }
+            else if (arg == "--hash")
+                options.hashMb = std::strtoull(value(i).c_str(), nullptr, 10);
+            else if (arg == "--network-a")
+                options.networkA = value(i);
+            else if (arg == "--network-b")
+                options.networkB = value(i);
+            else if (arg == "--pgn")
+                options.pgn = value(i);
+            else if (arg == "--sprt")
+            {
+                options.sprt = true;
+                options.test.elo0 = std::atof(value(i).c_str());
+                options.test.elo1 = std::atof(value(i).c_str());
+                options.test.alpha = std::atof(value(i).c_str());
+                options.test.beta = std::atof(value(i).c_str());
+            }
+            else if (arg == "--random-plies")
+                options.randomPlies = std::atoi(value(i).c_str());
+            else if (arg == "--seed")
+                options.seed = static_cast<unsigned>(std::atoi(value(i).c_str()));
+            else if (arg == "--resign")
+            {
+                options.resignScore = std::atoi(value(i).c_str());
+                options.resignMoves = std::atoi(value(i).c_str());
+            }
+            else if (arg == "--draw")
+            {
+                options.drawScore = std::atoi(value(i).c_str());
+                options.drawMoves = std::atoi(value(i).c_str());
+                options.drawFromPly = std::atoi(value(i).c_str());
+            }
+            else if (arg == "--max-plies")
+                options.maxPlies = std::atoi(value(i).c_str());
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+
+            if (missing)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.sprt && (options.test.alpha <= 0.0 || options.test.beta <= 0.0 || options.test.elo1 <= options.test.elo0))
+        {
+            std::cerr << "Invalid --sprt parameters" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool loadOpenings(const std::string &path, std::vector<std::string> &openings)
+    {
+        if (path.empty())
+        {
+            openings.emplace_back(Position::START_FEN);
+            return true;
+        }
+
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cerr << "Could not open " << path << std::endl;
+            return false;
+        }
+
+        Position position;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            if (!position.setFen(line))
+            {
+                std::cerr << "Skipping invalid opening: " << line << std::endl;
+                continue;
+            }
+            openings.push_back(position.fen());
+        }
+
+        if (openings.empty())
+            std::cerr << "No openings in " << path << std::endl;
+        return !openings.empty();
+    }
+
+    GameResult playGame(const Options &options, const std::string &opening, const Engine &white, const Engine &black, bool aIsWhite, unsigned seed)
+    {
+        GameResult result;
+
+        Position position;
+        position.setFen(opening);
+
+        // Random opening moves to diversify games (same seed for both games of a pair)
+        std::mt19937 rng(seed);
+        for (int ply = 0; ply < options.randomPlies; ply++)
+        {
+            MoveList moves;
+            position.generateLegal(moves);
+            if (moves.size() == 0)
+                break;
+            position.makeMove(moves.moves[rng() % moves.size()]);
+        }
+
+        result.pgn.fen = position.fen();
+        if (result.pgn.fen == Position::START_FEN)
+            result.pgn.fen.clear();
+
+        std::array<Search, 2> searches = {Search(white.network), Search(black.network)};
+        std::array<TranspositionTable, 2> tables;
+        for (int side = 0; side < 2; side++)
+        {
+            if (tables[side].resize(options.hashMb))
+                searches[side].setTranspositionTable(&tables[side]);
+        }
+        std::array<std::int64_t, 2> clocks = {options.baseMs, options.baseMs};
+
+        // White's point of view; 0 = draw, 1 = White wins, -1 = Black wins
+        int outcome = 0;
+        int resignCount = 0, drawCount = 0, lastWhiteScore = 0;
+
+        for (int ply = 0;; ply++)
+        {
+            int us = position.sideToMove();
+
+            MoveList moves;
+            position.generateLegal(moves);
+            if (moves.size() == 0)
+            {
+                outcome = position.inCheck() ? (us == 0 ? -1 : 1) : 0;
+                result.termination = position.inCheck() ? "checkmate" : "stalemate";
+                break;
+            }
+            if (position.repetitionCount() >= 2 || position.halfmoveClock() >= 100 || position.hasInsufficientMaterial())
+            {
+                result.termination = position.repetitionCount() >= 2 ? "threefold repetition" : position.halfmoveClock() >= 100 ? "fifty-move rule"
+                                                                                                                                  : "insufficient material";
+                break;
+            }
+            if (ply >= options.maxPlies)
+            {
+                result.termination = "move limit";
+                break;
+            }
+
+            auto limits = options.limits;
+            if (options.baseMs > 0)
+            {
+                limits.timeLeftMs = clocks[us];
+                limits.incrementMs = options.incrementMs;
+            }
+
+            auto search = searches[us].run(position, limits);
+            result.nodes += search.nodes;
+
+            if (options.baseMs > 0)
+            {
+                clocks[us] -= search.timeMs;
+                if (clocks[us] < 0)
+                {
+                    outcome = us == 0 ? -1 : 1;
+                    result.termination = "time forfeit";
+                    break;
+                }
+                clocks[us] += options.incrementMs;
+            }
+
+            // Adjudication when both engines agree over consecutive moves
+            int whiteScore = us == 0 ? search.score : -search.score;
+            bool agrees = (whiteScore > 0) == (lastWhiteScore > 0);
+            resignCount = std::abs(whiteScore) >= options.resignScore ? (agrees ? resignCount + 1 : 1) : 0;
+            drawCount = ply >= options.drawFromPly && std::abs(whiteScore) <= options.drawScore ? drawCount + 1 : 0;
+            lastWhiteScore = whiteScore;
+
+            position.makeMove(search.bestMove);
+            result.pgn.moves.push_back(search.bestMove);
+
+            if (options.resignMoves > 0 && resignCount >= 2 * options.resignMoves)
+            {
+                outcome = whiteScore > 0 ? 1 : -1;
+                result.termination = "adjudication";
+                break;
+            }
+            if (options.drawMoves > 0 && drawCount >= 2 * options.drawMoves)
+            {
+                result.termination = "adjudication";
+                break;
+            }
+        }
+
+        result.scoreA = aIsWhite ? outcome : -outcome;
+        result.pgn.result = outcome == 1 ? "1-0" : outcome == -1 ? "0-1"
+                                                                 : "1/2-1/2";
+        result.pgn.tags = {
+            {"Event", "chess_match"},
+            {"Site", "?"},
+            {"White", white.name},
+            {"Black", black.name},
+            {"Termination", result.termination},
+        };
+        return result;
+    }
+
+    std::string engineName(const std::string &label, const std::string &network)
+    {
+        return label + (network.empty() ? " (hce)" : " (" + std::filesystem::path(network).filename().string() + ")");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+
+    if (options.limits.nodes == 0 && options.limits.moveTimeMs == 0 && options.baseMs == 0 && options.limits.depth == Search::MAX_PLY)
+        options.limits.nodes = 20000; // Some limit is needed
+
+    std::vector<std::string> openings;
+    if (!loadOpenings(options.openings, openings))
+        return EXIT_FAILURE;
+
+    Nnue::Network networkA, networkB;
+    Engine engineA{engineName("A", options.networkA)}, engineB{engineName("B", options.networkB)};
+    for (auto [path, network, engine] : {std::tuple{options.networkA, &networkA, &engineA}, std::tuple{options.networkB, &networkB, &engineB}})
+    {
+        if (path.empty())
+            continue;
+        if (!network->load(path))
+        {
+            std::cerr << "Could not load network " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        engine->network = network;
+    }
+
+    std::ofstream pgn;
+    if (!options.pgn.empty())
+    {
+        pgn.open(options.pgn);
+        if (!pgn)
+        {
+            std::cerr << "Could not write " << options.pgn << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    int games = options.games > 0 ? options.games : 2 * static_cast<int>(openings.size());
+    ThreadPool pool(options.concurrency);
+
+    std::cout << engineA.name << " vs " << engineB.name << ": " << games << " games on " << pool.size() << " threads" << std::endl;
+
+    std::mutex mutex;
+    std::atomic<bool> finished = false;
+    MatchScore score;
+    std::uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int game = 0; game < games; game++)
+    {
+        pool.submit([&, game]
+                    {
+            if (finished)
+                return;
+
+            // Games 2k and 2k + 1 share an opening with colors swapped
+            int pair = game / 2;
+            bool aIsWhite = game % 2 == 0;
+            const auto &opening = openings[pair % openings.size()];
+            auto result = aIsWhite ? playGame(options, opening, engineA, engineB, true, options.seed + pair)
+                                   : playGame(options, opening, engineB, engineA, false, options.seed + pair);
+
+            std::lock_guard lock(mutex);
+            if (finished)
+                return;
+
+            result.pgn.tags.insert(result.pgn.tags.begin() + 2, {"Round", std::to_string(game + 1)});
+            if (pgn.is_open())
+                writePgn(pgn, result.pgn);
+
+            (result.scoreA > 0 ? score.wins : result.scoreA < 0 ? score.losses : score.draws)++;
+            totalNodes += result.nodes;
+
+            std::cout << "Game " << std::setw(5) << score.games() << ": " << result.pgn.result << " (" << result.termination << ")"
+                      << "  W-L-D " << score.wins << "-" << score.losses << "-" << score.draws
+                      << std::fixed << std::setprecision(1) << "  Elo " << eloDifference(score) << " +/- " << eloMargin(score);
+            if (options.sprt)
+            {
+                std::cout << std::setprecision(2) << "  LLR " << options.test.llr(score)
+                          << " [" << options.test.lowerBound() << ", " << options.test.upperBound() << "]";
+                if (options.test.decide(score) != Sprt::Decision::Continue)
+                    finished = true;
+            }
+            std::cout << std::endl; });
+    }
+    pool.wait();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\nScore of " << engineA.name << " vs " << engineB.name << ": "
+              << score.wins << " - " << score.losses << " - " << score.draws << "\n"
+              << std::fixed << std::setprecision(1)
+              << "Elo difference: " << eloDifference(score) << " +/- " << eloMargin(score) << "\n";
+    if (options.sprt)
+    {
+        auto decision = options.test.decide(score);
+        std::cout << "SPRT (" << options.test.elo0 << ", " << options.test.elo1 << "): "
+                  << (decision == Sprt::Decision::AcceptH1 ? "H1 accepted" : decision == Sprt::Decision::AcceptH0 ? "H0 accepted"
+                                                                                                                   : "inconclusive")
+                  << std::setprecision(2) << " (LLR " << options.test.llr(score) << ")\n";
+    }
+    std::cout << std::setprecision(1) << "Throughput: " << score.games() * 60.0 / seconds << " games/min, "
+              << totalNodes / seconds / 1e6 << " Mnps" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+// Proves forced mates for a file of puzzles on every core and checks that each has one solution.
+//
+// chess_mate --input FILE [--max-moves N] [--nodes N] [--threads N] [--hash MB] [--json FILE]
+//
+// Every line of the input is a FEN, optionally followed by ';' and the expected number of
+// moves to mate ("...w - - 0 1; 3"). Blank lines and lines starting with '#' are skipped.
+// Each puzzle gets the shortest mate up to --max-moves (default 5, or the expected number if
+// it is larger) within --nodes proof-number nodes (default 5M). A puzzle is solved when a mate
+// is proven; it is sound when that mate is unique and as long as expected.
+
+#include "MateSolver.h"
+#include "Position.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace Chess;
+
+    struct Options
+    {
+        std::string input;
+        std::string json;
+        int maxMoves = 5;
+        std::uint64_t nodes = MateSolver::DEFAULT_NODE_LIMIT;
+        unsigned threads = 0;
+        std::size_t hashMb = MateSolver::DEFAULT_TABLE_MB;
+    };
+
+    struct Puzzle
+    {
+        int line = 0;
+        std::string fen;
+        int expected = 0; // 0 = not given
+        bool readable = true;
+        MateSolver::Result result;
+        std::string solution; // SAN
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--input")
+                options.input = value;
+            else if (arg == "--json")
+                options.json = value;
+            else if (arg == "--max-moves")
+                options.maxMoves = std::clamp(std::atoi(value.c_str()), 1, 32);
+            else if (arg == "--nodes")
+                options.nodes = std::strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+            else if (arg == "--hash")
+                options.hashMb = std::max<std::size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.input.empty())
+        {
+            std::cerr << "--input is required" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    const char *statusName(MateSolver::Status status)
+    {
+        switch (status)
+        {
+        case MateSolver::Status::Mate:
+            return "mate";
+        case MateSolver::Status::NoMate:
+            return "no mate";
+        default:
+            return "unknown";
+        }
+    }
+
+    bool isSound(const Puzzle &puzzle)
+    {
+        return puzzle.result.isUnique() && (puzzle.expected == 0 || puzzle.result.mateIn == puzzle.expected);
+    }
+
+    void solveAll(std::vector<Puzzle> &puzzles, const Options &options, std::atomic<std::size_t> &next)
+    {
+        MateSolver solver(options.hashMb);
+        Position position;
+        for (auto i = next.fetch_add(1); i < puzzles.size(); i = next.fetch_add(1))
+        {
+            auto &puzzle = puzzles[i];
+            if (!position.setFen(puzzle.fen))
+            {
+                puzzle.readable = false;
+                continue;
+            }
+
+            puzzle.result = solver.solve(position, std::max(options.maxMoves, puzzle.expected), options.nodes);
+
+            auto replay = position;
+            for (auto move : puzzle.result.line)
+            {
+                puzzle.solution += (puzzle.solution.empty() ? "" : " ") + replay.toSan(move);
+                replay.makeMove(move);
+            }
+        }
+    }
+
+    bool writeJson(const std::string &path, const std::vector<Puzzle> &puzzles, double seconds)
+    {
+        std::ofstream out(path);
+        out << "{\n  \"seconds\": " << seconds << ",\n  \"puzzles\": [";
+        for (std::size_t i = 0; i < puzzles.size(); i++)
+        {
+            const auto &puzzle = puzzles[i];
+            const auto &result = puzzle.result;
+            out << (i == 0 ? "\n" : ",\n") << "    {\"line\": " << puzzle.line << ", \"fen\": \"" << puzzle.fen << "\", \"status\": \""
+                << (puzzle.readable ? statusName(result.status) : "unreadable") << "\", \"mate_in\": " << result.mateIn
+                << ", \"expected\": " << puzzle.expected << ", \"key_moves\": " << result.keyMoves.size()
+                << ", \"sound\": " << (isSound(puzzle) ? "true" : "false") << ", \"solution\": \"" << puzzle.solution
+                << "\", \"nodes\": " << result.nodes << ", \"ms\": " << result.timeMs << "}";
+        }
+        out << "\n  ]\n}\n";
+
+        if (!out)
+        {
+            std::cerr << "Could not write " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+
+    std::ifstream input(options.input);
+    if (!input)
+    {
+        std::cerr << "Could not open " << options.input << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Puzzle> puzzles;
+    std::string line;
+    for (int number = 1; std::getline(input, line); number++)
+    {
+        if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        Puzzle puzzle;
+        puzzle.line = number;
+        auto separator = line.find(';');
+        puzzle.fen = line.substr(0, separator);
+        if (separator != std::string::npos)
+            puzzle.expected = std::max(0, std::atoi(line.c_str() + separator + 1));
+        puzzles.push_back(std::move(puzzle));
+    }
+
+    unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, std::max<std::size_t>(puzzles.size(), 1));
+    std::cout << "Solving " << puzzles.size() << " puzzles on " << threads << " threads" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next = 0;
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++)
+        workers.emplace_back(solveAll, std::ref(puzzles), std::cref(options), std::ref(next));
+    for (auto &worker : workers)
+        worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int solved = 0, sound = 0, noMate = 0, unknown = 0, unreadable = 0;
+    std::vector<std::int64_t> times;
+    for (const auto &puzzle : puzzles)
+    {
+        const auto &result = puzzle.result;
+        if (!puzzle.readable)
+        {
+            std::cout << "Line " << puzzle.line << ": unreadable position" << std::endl;
+            unreadable++;
+            continue;
+        }
+
+        times.push_back(result.timeMs);
+        solved += result.status == MateSolver::Status::Mate;
+        noMate += result.status == MateSolver::Status::NoMate;
+        unknown += result.status == MateSolver::Status::Unknown;
+        sound += isSound(puzzle);
+
+        std::cout << "Line " << std::left << std::setw(6) << puzzle.line << std::setw(8) << statusName(result.status) << std::right;
+        if (result.mateIn != 0)
+            std::cout << " #" << result.mateIn;
+        if (result.status == MateSolver::Status::Mate && result.keyMoves.size() > 1)
+            std::cout << " (" << result.keyMoves.size() << " key moves)";
+        if (puzzle.expected != 0 && result.mateIn != puzzle.expected)
+            std::cout << " (expected #" << puzzle.expected << ")";
+        std::cout << "  " << result.nodes << " nodes, " << result.timeMs << " ms  " << puzzle.solution << std::endl;
+    }
+
+    std::sort(times.begin(), times.end());
+    std::size_t count = std::max<std::size_t>(puzzles.size() - unreadable, 1);
+    double mean = 0.0;
+    for (auto time : times)
+        mean += time;
+    mean /= count;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Solved " << solved << "/" << puzzles.size() << " (" << 100.0 * solved / std::max<std::size_t>(puzzles.size(), 1) << "%), "
+              << sound << " sound, " << noMate << " without mate, " << unknown << " unknown, " << unreadable << " unreadable\n"
+              << "Time per puzzle: mean " << mean << " ms, median " << (times.empty() ? 0 : times[times.size() / 2]) << " ms, max "
+              << (times.empty() ? 0 : times.back()) << " ms; " << seconds << " s in total (" << puzzles.size() / std::max(seconds, 1e-9)
+              << " puzzles/s)" << std::endl;
+
+    if (!options.json.empty() && !writeJson(options.json, puzzles, seconds))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
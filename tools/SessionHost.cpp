@@ -0,0 +1,176 @@
+// Hosts many games in one process behind a Unix-domain socket (see src/SessionServer.h
+// for the frame layout), or measures the session manager in-process.
+//
+// chess_sessiond [--socket PATH] [--shards N]
+// chess_sessiond --load SESSIONS [--plies N] [--shards N]
+//
+// With --load, SESSIONS games are created and random legal moves are played in all of
+// them in rounds, then throughput, memory per session and move latency are printed.
+
+#include "GameSessionManager.h"
+#include "SessionServer.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <latch>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace Chess;
+
+    std::atomic<bool> s_Interrupted = false;
+
+    void printStatistics(const GameSessionManager &manager)
+    {
+        auto statistics = manager.statistics();
+        std::cout << "Sessions " << statistics.sessions
+                  << "  Memory " << statistics.sessionBytes / 1024 << " KiB ("
+                  << (statistics.sessions != 0 ? statistics.sessionBytes / statistics.sessions : 0) << " B/session, max "
+                  << statistics.maxSessionBytes << " B)"
+                  << "  Moves " << statistics.moves
+                  << "  Latency p50 " << statistics.p50Nanoseconds / 1000.0 << " us, p99 " << statistics.p99Nanoseconds / 1000.0 << " us"
+                  << std::endl;
+    }
+
+    int runLoad(GameSessionManager &manager, int sessions, int plies)
+    {
+        using Request = GameSessionManager::Request;
+
+        // Client-side mirrors, used to pick legal moves
+        std::vector<Position> mirrors(sessions);
+        std::vector<std::uint32_t> ids(sessions);
+        std::mt19937 rng(7);
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::latch created(sessions);
+            for (int i = 0; i < sessions; i++)
+            {
+                Request request;
+                request.command = GameSessionManager::Command::Create;
+                manager.submit(request, [&ids, &created, i](const GameSessionManager::Response &response)
+                               {
+                    ids[i] = response.session;
+                    created.count_down(); });
+            }
+            created.wait();
+        }
+
+        std::atomic<std::uint64_t> rejected = 0;
+        std::uint64_t submitted = 0;
+
+        for (int ply = 0; ply < plies; ply++)
+        {
+            std::vector<int> playing;
+            std::vector<PackedMove> chosen;
+            for (int i = 0; i < sessions; i++)
+            {
+                MoveList moves;
+                mirrors[i].generateLegal(moves);
+                if (moves.size() == 0 || mirrors[i].isDraw())
+                    continue;
+                playing.push_back(i);
+                chosen.push_back(moves.moves[rng() % moves.size()]);
+            }
+            if (playing.empty())
+                break;
+
+            // One move in every live game, all in flight at once
+            std::latch done(static_cast<std::ptrdiff_t>(playing.size()));
+            for (std::size_t k = 0; k < playing.size(); k++)
+            {
+                Request request;
+                request.command = GameSessionManager::Command::Move;
+                request.session = ids[playing[k]];
+                request.setText(chosen[k].toUci());
+                manager.submit(request, [&done, &rejected](const GameSessionManager::Response &response)
+                               {
+                    if (response.status != GameSessionManager::Status::Ok)
+                        rejected++;
+                    done.count_down(); });
+            }
+            done.wait();
+
+            for (std::size_t k = 0; k < playing.size(); k++)
+            {
+                mirrors[playing[k]].makeMove(chosen[k]);
+                mirrors[playing[k]].compactHistory();
+            }
+            submitted += playing.size();
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(1)
+                  << submitted << " moves in " << sessions << " sessions on " << manager.shardCount() << " shards: "
+                  << submitted / seconds << " moves/s (client included), " << rejected << " rejected" << std::endl;
+        printStatistics(manager);
+        return rejected == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string socketPath = "/tmp/chess_sessions.sock";
+    unsigned shards = 0;
+    int loadSessions = 0;
+    int plies = 80;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::string value = argv[++i];
+        if (arg == "--socket")
+            socketPath = value;
+        else if (arg == "--shards")
+            shards = static_cast<unsigned>(std::atoi(value.c_str()));
+        else if (arg == "--load")
+            loadSessions = std::atoi(value.c_str());
+        else if (arg == "--plies")
+            plies = std::atoi(value.c_str());
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    GameSessionManager manager(shards);
+
+    if (loadSessions > 0)
+        return runLoad(manager, loadSessions, plies);
+
+    SessionServer server(manager);
+    if (!server.start(socketPath))
+        return EXIT_FAILURE;
+
+    std::signal(SIGINT, [](int)
+                { s_Interrupted = true; });
+    std::signal(SIGTERM, [](int)
+                { s_Interrupted = true; });
+
+    std::cout << "Serving " << manager.shardCount() << " shards on " << socketPath << std::endl;
+    for (int tick = 1; !s_Interrupted; tick++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (tick % 100 == 0)
+            printStatistics(manager);
+    }
+
+    server.stop();
+    printStatistics(manager);
+    return EXIT_SUCCESS;
+}